@@ -31,6 +31,7 @@
 
 #include "klogg_version.h"
 #include "log.h"
+#include "streamspooler.h"
 
 struct CliParameters {
     bool new_session = false;
@@ -42,6 +43,8 @@ struct CliParameters {
     bool enable_logging = false;
     int log_level = 3;
 
+    QString trace_file;
+
     std::vector<QString> filenames;
 
     int window_width = 0;
@@ -49,12 +52,24 @@ struct CliParameters {
 
     QString pattern;
 
+    // klogg_grep options
+    bool count_only = false;
+    bool line_numbers = false;
+    int64_t max_count = -1;
+    bool invert_match = false;
+    bool ignore_case = false;
+    bool fixed_strings = false;
+    bool boolean_pattern = false;
+
     CliParameters( QCoreApplication& app, bool console = false )
     {
         QCommandLineParser parser;
         parser.setApplicationDescription( "Klogg log viewer" );
         const auto helpOption = parser.addHelpOption();
-        const auto versionOption = parser.addVersionOption();
+        // In console mode -v is taken by inverted matching
+        const auto versionOption
+            = console ? QCommandLineOption( "version", "Displays version information." )
+                      : parser.addVersionOption();
 
         const QCommandLineOption multiInstanceOption(
             QStringList() << "m"
@@ -83,12 +98,46 @@ struct CliParameters {
                                                               << "pattern",
                                                 "pattern to search for", "pattern" );
 
+        const QCommandLineOption countOption( QStringList() << "c"
+                                                            << "count",
+                                              "print only a count of matching lines per file" );
+
+        const QCommandLineOption lineNumberOption( QStringList() << "n"
+                                                                 << "line-number",
+                                                   "prefix each line with its line number" );
+
+        const QCommandLineOption maxCountOption( QStringList() << "m"
+                                                               << "max-count",
+                                                 "stop after num matching lines", "num" );
+
+        const QCommandLineOption invertMatchOption( QStringList() << "v"
+                                                                  << "invert-match",
+                                                    "select non-matching lines" );
+
+        const QCommandLineOption ignoreCaseOption( QStringList() << "i"
+                                                                 << "ignore-case",
+                                                   "ignore case distinctions" );
+
+        const QCommandLineOption fixedStringsOption( QStringList() << "F"
+                                                                   << "fixed-strings",
+                                                     "pattern is a plain string" );
+
+        const QCommandLineOption booleanOption(
+            QStringList() << "b"
+                          << "boolean",
+            "pattern is a boolean combination of quoted patterns, e.g. \"a\" and not \"b\"" );
+
         const QCommandLineOption debugOption(
             QStringList() << "d"
                           << "debug",
             "output more debug (increase number for more verbosity)", "debug_level", "0" );
 
+        const QCommandLineOption traceOption(
+            "trace", "record performance trace and save it to file in Chrome trace format",
+            "file" );
+
         parser.addOption( debugOption );
+        parser.addOption( traceOption );
 
         if ( !console ) {
             const QCommandLineOption windowWidthOption( "window-width", "new window width",
@@ -102,9 +151,20 @@ struct CliParameters {
             parser.addOption( followOption );
             parser.addOption( windowWidthOption );
             parser.addOption( windowHeightOption );
+            parser.addPositionalArgument( "files", "files to open, - to read standard input",
+                                          "[files...]" );
         }
         else {
+            parser.addOption( versionOption );
             parser.addOption( patternOption );
+            parser.addOption( countOption );
+            parser.addOption( lineNumberOption );
+            parser.addOption( maxCountOption );
+            parser.addOption( invertMatchOption );
+            parser.addOption( ignoreCaseOption );
+            parser.addOption( fixedStringsOption );
+            parser.addOption( booleanOption );
+            parser.addPositionalArgument( "files", "files to search in", "[pattern] files..." );
         }
 
         parser.process( app );
@@ -124,6 +184,10 @@ struct CliParameters {
 
         log_level += parser.value( debugOption ).toInt();
 
+        if ( parser.isSet( traceOption ) ) {
+            trace_file = QFileInfo( parser.value( traceOption ) ).absoluteFilePath();
+        }
+
         if ( !console ) {
             if ( parser.isSet( multiInstanceOption ) ) {
                 multi_instance = true;
@@ -150,9 +214,31 @@ struct CliParameters {
             if ( parser.isSet( patternOption ) ) {
                 pattern = parser.value( patternOption );
             }
+
+            count_only = parser.isSet( countOption );
+            line_numbers = parser.isSet( lineNumberOption );
+            invert_match = parser.isSet( invertMatchOption );
+            ignore_case = parser.isSet( ignoreCaseOption );
+            fixed_strings = parser.isSet( fixedStringsOption );
+            boolean_pattern = parser.isSet( booleanOption );
+
+            if ( parser.isSet( maxCountOption ) ) {
+                max_count = parser.value( maxCountOption ).toLongLong();
+            }
         }
 
-        for ( const auto& file : parser.positionalArguments() ) {
+        auto positionalArguments = parser.positionalArguments();
+        if ( console && pattern.isEmpty() && !positionalArguments.isEmpty() ) {
+            // Like grep, first argument is the pattern if -e is not used
+            pattern = positionalArguments.takeFirst();
+        }
+
+        for ( const auto& file : positionalArguments ) {
+            if ( file == StreamSpooler::StdinName ) {
+                filenames.emplace_back( file );
+                continue;
+            }
+
             const auto fileInfo = QFileInfo( file );
             filenames.emplace_back( fileInfo.absoluteFilePath() );
         }
@@ -17,64 +17,368 @@
  * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #include <mimalloc.h>
 
+#include <QFile>
+#include <QTextCodec>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/flow_graph.h>
+
 #include "configuration.h"
-#include "logdata.h"
-#include "logfiltereddata.h"
-#include "dispatch_to.h"
+#include "containers.h"
+#include "encodingdetector.h"
+#include "logfiltereddataworker.h"
 #include "logger.h"
 #include "persistentinfo.h"
+#include "regularexpression.h"
+#include "tracing.h"
 
 #include "cli.h"
 
 const bool PersistentInfo::ForcePortable = true;
 
+namespace {
+
+constexpr size_t ReadBlockSize = 4 * 1024 * 1024;
+constexpr size_t OutputBufferSize = 4 * 1024 * 1024;
+
+// Accumulates output and writes it to stdout in large chunks
+class OutputBuffer {
+  public:
+    OutputBuffer()
+    {
+        buffer_.reserve( OutputBufferSize * 2 );
+    }
+
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    void append( std::string_view data )
+    {
+        buffer_.append( data.data(), data.size() );
+        if ( buffer_.size() >= OutputBufferSize ) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        std::fwrite( buffer_.data(), 1, buffer_.size(), stdout );
+        std::fflush( stdout );
+        buffer_.clear();
+    }
+
+  private:
+    std::string buffer_;
+};
+
+struct GrepOptions {
+    bool countOnly = false;
+    bool lineNumbers = false;
+    bool printFileName = false;
+    int64_t maxCount = -1;
+};
+
+// Block of whole lines read from the file, converted to UTF-8 if needed
+struct Block {
+    size_t index = 0;
+    std::shared_ptr<klogg::vector<char>> data;
+};
+
+struct MatchedLine {
+    uint64_t lineInBlock;
+    std::string_view line;
+};
+
+struct BlockMatches {
+    size_t index = 0;
+    std::shared_ptr<klogg::vector<char>> data;
+    uint64_t linesInBlock = 0;
+    klogg::vector<MatchedLine> matches;
+};
+
+// Finds the end of the last complete line in the block, returns 0 if there is none
+size_t lastLineEnd( const klogg::vector<char>& data, size_t searchFrom,
+                    const EncodingParameters& encodingParams )
+{
+    const auto lineFeedWidth = static_cast<size_t>( encodingParams.lineFeedWidth );
+    const auto lineFeedIndex = static_cast<size_t>( encodingParams.lineFeedIndex );
+
+    for ( auto position = data.size(); position > searchFrom; --position ) {
+        const auto lineFeed = position - 1;
+        if ( data[ lineFeed ] == '\n' && lineFeed >= lineFeedIndex
+             && ( lineFeed - lineFeedIndex ) % lineFeedWidth == 0 ) {
+            return lineFeed - lineFeedIndex + lineFeedWidth;
+        }
+    }
+    return 0;
+}
+
+std::optional<uint64_t> grepFile( const QString& fileName, const RegularExpression& regex,
+                                  const GrepOptions& options, OutputBuffer& output )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        std::fprintf( stderr, "klogg_grep: %s: %s\n", qPrintable( fileName ),
+                      qPrintable( file.errorString() ) );
+        return std::nullopt;
+    }
+
+    const auto fileNamePrefix = options.printFileName ? fileName.toStdString() + ":" : std::string{};
+
+    // Encoding is guessed from the beginning of the file
+    QTextCodec* codec = nullptr;
+    {
+        klogg::vector<char> head( std::min<size_t>( ReadBlockSize,
+                                                    static_cast<size_t>( file.size() ) ) );
+        const auto bytesRead = file.read( head.data(), static_cast<qint64>( head.size() ) );
+        head.resize( static_cast<size_t>( std::max<qint64>( bytesRead, 0 ) ) );
+        codec = EncodingDetector::getInstance().detectEncoding( head );
+        file.seek( 0 );
+    }
+    if ( codec == nullptr ) {
+        codec = QTextCodec::codecForName( "UTF-8" );
+    }
+    const EncodingParameters encodingParams( codec );
+
+    std::atomic_bool stopRequested{ false };
+    uint64_t matchesCount = 0;
+    uint64_t linesBefore = 0;
+
+    tbb::flow::graph grepGraph;
+
+    auto blockReader = tbb::flow::input_node<Block>(
+        grepGraph, [ &file, &stopRequested, &encodingParams, carry = klogg::vector<char>{},
+                     blockIndex = size_t{ 0 },
+                     isAtEnd = false ]( tbb::flow_control& fc ) mutable -> Block {
+            if ( stopRequested || ( isAtEnd && carry.empty() ) ) {
+                fc.stop();
+                return {};
+            }
+
+            KLOGG_TRACE_SCOPE( "read block" );
+
+            auto data = std::make_shared<klogg::vector<char>>( std::move( carry ) );
+            carry = {};
+
+            // Read until there is at least one complete line
+            while ( !isAtEnd ) {
+                const auto oldSize = data->size();
+                data->resize( oldSize + ReadBlockSize );
+                const auto bytesRead
+                    = file.read( data->data() + oldSize, static_cast<qint64>( ReadBlockSize ) );
+                data->resize( oldSize + static_cast<size_t>( std::max<qint64>( bytesRead, 0 ) ) );
+
+                if ( bytesRead <= 0 ) {
+                    isAtEnd = true;
+                    break;
+                }
+
+                const auto completeLinesEnd = lastLineEnd( *data, oldSize, encodingParams );
+                if ( completeLinesEnd > 0 ) {
+                    carry.assign( data->begin() + static_cast<std::ptrdiff_t>( completeLinesEnd ),
+                                  data->end() );
+                    data->resize( completeLinesEnd );
+                    break;
+                }
+            }
+
+            if ( data->empty() ) {
+                fc.stop();
+                return {};
+            }
+
+            return Block{ blockIndex++, std::move( data ) };
+        } );
+
+    // Reading waits while blocks are matched or written, so slow output
+    // doesn't make the whole file loaded in memory
+    const auto matchingThreadsCount = static_cast<size_t>( searchThreadsCount() );
+    auto blockPrefetcher = tbb::flow::limiter_node<Block>( grepGraph, matchingThreadsCount * 3 );
+
+    tbb::enumerable_thread_specific<std::unique_ptr<PatternMatcher>> matchers(
+        [ &regex ] { return regex.createMatcher(); } );
+
+    auto blockMatcher = tbb::flow::function_node<Block, BlockMatches>(
+        grepGraph, matchingThreadsCount,
+        [ &matchers, codec, &encodingParams ]( const Block& block ) {
+            KLOGG_TRACE_SCOPE( "match" );
+
+            BlockMatches result;
+            result.index = block.index;
+            result.data = block.data;
+
+            if ( !encodingParams.isUtf8Compatible ) {
+                const auto utf8Data
+                    = codec->toUnicode( block.data->data(), static_cast<int>( block.data->size() ) )
+                          .toUtf8();
+                result.data = std::make_shared<klogg::vector<char>>( utf8Data.begin(),
+                                                                     utf8Data.end() );
+            }
+
+            const auto& matcher = matchers.local();
+            std::string_view text( result.data->data(), result.data->size() );
+            while ( !text.empty() ) {
+                const auto lineFeed = text.find( '\n' );
+                const auto lineLength = lineFeed == std::string_view::npos ? text.size()
+                                                                           : lineFeed + 1;
+                const auto line = text.substr( 0, lineLength );
+
+                auto lineContent = line;
+                if ( !lineContent.empty() && lineContent.back() == '\n' ) {
+                    lineContent.remove_suffix( 1 );
+                }
+                if ( !lineContent.empty() && lineContent.back() == '\r' ) {
+                    lineContent.remove_suffix( 1 );
+                }
+
+                if ( matcher->hasMatch( lineContent ) ) {
+                    result.matches.push_back( { result.linesInBlock, line } );
+                }
+
+                ++result.linesInBlock;
+                text.remove_prefix( lineLength );
+            }
+
+            return result;
+        } );
+
+    auto blockSequencer = tbb::flow::sequencer_node<BlockMatches>(
+        grepGraph, []( const BlockMatches& matches ) { return matches.index; } );
+
+    auto matchesWriter = tbb::flow::function_node<BlockMatches, tbb::flow::continue_msg>(
+        grepGraph, 1, [ & ]( const BlockMatches& blockMatches ) {
+            if ( stopRequested ) {
+                return tbb::flow::continue_msg{};
+            }
+
+            KLOGG_TRACE_SCOPE( "write matches" );
+
+            for ( const auto& match : blockMatches.matches ) {
+                if ( options.maxCount >= 0
+                     && matchesCount >= static_cast<uint64_t>( options.maxCount ) ) {
+                    stopRequested = true;
+                    break;
+                }
+
+                ++matchesCount;
+                if ( options.countOnly ) {
+                    continue;
+                }
+
+                output.append( fileNamePrefix );
+                if ( options.lineNumbers ) {
+                    output.append( std::to_string( linesBefore + match.lineInBlock + 1 ) );
+                    output.append( ":" );
+                }
+                output.append( match.line );
+                if ( match.line.empty() || match.line.back() != '\n' ) {
+                    output.append( "\n" );
+                }
+            }
+
+            linesBefore += blockMatches.linesInBlock;
+
+            if ( options.maxCount >= 0
+                 && matchesCount >= static_cast<uint64_t>( options.maxCount ) ) {
+                stopRequested = true;
+            }
+            return tbb::flow::continue_msg{};
+        } );
+
+    tbb::flow::make_edge( blockReader, blockPrefetcher );
+    tbb::flow::make_edge( blockPrefetcher, blockMatcher );
+    tbb::flow::make_edge( blockMatcher, blockSequencer );
+    tbb::flow::make_edge( blockSequencer, matchesWriter );
+    tbb::flow::make_edge( matchesWriter, blockPrefetcher.decrementer() );
+
+    blockReader.activate();
+    grepGraph.wait_for_all();
+
+    if ( options.countOnly ) {
+        output.append( fileNamePrefix );
+        output.append( std::to_string( matchesCount ) );
+        output.append( "\n" );
+    }
+
+    return matchesCount;
+}
+
+} // namespace
+
 int main( int argc, char* argv[] )
 {
 #ifdef KLOGG_USE_MIMALLOC
     mi_stats_reset();
 #endif
-    qRegisterMetaType<LinesCount>( "LinesCount" );
-    qRegisterMetaType<LineNumber>( "LineNumber" );
 
     QCoreApplication app( argc, argv );
     CliParameters parameters( app, true );
 
-    logging::enableLogging( true, static_cast<logging::LogLevel>( parameters.log_level ) );
+    logging::enableLogging( parameters.enable_logging,
+                            static_cast<logging::LogLevel>( parameters.log_level ) );
 
-    auto configuration = Configuration::getSynced();
+    Configuration::getSynced();
 
-    LogData logData;
-    auto filteredData = logData.getNewFilteredData();
+    if ( !parameters.trace_file.isEmpty() ) {
+        tracing::setEnabled( true );
+    }
 
-    filteredData->connect(
-        filteredData.get(), &LogFilteredData::searchProgressed,
-        [ & ]( LinesCount nbMatches, int progress, LineNumber ) {
-            if ( progress == 100 ) {
+    if ( parameters.pattern.isEmpty() || parameters.filenames.empty() ) {
+        std::fprintf( stderr, "klogg_grep: pattern and at least one file are required\n" );
+        return 2;
+    }
 
-                LOG_INFO << "Searched finished, got " << nbMatches.get() << " matches";
+    const RegularExpression regex{ RegularExpressionPattern(
+        parameters.pattern, !parameters.ignore_case, parameters.invert_match,
+        parameters.boolean_pattern, parameters.fixed_strings ) };
 
-                const auto defaultChunkSize = 1000_lcount;
-                for ( auto chunkStart = 0_lnum; chunkStart < nbMatches;
-                      chunkStart = chunkStart + defaultChunkSize ) {
-                    auto chunkSize
-                        = std::min( defaultChunkSize.get(), nbMatches.get() - chunkStart.get() );
-                    auto lines = filteredData->getLines( chunkStart, LinesCount( chunkSize ) );
-                    for ( const auto& l : lines ) {
-                        std::cout << l.toStdString() << "\n";
-                    }
-                }
+    if ( !regex.isValid() ) {
+        std::fprintf( stderr, "klogg_grep: invalid pattern: %s\n",
+                      qPrintable( regex.errorString() ) );
+        return 2;
+    }
 
-                exit( EXIT_SUCCESS );
-            }
-        } );
+    GrepOptions options;
+    options.countOnly = parameters.count_only;
+    options.lineNumbers = parameters.line_numbers;
+    options.printFileName = parameters.filenames.size() > 1;
+    options.maxCount = parameters.max_count;
+
+    OutputBuffer output;
+    bool hasErrors = false;
+    uint64_t totalMatches = 0;
+    for ( const auto& fileName : parameters.filenames ) {
+        const auto matches = grepFile( fileName, regex, options, output );
+        if ( matches ) {
+            totalMatches += *matches;
+        }
+        else {
+            hasErrors = true;
+        }
+    }
+    output.flush();
 
-    logData.connect( &logData, &LogData::loadingFinished, [ & ]() {
-        dispatchToMainThread(
-            [ & ] { filteredData->runSearch( RegularExpressionPattern( parameters.pattern ) ); } );
-    } );
+    if ( !parameters.trace_file.isEmpty() ) {
+        tracing::setEnabled( false );
+        tracing::writeChromeTrace( parameters.trace_file );
+    }
 
-    logData.attachFile( parameters.filenames.front() );
-    return app.exec();
-}
\ No newline at end of file
+    // Same exit codes as grep
+    if ( hasErrors ) {
+        return 2;
+    }
+    return totalMatches > 0 ? 0 : 1;
+}
@@ -0,0 +1,438 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headless klogg serving newline delimited JSON-RPC 2.0 requests over a local socket.
+// Files stay open and indexed between requests and connections, so repeated
+// searches reuse the index and the search results cache.
+//
+// Methods:
+//   open { path }                         -> { path }
+//   waitIndexed { path }                  -> { lines, size }, sent when indexing is done
+//   search { path, pattern, caseSensitive, inverse, boolean, plainText }
+//                                         -> { matches }, sent when the search is done
+//   lines { path, first, count }          -> { lines: [ text... ] }
+//   matches { path, first, count }        -> { matches: [ { line, text }... ] }
+//   subscribe { path }                    -> { path }, then fileChanged notifications
+//   close { path }                        -> { path }
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QPointer>
+
+#include "configuration.h"
+#include "logdata.h"
+#include "logfiltereddata.h"
+#include "logger.h"
+#include "persistentinfo.h"
+#include "regularexpressionpattern.h"
+
+const bool PersistentInfo::ForcePortable = true;
+
+namespace {
+
+enum ErrorCode {
+    ParseError = -32700,
+    InvalidRequest = -32600,
+    MethodNotFound = -32601,
+    InvalidParams = -32602,
+    FileNotOpen = -32001,
+    FileNotIndexed = -32002,
+    SearchInterrupted = -32003,
+};
+
+void sendMessage( QLocalSocket* socket, const QJsonObject& message )
+{
+    if ( socket == nullptr ) {
+        return;
+    }
+
+    socket->write( QJsonDocument( message ).toJson( QJsonDocument::Compact ) );
+    socket->write( "\n" );
+}
+
+void sendResult( QLocalSocket* socket, const QJsonValue& id, const QJsonObject& result )
+{
+    sendMessage( socket, QJsonObject{ { "jsonrpc", "2.0" }, { "id", id }, { "result", result } } );
+}
+
+void sendError( QLocalSocket* socket, const QJsonValue& id, ErrorCode code,
+                const QString& message )
+{
+    sendMessage( socket,
+                 QJsonObject{ { "jsonrpc", "2.0" },
+                              { "id", id },
+                              { "error", QJsonObject{ { "code", code },
+                                                      { "message", message } } } } );
+}
+
+struct PendingRequest {
+    QPointer<QLocalSocket> socket;
+    QJsonValue id;
+};
+
+struct OpenFile {
+    QString path;
+    std::unique_ptr<LogData> logData;
+    std::unique_ptr<LogFilteredData> filteredData;
+
+    bool isIndexed = false;
+    bool hasSearch = false;
+
+    std::vector<PendingRequest> indexWaiters;
+    std::vector<PendingRequest> searchWaiters;
+    std::vector<QPointer<QLocalSocket>> subscribers;
+};
+
+class Server {
+  public:
+    explicit Server( QLocalServer& server )
+        : server_( server )
+    {
+        QObject::connect( &server_, &QLocalServer::newConnection, [ this ] {
+            while ( auto socket = server_.nextPendingConnection() ) {
+                LOG_INFO << "Client connected";
+                QObject::connect( socket, &QLocalSocket::disconnected, socket,
+                                  &QLocalSocket::deleteLater );
+                QObject::connect( socket, &QLocalSocket::readyRead, socket,
+                                  [ this, socket ] { readRequests( socket ); } );
+            }
+        } );
+    }
+
+  private:
+    void readRequests( QLocalSocket* socket )
+    {
+        while ( socket->canReadLine() ) {
+            const auto requestLine = socket->readLine();
+
+            QJsonParseError parseError;
+            const auto document = QJsonDocument::fromJson( requestLine, &parseError );
+            if ( parseError.error != QJsonParseError::NoError ) {
+                sendError( socket, QJsonValue::Null, ParseError, parseError.errorString() );
+                continue;
+            }
+
+            if ( !document.isObject() ) {
+                sendError( socket, QJsonValue::Null, InvalidRequest, "Request is not an object" );
+                continue;
+            }
+
+            handleRequest( socket, document.object() );
+        }
+    }
+
+    void handleRequest( QLocalSocket* socket, const QJsonObject& request )
+    {
+        const auto id = request.value( "id" );
+        const auto method = request.value( "method" ).toString();
+        const auto params = request.value( "params" ).toObject();
+
+        if ( params.value( "path" ).toString().isEmpty() ) {
+            sendError( socket, id, InvalidParams, "path is required" );
+            return;
+        }
+
+        const auto path = QFileInfo( params.value( "path" ).toString() ).absoluteFilePath();
+
+        LOG_INFO << "Request " << method << " for " << path;
+
+        if ( method == "open" ) {
+            openFile( path );
+            sendResult( socket, id, { { "path", path } } );
+            return;
+        }
+
+        const auto file = files_.find( path );
+        if ( file == files_.end() ) {
+            sendError( socket, id, FileNotOpen, "File is not open" );
+            return;
+        }
+
+        auto& openFile = file->second;
+
+        if ( method == "waitIndexed" ) {
+            if ( openFile.isIndexed ) {
+                sendResult( socket, id, indexInfo( openFile ) );
+            }
+            else {
+                openFile.indexWaiters.push_back( { socket, id } );
+            }
+        }
+        else if ( method == "search" ) {
+            search( socket, id, openFile, params );
+        }
+        else if ( method == "lines" ) {
+            sendResult( socket, id, lines( *openFile.logData, params ) );
+        }
+        else if ( method == "matches" ) {
+            sendResult( socket, id, matches( openFile, params ) );
+        }
+        else if ( method == "subscribe" ) {
+            openFile.subscribers.emplace_back( socket );
+            sendResult( socket, id, { { "path", path } } );
+        }
+        else if ( method == "close" ) {
+            files_.erase( file );
+            sendResult( socket, id, { { "path", path } } );
+        }
+        else {
+            sendError( socket, id, MethodNotFound, "Unknown method " + method );
+        }
+    }
+
+    void openFile( const QString& path )
+    {
+        if ( files_.count( path ) ) {
+            return;
+        }
+
+        auto& openFile = files_[ path ];
+        openFile.path = path;
+        openFile.logData = std::make_unique<LogData>();
+        openFile.filteredData = openFile.logData->getNewFilteredData();
+
+        auto* logData = openFile.logData.get();
+        auto* filteredData = openFile.filteredData.get();
+
+        QObject::connect( logData, &LogData::loadingFinished, logData,
+                          [ this, path ]( LoadingStatus status ) {
+                              indexingFinished( path, status );
+                          } );
+
+        QObject::connect( logData, &LogData::fileChanged, logData,
+                          [ this, path ]( MonitoredFileStatus status ) {
+                              fileChanged( path, status );
+                          } );
+
+        QObject::connect( filteredData, &LogFilteredData::searchProgressed, filteredData,
+                          [ this, path ]( LinesCount nbMatches, int progress, LineNumber ) {
+                              if ( progress == 100 ) {
+                                  searchFinished( path, nbMatches );
+                              }
+                          } );
+
+        logData->attachFile( path );
+    }
+
+    QJsonObject indexInfo( const OpenFile& openFile ) const
+    {
+        return { { "lines", static_cast<double>( openFile.logData->getNbLine().get() ) },
+                 { "size", static_cast<double>( openFile.logData->getFileSize() ) } };
+    }
+
+    void indexingFinished( const QString& path, LoadingStatus status )
+    {
+        auto& openFile = files_.at( path );
+        const auto wasIndexed = openFile.isIndexed;
+        openFile.isIndexed = status == LoadingStatus::Successful;
+
+        for ( const auto& waiter : openFile.indexWaiters ) {
+            if ( openFile.isIndexed ) {
+                sendResult( waiter.socket, waiter.id, indexInfo( openFile ) );
+            }
+            else {
+                sendError( waiter.socket, waiter.id, FileNotIndexed, "Indexing failed" );
+            }
+        }
+        openFile.indexWaiters.clear();
+
+        if ( wasIndexed && openFile.isIndexed ) {
+            // New data was indexed while following the file
+            if ( openFile.hasSearch ) {
+                openFile.filteredData->updateSearch(
+                    0_lnum, LineNumber( openFile.logData->getNbLine().get() ) );
+            }
+            notifySubscribers( openFile, "fileChanged", indexInfo( openFile ) );
+        }
+    }
+
+    void fileChanged( const QString& path, MonitoredFileStatus status )
+    {
+        auto& openFile = files_.at( path );
+        if ( status == MonitoredFileStatus::Truncated && openFile.hasSearch ) {
+            constexpr auto DropCache = true;
+            openFile.filteredData->clearSearch( DropCache );
+            openFile.hasSearch = false;
+            notifySubscribers( openFile, "searchInvalidated", {} );
+        }
+    }
+
+    void search( QLocalSocket* socket, const QJsonValue& id, OpenFile& openFile,
+                 const QJsonObject& params )
+    {
+        if ( !openFile.isIndexed ) {
+            sendError( socket, id, FileNotIndexed, "File is not indexed yet" );
+            return;
+        }
+
+        const auto pattern = params.value( "pattern" ).toString();
+        if ( pattern.isEmpty() ) {
+            sendError( socket, id, InvalidParams, "pattern is required" );
+            return;
+        }
+
+        // Only one search runs on a file, the new one replaces the previous
+        for ( const auto& waiter : openFile.searchWaiters ) {
+            sendError( waiter.socket, waiter.id, SearchInterrupted,
+                       "Search was replaced by a newer one" );
+        }
+        openFile.searchWaiters.clear();
+        openFile.searchWaiters.push_back( { socket, id } );
+        openFile.hasSearch = true;
+
+        openFile.filteredData->interruptSearch();
+        openFile.filteredData->runSearch( RegularExpressionPattern(
+            pattern, params.value( "caseSensitive" ).toBool( true ),
+            params.value( "inverse" ).toBool( false ), params.value( "boolean" ).toBool( false ),
+            params.value( "plainText" ).toBool( false ) ) );
+    }
+
+    void searchFinished( const QString& path, LinesCount nbMatches )
+    {
+        auto& openFile = files_.at( path );
+        for ( const auto& waiter : openFile.searchWaiters ) {
+            sendResult( waiter.socket, waiter.id,
+                        { { "matches", static_cast<double>( nbMatches.get() ) } } );
+        }
+        openFile.searchWaiters.clear();
+    }
+
+    static std::pair<LineNumber, LinesCount> requestedRange( const QJsonObject& params,
+                                                             LinesCount nbLines )
+    {
+        const auto first = static_cast<LineNumber::UnderlyingType>(
+            params.value( "first" ).toVariant().toULongLong() );
+        const auto count = static_cast<LinesCount::UnderlyingType>(
+            params.value( "count" ).toVariant().toULongLong() );
+
+        if ( first >= nbLines.get() ) {
+            return { LineNumber( first ), 0_lcount };
+        }
+
+        return { LineNumber( first ), LinesCount( std::min( count, nbLines.get() - first ) ) };
+    }
+
+    static QJsonObject lines( const AbstractLogData& logData, const QJsonObject& params )
+    {
+        const auto [ first, count ] = requestedRange( params, logData.getNbLine() );
+
+        QJsonArray lines;
+        const auto decodedLines = logData.getLinesView( first, count );
+        for ( auto i = 0u; i < decodedLines.size(); ++i ) {
+            lines.append( decodedLines[ i ].toString() );
+        }
+
+        return { { "lines", lines } };
+    }
+
+    static QJsonObject matches( const OpenFile& openFile, const QJsonObject& params )
+    {
+        const auto& filteredData = *openFile.filteredData;
+        const auto [ first, count ] = requestedRange( params, filteredData.getNbLine() );
+
+        QJsonArray matches;
+        const auto decodedLines = filteredData.getLinesView( first, count );
+        for ( auto i = 0u; i < decodedLines.size(); ++i ) {
+            const auto lineNumber
+                = filteredData.getMatchingLineNumber( first + LinesCount( i ) );
+            matches.append( QJsonObject{ { "line", static_cast<double>( lineNumber.get() ) },
+                                         { "text", decodedLines[ i ].toString() } } );
+        }
+
+        return { { "matches", matches } };
+    }
+
+    static void notifySubscribers( OpenFile& openFile, const QString& method,
+                                   QJsonObject params )
+    {
+        params.insert( "path", openFile.path );
+
+        openFile.subscribers.erase( std::remove_if( openFile.subscribers.begin(),
+                                                    openFile.subscribers.end(),
+                                                    []( const auto& socket ) { return !socket; } ),
+                                    openFile.subscribers.end() );
+
+        for ( const auto& subscriber : openFile.subscribers ) {
+            sendMessage( subscriber, QJsonObject{ { "jsonrpc", "2.0" },
+                                                  { "method", method },
+                                                  { "params", params } } );
+        }
+    }
+
+  private:
+    QLocalServer& server_;
+    std::map<QString, OpenFile> files_;
+};
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+    qRegisterMetaType<LinesCount>( "LinesCount" );
+    qRegisterMetaType<LineNumber>( "LineNumber" );
+
+    QCoreApplication app( argc, argv );
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Headless klogg serving JSON-RPC over a local socket" );
+    parser.addHelpOption();
+
+    const QCommandLineOption socketOption( QStringList() << "s"
+                                                         << "socket",
+                                           "local socket name or path", "socket",
+                                           "klogg_server" );
+    const QCommandLineOption debugOption(
+        QStringList() << "d"
+                      << "debug",
+        "output more debug (increase number for more verbosity)", "debug_level", "0" );
+
+    parser.addOption( socketOption );
+    parser.addOption( debugOption );
+    parser.process( app );
+
+    const auto debugLevel = parser.value( debugOption ).toInt();
+    logging::enableLogging( debugLevel > 0, static_cast<logging::LogLevel>( 3 + debugLevel ) );
+
+    Configuration::getSynced();
+
+    const auto socketName = parser.value( socketOption );
+    QLocalServer::removeServer( socketName );
+
+    QLocalServer localServer;
+    if ( !localServer.listen( socketName ) ) {
+        LOG_ERROR << "Failed to listen on " << socketName << ": " << localServer.errorString();
+        return EXIT_FAILURE;
+    }
+
+    LOG_INFO << "Listening on " << localServer.fullServerName();
+
+    Server server( localServer );
+    return app.exec();
+}
@@ -46,6 +46,8 @@
 #include <windows.h>
 #endif // _WIN32
 
+#include <algorithm>
+
 #include <mimalloc.h>
 #include <roaring.hh>
 
@@ -58,7 +60,9 @@
 #include "configuration.h"
 #include "logger.h"
 #include "mainwindow.h"
+#include "memorygovernor.h"
 #include "styles.h"
+#include "tracing.h"
 
 #include "cli.h"
 #include "kloggapp.h"
@@ -135,6 +139,13 @@ int main( int argc, char* argv[] )
 
     app.initCrashHandler();
 
+    if ( !parameters.trace_file.isEmpty() ) {
+        tracing::setEnabled( true );
+    }
+
+    MemoryGovernor::instance().setBudget( static_cast<uint64_t>( config.memoryBudgetMb() ) * 1024
+                                          * 1024 );
+
     auto maxConcurrency
         = tbb::global_control::active_value( tbb::global_control::max_allowed_parallelism );
 
@@ -164,7 +175,13 @@ int main( int argc, char* argv[] )
         QThreadPool::globalInstance()->setMaxThreadCount( static_cast<int>( maxConcurrency ) );
     }
 
-    if ( !parameters.multi_instance && app.isSecondary() ) {
+    // Standard input can't be passed to another process
+    const auto readsStdin
+        = std::find( parameters.filenames.begin(), parameters.filenames.end(),
+                     StreamSpooler::StdinName )
+          != parameters.filenames.end();
+
+    if ( !parameters.multi_instance && !readsStdin && app.isSecondary() ) {
         LOG_INFO << "Found another klogg, pid " << app.primaryPid();
         app.sendFilesToPrimaryInstance( parameters.filenames );
     }
@@ -200,5 +217,12 @@ int main( int argc, char* argv[] )
         app.startBackgroundTasks();
     }
 
-    return app.exec();
+    const auto exitCode = app.exec();
+
+    if ( !parameters.trace_file.isEmpty() ) {
+        tracing::setEnabled( false );
+        tracing::writeChromeTrace( parameters.trace_file );
+    }
+
+    return exitCode;
 }
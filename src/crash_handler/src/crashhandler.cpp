@@ -52,6 +52,7 @@
 #include "klogg_version.h"
 #include "log.h"
 #include "memory_info.h"
+#include "memorygovernor.h"
 #include "openfilehelper.h"
 
 namespace {
@@ -275,6 +276,13 @@ CrashHandler::CrashHandler()
         const auto vmUsed = usedMemory();
         addExtra( "vm_used", vmUsed );
 
+        for ( const auto& subsystem : MemoryGovernor::instance().usageBySubsystem() ) {
+            const auto key = QString( "tracked_%1" ).arg( subsystem.name ).toStdString();
+            const auto value = std::to_string( subsystem.live ) + " (peak "
+                               + std::to_string( subsystem.peak ) + ")";
+            sentry_set_extra( key.c_str(), sentry_value_new_string( value.c_str() ) );
+        }
+
 #ifdef KLOGG_USE_MIMALLOC
         size_t elapsedMsecs, userMsecs, systemMsecs, currentRss, peakRss, currentCommit, peakCommit,
             pageFaults;
@@ -27,6 +27,7 @@
 #include <tbb/version.h>
 
 #include "klogg_version.h"
+#include "memorygovernor.h"
 
 #include "issuereporter.h"
 
@@ -37,7 +38,10 @@ static constexpr auto DetailsFooter
       "> Klogg version %1 (built on %2 from commit %3) [built for %4]\n"
       "> running on %5 (%6/%7) [%8], concurrency %9\n";
 
-static constexpr auto LibraryVersionsFooter = "> Qt %1, tbb %2";
+static constexpr auto LibraryVersionsFooter = "> Qt %1, tbb %2\n";
+
+static constexpr auto MemoryFooter = "> Memory usage by subsystem:\n%1";
+static constexpr auto MemoryLineFooter = ">   %1: %2 bytes, peak %3 bytes\n";
 
 static constexpr auto DetailsHeader = "Details for the issue\n"
                                       "--------------------\n\n";
@@ -108,6 +112,14 @@ void IssueReporter::reportIssue( IssueTemplate issueTemplate, const QString& inf
                            arch, std::to_string(concurrency).c_str() ) );
     body.append( QString( LibraryVersionsFooter ).arg( qVersion(), TBB_runtime_version() ) );
 
+    QString memoryReport;
+    for ( const auto& subsystem : MemoryGovernor::instance().usageBySubsystem() ) {
+        memoryReport.append( QString( MemoryLineFooter )
+                                 .arg( subsystem.name, QString::number( subsystem.live ),
+                                       QString::number( subsystem.peak ) ) );
+    }
+    body.append( QString( MemoryFooter ).arg( memoryReport ) );
+
     QUrlQuery query;
     query.addQueryItem( "body", body );
 
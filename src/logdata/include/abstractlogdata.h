@@ -39,19 +39,28 @@
 #ifndef ABSTRACTLOGDATA_H
 #define ABSTRACTLOGDATA_H
 
+#include <functional>
+#include <utility>
+
 #include <QObject>
 #include <QString>
 #include <QStringList>
 #include <QTextCodec>
 
+#include "decodedlines.h"
 #include "linetypes.h"
 
+class QFileDevice;
+
 // Base class representing a set of data.
 // It can be either a full set or a filtered set.
 class AbstractLogData : public QObject {
     Q_OBJECT
 
   public:
+    // Ranges of consecutive lines
+    using LineRanges = klogg::vector<std::pair<LineNumber, LinesCount>>;
+
     // Returns the line passed as a QString
     QString getLineString( LineNumber line ) const;
     // Returns the line passed as a QString, with tabs expanded
@@ -60,6 +69,21 @@ class AbstractLogData : public QObject {
     klogg::vector<QString> getLines( LineNumber first_line, LinesCount number ) const;
     // Returns a set of lines with tabs expanded
     klogg::vector<QString> getExpandedLines( LineNumber first_line, LinesCount number ) const;
+    // Returns a set of lines decoded into a single buffer
+    DecodedLines getLinesView( LineNumber first_line, LinesCount number ) const;
+    // Returns a set of lines as one text, each line followed by the separator.
+    // Lines cut while indexing are joined back with their rest if it is
+    // before end_line, so a chunk of exported lines may end without separator.
+    QString getLinesText( LineNumber first_line, LinesCount number, LineNumber end_line,
+                          const QString& separator ) const;
+    // Returns true if lines can be written to a file as they are stored
+    // in the source file, without decoding and encoding them again
+    bool canExportRawLines() const;
+    // Copies bytes of the lines from the source file to the output.
+    // Progress is called with bytes copied and total bytes to copy,
+    // returning false from it interrupts the export.
+    bool exportRawLines( LineNumber first_line, LinesCount number, QFileDevice& output,
+                         const std::function<bool( uint64_t, uint64_t )>& progress ) const;
     // Returns the line numer
     LineNumber getLineNumber( LineNumber index ) const;
     // Returns the total number of lines
@@ -70,6 +94,9 @@ class AbstractLogData : public QObject {
     // Returns the visible length of the passed line
     // Tabs are expanded
     LineLength getLineLength( LineNumber line ) const;
+    // Returns true if the line was cut while indexing because it was
+    // too long and the rest of it is the next line of the file
+    bool isLineContinued( LineNumber line ) const;
 
     // Set the view to use the passed encoding for display
     void setDisplayEncoding( const char* encoding_name );
@@ -101,6 +128,15 @@ class AbstractLogData : public QObject {
     // Internal function called to get a set of expanded lines
     virtual klogg::vector<QString> doGetExpandedLines( LineNumber first_line,
                                                      LinesCount number ) const = 0;
+    // Internal function called to get a set of lines decoded into a single buffer
+    virtual DecodedLines doGetLinesView( LineNumber first_line, LinesCount number ) const = 0;
+
+    // Internal function called to check if raw export is possible
+    virtual bool doCanExportRawLines() const = 0;
+    // Internal function called to copy raw bytes of a set of lines
+    virtual bool
+    doExportRawLines( LineNumber first_line, LinesCount number, QFileDevice& output,
+                      const std::function<bool( uint64_t, uint64_t )>& progress ) const = 0;
 
     // Internal function called to get the index of given line
     virtual LineNumber doGetLineNumber( LineNumber index ) const = 0;
@@ -110,6 +146,8 @@ class AbstractLogData : public QObject {
     virtual LineLength doGetMaxLength() const = 0;
     // Internal function called to get the line length
     virtual LineLength doGetLineLength( LineNumber line ) const = 0;
+    // Internal function called to check if the line continues in the next one
+    virtual bool doIsLineContinued( LineNumber line ) const = 0;
     // Internal function called to set the encoding
     virtual void doSetDisplayEncoding( const char* encoding ) = 0;
     virtual QTextCodec* doGetDisplayEncoding() const = 0;
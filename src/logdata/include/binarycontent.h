@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_BINARYCONTENT_H
+#define KLOGG_BINARYCONTENT_H
+
+#include <cstdint>
+#include <string_view>
+
+#include <QString>
+
+#include "encodingdetector.h"
+
+// Binary data has no line feeds to speak of, such blocks are cut
+// into lines of this size while indexing
+constexpr int64_t BinaryLineSize = 512;
+
+// Tells binary data (core dumps, archives, blobs written into logs) from
+// text by the density of NUL and control code units of the encoding.
+// Invalid UTF-8 alone is more likely a wrong encoding guess, so it is
+// only taken into account together with some control characters.
+bool isBinaryContent( std::string_view data, const EncodingParameters& encodingParams );
+
+// Same check on evenly spaced samples of a large block, so indexing
+// does not go through every byte of the block twice
+bool isBinaryBlock( std::string_view block, const EncodingParameters& encodingParams );
+
+// Checks the beginning of the file, for a warning before it is indexed
+bool isBinaryFile( const QString& fileName );
+
+#endif
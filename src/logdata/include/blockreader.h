@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_BLOCKREADER_H
+#define KLOGG_BLOCKREADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QString>
+
+#include "fileholder.h"
+
+// Reads blocks of a file with several reads in flight. Every worker has
+// its own handle of the file and reads at the requested offset, so fast
+// devices (NVMe, arrays) see a queue deeper than one blocking reader gives.
+// Handles are opened by name, so they are checked to be of the expected file.
+class BlockReader {
+  public:
+    struct CacheHints {
+        // Pages are dropped from page cache right after they are read
+        bool dropBehind = false;
+        // Reads bypass page cache (O_DIRECT), where supported
+        bool directIo = false;
+    };
+
+    struct FileAccess {
+        // Reads fail if the file opened by name is another one (e.g. a log
+        // rotated after it was indexed), empty id skips the check
+        FileId expectedId;
+        // Workers close their handles while there is nothing to read
+        bool keepClosed = false;
+    };
+
+    struct Stats {
+        uint64_t bytes = 0;
+        // Average number of reads in flight while at least one was
+        double queueDepth = 0;
+        double megabytesPerSecond = 0;
+    };
+
+    BlockReader( const QString& fileName, int queueDepth, CacheHints cacheHints = {},
+                 FileAccess fileAccess = {} );
+    ~BlockReader();
+
+    BlockReader( const BlockReader& ) = delete;
+    BlockReader& operator=( const BlockReader& ) = delete;
+
+    // Queues reading of up to size bytes at the offset, the future has
+    // the number of bytes read or -1 if reading failed. The buffer
+    // must stay alive until the future is ready.
+    std::future<int64_t> read( int64_t offset, char* buffer, int64_t size );
+
+    int queueDepth() const;
+    Stats stats() const;
+
+  private:
+    struct Request {
+        int64_t offset;
+        char* buffer;
+        int64_t size;
+        std::promise<int64_t> result;
+    };
+
+    void work();
+    // Accounts the time passed with the current number of reads in flight
+    void updateStats( std::chrono::steady_clock::time_point now );
+
+  private:
+    QString fileName_;
+    CacheHints cacheHints_;
+    FileAccess fileAccess_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<Request> requests_;
+    bool stopRequested_ = false;
+
+    int inFlight_ = 0;
+    uint64_t bytes_ = 0;
+    std::chrono::steady_clock::time_point lastChange_;
+    std::chrono::duration<double> busyTime_{};
+    std::chrono::duration<double> inFlightTime_{};
+
+    std::vector<std::thread> workers_;
+};
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_DECODEDLINES_H
+#define KLOGG_DECODEDLINES_H
+
+#include <utility>
+
+#include <QString>
+#include <QStringView>
+
+#include "containers.h"
+
+// Set of lines decoded into a single arena buffer.
+// Lines are stored as offsets into the arena, so views returned
+// by operator[] are valid until the object is modified or destroyed.
+class DecodedLines {
+  public:
+    void reserve( size_t lines, qsizetype characters = 0 )
+    {
+        lines_.reserve( lines );
+        if ( characters > 0 ) {
+            arena_.reserve( static_cast<int>( characters ) );
+        }
+    }
+
+    // Replaces the arena with already decoded text,
+    // lines are then added with addLine.
+    void setArena( QString&& arena )
+    {
+        arena_ = std::move( arena );
+        lines_.clear();
+    }
+
+    void addLine( qsizetype start, qsizetype length )
+    {
+        lines_.emplace_back( start, length );
+    }
+
+    void appendLine( QStringView line )
+    {
+        lines_.emplace_back( arena_.size(), line.size() );
+        arena_.append( line.data(), static_cast<int>( line.size() ) );
+    }
+
+    void append( const DecodedLines& other )
+    {
+        const auto shift = arena_.size();
+        arena_.append( other.arena_ );
+        lines_.reserve( lines_.size() + other.lines_.size() );
+        for ( const auto& line : other.lines_ ) {
+            lines_.emplace_back( line.first + shift, line.second );
+        }
+    }
+
+    void chopCarriageReturns()
+    {
+        for ( auto& line : lines_ ) {
+            if ( line.second > 0
+                 && arena_.at( static_cast<int>( line.first + line.second - 1 ) )
+                        == QChar::CarriageReturn ) {
+                --line.second;
+            }
+        }
+    }
+
+    size_t size() const
+    {
+        return lines_.size();
+    }
+
+    bool empty() const
+    {
+        return lines_.empty();
+    }
+
+    QStringView operator[]( size_t index ) const
+    {
+        const auto& line = lines_[ index ];
+        return QStringView{ arena_ }.mid( line.first, line.second );
+    }
+
+    const QString& arena() const
+    {
+        return arena_;
+    }
+
+  private:
+    QString arena_;
+    klogg::vector<std::pair<qsizetype, qsizetype>> lines_;
+};
+
+#endif
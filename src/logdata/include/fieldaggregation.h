@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_FIELDAGGREGATION_H
+#define KLOGG_FIELDAGGREGATION_H
+
+#include <cstdint>
+#include <functional>
+
+#include <QString>
+
+#include "atomicflag.h"
+#include "containers.h"
+#include "linechunks.h"
+
+class LogData;
+
+// How a value is taken from a line.
+struct FieldExtractor {
+    enum class Type {
+        // Value of the first capture group, or whole match if there are no groups
+        RegexCapture,
+        // Value of a field of the JSON object found in the line, "a.b" for nested fields
+        JsonField,
+    };
+
+    Type type = Type::RegexCapture;
+    QString expression;
+    bool isCaseSensitive = true;
+};
+
+struct AggregatedValue {
+    QString value;
+    uint64_t count;
+};
+
+struct FieldAggregationResult {
+    // Sorted by count, most frequent first
+    klogg::vector<AggregatedValue> values;
+
+    uint64_t processedLines = 0;
+    uint64_t linesWithValue = 0;
+    uint64_t distinctValues = 0;
+
+    bool isInterrupted = false;
+    QString error;
+};
+
+// Counts values extracted from lines of the range using the parallel pipeline.
+// Every matcher thread counts into its own hash map, maps are merged at the end
+// and the maxValues most frequent values are returned.
+// Progress callback is called from the calling thread.
+FieldAggregationResult aggregateField( const LogData& logData, const FieldExtractor& extractor,
+                                       const LinesSelection& range, size_t maxValues,
+                                       AtomicFlag& interruptRequested,
+                                       const std::function<void( int )>& progress );
+
+#endif
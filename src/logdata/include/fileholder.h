@@ -15,9 +15,17 @@ struct FileId {
         return fileIndex != other.fileIndex || volumeIndex != other.volumeIndex;
     }
 
+    bool operator==( const FileId& other ) const
+    {
+        return !( *this != other );
+    }
+
     static FileId getFileId( const QString& filename );
 };
 
+// Opens the file for reading, on Windows others can still rename and delete it
+void openFileByHandle( QFile* file );
+
 template <typename T> class ScopedFileHolder {
   public:
     explicit ScopedFileHolder( T* file )
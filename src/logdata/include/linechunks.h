@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LINECHUNKS_H
+#define KLOGG_LINECHUNKS_H
+
+#include <functional>
+#include <optional>
+
+#include "atomicflag.h"
+#include "decodedlines.h"
+#include "linetypes.h"
+#include "logfiltereddataworker.h"
+
+class LogData;
+
+struct LinesSelection {
+    LineNumber startLine;
+    LineNumber endLine;
+    // If set only these lines are processed, e.g. current search results
+    std::optional<SearchResultArray> lines;
+};
+
+// Decoded lines of one chunk read from the file.
+struct LinesChunk {
+    LineNumber chunkStart;
+    DecodedLines lines;
+    const SearchResultArray* selectedLines = nullptr;
+
+    // Calls visitor with the number and the text (without CR) of every selected line
+    template <typename Visitor>
+    void forEachLine( Visitor&& visitor ) const
+    {
+        for ( auto index = 0u; index < lines.size(); ++index ) {
+            const auto lineNumber = chunkStart.get() + index;
+            if ( selectedLines != nullptr && !selectedLines->contains( lineNumber ) ) {
+                continue;
+            }
+
+            auto line = lines[ index ];
+            if ( line.endsWith( QChar::CarriageReturn ) ) {
+                line.chop( 1 );
+            }
+            visitor( LineNumber( lineNumber ), line );
+        }
+    }
+};
+
+// Reads lines of the selection in chunks on the calling thread, the same way
+// SearchOperation does, and passes decoded chunks to the processor
+// on several threads at once. When selection has a set of lines only the parts
+// of the file containing these lines are read.
+// Progress callback is called from the calling thread.
+// Returns false if processing was interrupted.
+bool processLineChunks( const LogData& logData, const LinesSelection& selection,
+                        AtomicFlag& interruptRequested, const std::function<void( int )>& progress,
+                        const std::function<void( const LinesChunk& )>& processor );
+
+#endif
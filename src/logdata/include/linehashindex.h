@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LINEHASHINDEX_H
+#define KLOGG_LINEHASHINDEX_H
+
+#include <cstdint>
+#include <optional>
+
+#include <robin_hood.h>
+
+#include "containers.h"
+#include "linetypes.h"
+#include "logfiltereddataworker.h"
+
+enum class DuplicateLinesFilter {
+    // Hide lines repeating the previous visible line
+    CollapseRepeated,
+    // Show only the first line with each content
+    FirstOccurrence,
+    // Show lines after the given line with content not seen before it
+    NewSinceLine,
+};
+
+// Hashes of all lines of a file stored compactly: every distinct hash
+// gets a 32-bit id and lines store ids, so repeated lines cost 4 bytes each.
+// Filters are computed over ids without reading the file.
+class LineHashIndex {
+  public:
+    // Drops hashes of lines starting from firstLine (e.g. a line that had
+    // no line feed when it was indexed) and appends the new hashes
+    void append( LineNumber firstLine, const klogg::vector<uint64_t>& hashes );
+    void clear();
+
+    LinesCount size() const;
+    size_t allocatedSize() const;
+
+    uint64_t hashOfLine( LineNumber line ) const;
+
+    // Returns lines that pass the filter, only lines from the set are
+    // considered if it is given. Boundary is used by NewSinceLine filter.
+    SearchResultArray filterLines( DuplicateLinesFilter filter, LineNumber boundary,
+                                   const std::optional<SearchResultArray>& lines ) const;
+
+  private:
+    klogg::vector<uint32_t> lineIds_;
+    klogg::vector<uint64_t> hashes_;
+    klogg::vector<LineNumber::UnderlyingType> firstLines_;
+    robin_hood::unordered_flat_map<uint64_t, uint32_t> idsByHash_;
+};
+
+#endif
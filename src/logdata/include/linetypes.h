@@ -31,6 +31,7 @@
 
 #include <QMetaType>
 #include <QString>
+#include <QStringView>
 #include <type_traits>
 
 #include "containers.h"
@@ -306,36 +307,12 @@ private:
 // Length of a tab stop
 constexpr int TabStop = 8;
 
-inline QString untabify( QString&& line, LineColumn initialPosition = 0_lcol )
-{
-    line.replace( QChar::Null, QChar::Space );
-
-    LineLength::UnderlyingType position = 0;
-    position = type_safe::narrow_cast<LineLength::UnderlyingType>(
-        line.indexOf( QChar::Tabulation, position ) );
-    while ( position >= 0 ) {
-        const auto spaces = TabStop - ( ( initialPosition.get() + position ) % TabStop );
-        line.replace( position, 1, QString( spaces, QChar::Space ) );
-        position = type_safe::narrow_cast<LineLength::UnderlyingType>(
-            line.indexOf( QChar::Tabulation, position ) );
-    }
-
-    return std::move( line );
-}
-
-template <typename LineType>
-LineLength getUntabifiedLength( const LineType& utf8Line )
-{
-    size_t totalSpaces = 0;
-
-    auto tabPosition = utf8Line.find( '\t' );
-    while ( tabPosition != std::string_view::npos ) {
-        const auto spaces = TabStop - ( ( tabPosition + totalSpaces ) % TabStop ) - 1;
-        totalSpaces += spaces;
+// Expands tabs to spaces and replaces NUL characters with spaces.
+// Lines without tabs and NULs are returned as is without copying.
+QString untabify( QString&& line, LineColumn initialPosition = 0_lcol );
+// Lines without tabs and NULs share the data of the view,
+// which must outlive the result.
+QString untabify( QStringView line, LineColumn initialPosition = 0_lcol );
 
-        tabPosition = utf8Line.find( '\t', tabPosition + 1 );
-    }
-
-    return LineLength( type_safe::narrow_cast<LineLength::UnderlyingType>(
-        static_cast<int64_t>( utf8Line.size() + totalSpaces ) ) );
-}
+// Returns the visible length of the UTF-8 line with tabs expanded
+LineLength getUntabifiedLength( std::string_view utf8Line );
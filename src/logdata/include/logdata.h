@@ -39,24 +39,32 @@
 #ifndef LOGDATA_H
 #define LOGDATA_H
 
+#include <chrono>
+#include <future>
 #include <memory>
+#include <optional>
 
 #include <QDateTime>
 #include <QFile>
 #include <QObject>
 #include <QString>
 #include <QTextCodec>
+#include <QThreadPool>
 #include <qregularexpression.h>
 #include <qtextcodec.h>
 #include <string_view>
 #include <vector>
 
 #include "abstractlogdata.h"
+#include "blockreader.h"
 #include "fileholder.h"
 #include "filewatcher.h"
 #include "loadingstatus.h"
 #include "logdataoperation.h"
 #include "logdataworker.h"
+#include "memorygovernor.h"
+#include "synchronization.h"
+#include "tokenindex.h"
 
 class LogFilteredData;
 
@@ -109,6 +117,9 @@ class LogData : public AbstractLogData {
 
         klogg::vector<char> buffer;
         klogg::vector<qint64> endOfLines;
+        // Indexes of lines cut because they were too long,
+        // such lines end without line feed
+        klogg::vector<size_t> splitLines;
 
         TextDecoder textDecoder;
 
@@ -116,13 +127,80 @@ class LogData : public AbstractLogData {
 
       public:
         klogg::vector<QString> decodeLines() const;
+        // Decodes all lines into one buffer instead of a string per line
+        DecodedLines decodeLinesToArena() const;
         klogg::vector<std::string_view> buildUtf8View() const;
 
       private:
+        friend class LogData;
+
+        bool isSplitLine( size_t index ) const;
+        klogg::vector<std::string_view> buildSplitUtf8View() const;
+
         mutable klogg::vector<char> utf8Data_;
+        // Accounts buffers of these lines in the memory governor
+        mutable MemoryReservation memoryReservation_;
+    };
+
+    // How lines read are used, decides the page cache hints for the read
+    enum class ReadPurpose {
+        // Single lines or ranges asked for by other code, no hints
+        Lines,
+        // Lines shown in a view, lines around are read ahead for scrolling
+        View,
+        // Chunks of a one-off scan, pages are dropped as the policy says
+        Scan,
+    };
+
+    RawLines getLinesRaw( LineNumber first, LinesCount number,
+                          ReadPurpose purpose = ReadPurpose::Lines ) const;
+
+    // Lines with the buffer being filled by the reader, they can be
+    // decoded when the future is ready. No future if nothing is read.
+    struct PendingRawLines {
+        RawLines lines;
+        std::future<int64_t> bytesRead;
     };
 
-    RawLines getLinesRaw( LineNumber first, LinesCount number ) const;
+    // Reader of the attached file with several reads in flight
+    std::unique_ptr<BlockReader> createBlockReader( int queueDepth ) const;
+    PendingRawLines getLinesRawAsync( LineNumber first, LinesCount number,
+                                      BlockReader& reader ) const;
+
+    // Copies bytes of the lines from the file to the output without decoding them,
+    // adjacent ranges are copied with a single call.
+    bool exportRawLineRanges( const LineRanges& ranges, QFileDevice& output,
+                              const std::function<bool( uint64_t, uint64_t )>& progress ) const;
+
+    // Filters the lines (or all lines of the file) using line hashes from the index.
+    // Returns nothing if line hashes were not indexed.
+    std::optional<SearchResultArray>
+    filterDuplicateLines( DuplicateLinesFilter filter, LineNumber boundary,
+                          const std::optional<SearchResultArray>& lines ) const;
+
+    // Lines of the levels detected while indexing.
+    // Returns nothing if log levels were not indexed.
+    std::optional<SearchResultArray> linesOfLogLevels( LogLevels levels ) const;
+    // Number of lines of the level between consecutive boundaries.
+    // Returns nothing if log levels were not indexed.
+    std::optional<klogg::vector<uint64_t>>
+    countLogLevelLines( LogLevel level, const klogg::vector<LineNumber>& boundaries ) const;
+
+    // True if record starts were indexed for every line
+    bool hasRecords() const;
+    // All lines of the multi-line records containing any of the lines.
+    // Returns nothing if records were not indexed.
+    std::optional<SearchResultArray> expandToRecords( const SearchResultArray& lines ) const;
+    // Lines of the records having all their lines among the lines.
+    // Returns nothing if records were not indexed.
+    std::optional<SearchResultArray> wholeRecordsOf( const SearchResultArray& lines ) const;
+
+    // Returns lines containing the token if the whole text is a token
+    // of the configured token index and the index is up to date.
+    // Lines found in the index are read to be checked, so it is called
+    // off the GUI thread. Returns nothing if interrupted.
+    std::optional<SearchResultArray> findTokenLines( const QString& token,
+                                                     AtomicFlag& interruptRequested ) const;
 
   Q_SIGNALS:
     // Sent during the 'attach' process to signal progress
@@ -148,10 +226,15 @@ class LogData : public AbstractLogData {
     QString doGetExpandedLineString( LineNumber line ) const override;
     klogg::vector<QString> doGetLines( LineNumber first, LinesCount number ) const override;
     klogg::vector<QString> doGetExpandedLines( LineNumber first, LinesCount number ) const override;
+    DecodedLines doGetLinesView( LineNumber first, LinesCount number ) const override;
+    bool doCanExportRawLines() const override;
+    bool doExportRawLines( LineNumber first, LinesCount number, QFileDevice& output,
+                           const std::function<bool( uint64_t, uint64_t )>& progress ) const override;
     LineNumber doGetLineNumber( LineNumber index ) const override;
     LinesCount doGetNbLine() const override;
     LineLength doGetMaxLength() const override;
     LineLength doGetLineLength( LineNumber line ) const override;
+    bool doIsLineContinued( LineNumber line ) const override;
     void doSetDisplayEncoding( const char* encoding ) override;
     QTextCodec* doGetDisplayEncoding() const override;
     void doAttachReader() const override;
@@ -159,9 +242,21 @@ class LogData : public AbstractLogData {
 
     void reOpenFile() const;
 
+    // Starts indexing tokens of lines added since the last update
+    void updateTokenIndex();
+    // Stops the token indexing and throws the index away
+    void resetTokenIndex();
+    // Runs on the token index thread until all lines are indexed
+    void buildTokenIndex( const QString& pattern );
+
     klogg::vector<QString> getLinesFromFile( LineNumber first, LinesCount number,
                                            QString ( *processLine )( QString&& ) ) const;
 
+    // Fills everything but the contents of the buffer, returns the offset to read
+    // the buffer from, or nothing if the lines are out of bounds
+    std::optional<OffsetInFile> prepareRawLines( RawLines& rawLines, LineNumber first,
+                                                 LinesCount number ) const;
+
   private:
     mutable std::unique_ptr<FileHolder> attached_file_;
 
@@ -182,7 +277,23 @@ class LogData : public AbstractLogData {
     TextCodecHolder codec_;
     MonitoredFileStatus fileChangedOnDisk_;
 
+    // When the pending file change was first noticed, for follow lag
+    std::optional<std::chrono::steady_clock::time_point> fileChangeNoticedTime_;
+
     QString prefilterPattern_;
+
+    MemoryRegistration decodeBuffersMemory_;
+
+    // Token index is built on its own thread after indexing, guarded by the mutex
+    mutable SharedMutex tokenIndexMutex_;
+    TokenIndex tokenIndex_;
+    QString tokenIndexPattern_;
+    qint64 tokenIndexedSize_ = 0;
+    bool isTokenIndexBuilding_ = false;
+    MemoryRegistration tokenIndexMemory_;
+
+    AtomicFlag tokenIndexInterrupt_;
+    QThreadPool tokenIndexPool_;
 };
 
 #endif
@@ -41,6 +41,9 @@
 
 #include "containers.h"
 #include "linetypes.h"
+#include <memory>
+#include <optional>
+#include <string>
 #include <qthreadpool.h>
 #include <variant>
 
@@ -50,17 +53,24 @@
 
 #if !defined( Q_MOC_RUN )
 #include <tbb/enumerable_thread_specific.h>
+#include <tbb/concurrent_queue.h>
 #include <tbb/flow_graph.h>
 #include <tbb/task_group.h>
 #endif
 
 #include "atomicflag.h"
 #include "filedigest.h"
+#include "memorygovernor.h"
 #include "synchronization.h"
 
 #include "encodingdetector.h"
+#include "linehashindex.h"
 #include "linepositionarray.h"
+#include "loglevelindex.h"
 #include "loadingstatus.h"
+#include "recordindex.h"
+
+class PatternMatcher;
 
 struct IndexedHash {
     qint64 size = 0;
@@ -141,9 +151,55 @@ public:
     // Atomically add to all the existing
     // indexing data.
     void addAll( const klogg::vector<char>& block, LineLength length,
-                 const FastLinePositionArray& linePosition, QTextCodec* encoding )
+                 const FastLinePositionArray& linePosition, QTextCodec* encoding,
+                 const klogg::vector<uint64_t>& lineHashes = {},
+                 const klogg::vector<LogLevel>& lineLevels = {},
+                 const klogg::vector<bool>& lineRecordStarts = {},
+                 const klogg::vector<size_t>& splitLines = {} )
+    {
+        data_->addAll( block, length, linePosition, encoding, lineHashes, lineLevels,
+                       lineRecordStarts, splitLines );
+    }
+
+    // Lines cut because they were too long, continued in the next line
+    const SearchResultArray& getSplitLines() const
+    {
+        return data_->splitLines_;
+    }
+
+    // True if every indexed line has a hash
+    bool hasLineHashes() const
+    {
+        return data_->hasLineHashes();
+    }
+
+    std::optional<SearchResultArray>
+    filterDuplicateLines( DuplicateLinesFilter filter, LineNumber boundary,
+                          const std::optional<SearchResultArray>& lines ) const
+    {
+        return data_->filterDuplicateLines( filter, boundary, lines );
+    }
+
+    // True if every indexed line has a log level
+    bool hasLogLevels() const
+    {
+        return data_->hasLogLevels();
+    }
+
+    const LogLevelIndex& getLogLevels() const
+    {
+        return data_->logLevels_;
+    }
+
+    // True if every indexed line is known to start a record or not
+    bool hasRecords() const
+    {
+        return data_->hasRecords();
+    }
+
+    const RecordIndex& getRecords() const
     {
-        data_->addAll( block, length, linePosition, encoding );
+        return data_->records_;
     }
 
     void setHeaderHash( quint64 digest, qint64 size )
@@ -217,7 +273,21 @@ private:
     // Atomically add to all the existing
     // indexing data.
     void addAll( const klogg::vector<char>& block, LineLength length,
-                 const FastLinePositionArray& linePosition, QTextCodec* encoding );
+                 const FastLinePositionArray& linePosition, QTextCodec* encoding,
+                 const klogg::vector<uint64_t>& lineHashes,
+                 const klogg::vector<LogLevel>& lineLevels,
+                 const klogg::vector<bool>& lineRecordStarts,
+                 const klogg::vector<size_t>& splitLines );
+
+    bool hasLineHashes() const;
+    // Returns nothing if line hashes were not indexed
+    std::optional<SearchResultArray>
+    filterDuplicateLines( DuplicateLinesFilter filter, LineNumber boundary,
+                          const std::optional<SearchResultArray>& lines ) const;
+
+    bool hasLogLevels() const;
+
+    bool hasRecords() const;
 
     // Completely clear the indexing data.
     void clear();
@@ -235,6 +305,11 @@ private:
 
     LineLength maxLength_;
 
+    LineHashIndex lineHashes_;
+    LogLevelIndex logLevels_;
+    RecordIndex records_;
+    SearchResultArray splitLines_;
+
     int progress_{};
 
     FileDigest hashBuilder_;
@@ -245,6 +320,9 @@ private:
 
     bool useFastModificationDetection_ = true;
 
+    MemoryRegistration memoryRegistration_
+        = MemoryGovernor::instance().registerConsumer( "Line index", MemoryShedPriority::LineIndex );
+
     friend ConstAccessor;
     friend MutateAccessor;
 };
@@ -260,6 +338,34 @@ struct IndexingState {
 
     QTextCodec* encodingGuess{};
     QTextCodec* fileTextCodec{};
+
+    // Hashes of lines ended in the current block, the digest
+    // accumulates the line that continues in the next block
+    bool hashLines = false;
+    FileDigest lineDigest;
+    klogg::vector<uint64_t> lineHashes;
+
+    // Levels and record start flags of lines ended in the current block,
+    // the prefix keeps the start of the line that continues in the next block
+    bool classifyLevels = false;
+    LogLevelClassifier levelClassifier;
+    klogg::vector<LogLevel> lineLevels;
+
+    std::shared_ptr<PatternMatcher> recordStartMatcher;
+    klogg::vector<bool> lineRecordStarts;
+
+    std::string linePrefix;
+    size_t linePrefixSize = 0;
+
+    // Lines longer than the size in bytes are cut into lines without
+    // line feed, positions of such lines in the current block are kept
+    OffsetInFile::UnderlyingType splitLineSize{};
+    klogg::vector<size_t> splitLines;
+
+    // Blocks that look like binary data are cut into lines of binary line size
+    bool detectBinary = false;
+    bool isBinaryBlock = false;
+    size_t binaryBlocksCount = 0;
 };
 
 using OperationResult = std::variant<bool, MonitoredFileStatus>;
@@ -288,6 +394,8 @@ protected:
     using BlockBuffer = klogg::vector<char>;
     using BlockData = std::pair<OffsetInFile::UnderlyingType, BlockBuffer*>;
     using BlockPrefetcher = tbb::flow::limiter_node<BlockData>;
+    // Buffers of parsed blocks are reused for next reads
+    using BlockBufferPool = tbb::concurrent_queue<BlockBuffer*>;
 
     // Returns the total size indexed
     // Modify the passed linePosition and maxLength
@@ -304,7 +412,8 @@ private:
     void guessEncoding( const BlockBuffer& block, IndexingData::MutateAccessor& scopedAccessor,
                         IndexingState& state ) const;
 
-    std::chrono::microseconds readFileInBlocks( QFile& file, BlockPrefetcher& blockPrefetcher );
+    std::chrono::microseconds readFileInBlocks( QFile& file, BlockPrefetcher& blockPrefetcher,
+                                                BlockBufferPool& bufferPool );
     void indexNextBlock( IndexingState& state, const BlockData& blockData );
 };
 
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LOGDIFF_H
+#define KLOGG_LOGDIFF_H
+
+#include <cstdint>
+#include <functional>
+
+#include <QString>
+
+#include "atomicflag.h"
+#include "containers.h"
+#include "logfiltereddataworker.h"
+
+class LogData;
+
+enum class LogDiffMode {
+    // Line differs if its content is not present in the other file at all
+    Lines,
+    // Files are aligned by lines unique in both of them (patience diff),
+    // line differs if it is not a part of the alignment
+    Aligned,
+};
+
+struct LogDiffParameters {
+    LogDiffMode mode = LogDiffMode::Aligned;
+    // Matches of this regular expression (e.g. timestamps or ids)
+    // are ignored when lines are compared
+    QString maskPattern;
+};
+
+struct LogDiffResult {
+    SearchResultArray onlyInFirst;
+    SearchResultArray onlyInSecond;
+
+    bool isInterrupted = false;
+};
+
+// Hashes lines of both files on several threads and finds lines that are
+// present only in one of them. Lines are compared by 64 bit hash of decoded
+// text with the trailing CR removed.
+// Progress callback is called from the calling thread.
+LogDiffResult diffLogs( const LogData& first, const LogData& second,
+                        const LogDiffParameters& parameters, AtomicFlag& interruptRequested,
+                        const std::function<void( int )>& progress );
+
+namespace logdiff {
+// Exposed for tests
+LogDiffResult diffHashes( const klogg::vector<uint64_t>& first,
+                          const klogg::vector<uint64_t>& second, LogDiffMode mode,
+                          AtomicFlag& interruptRequested );
+} // namespace logdiff
+
+#endif
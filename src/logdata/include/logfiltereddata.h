@@ -42,6 +42,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <unordered_map>
 
@@ -56,6 +57,8 @@
 #include "hsregularexpression.h"
 #include "linetypes.h"
 #include "logfiltereddataworker.h"
+#include "loglevelindex.h"
+#include "memorygovernor.h"
 #include "synchronization.h"
 
 class LogData;
@@ -89,6 +92,14 @@ class LogFilteredData : public AbstractLogData {
     void interruptSearch();
     // Clear the search and the list of results.
     void clearSearch( bool dropCache = false );
+    // Replaces the search results by lines computed without searching,
+    // e.g. from an index. Such results are not updated when the file grows.
+    void setMatchingLines( SearchResultArray lines );
+    // In record mode a matching line selects all lines of its multi-line
+    // record, applies to results found after the change.
+    // Does nothing if records were not indexed.
+    void setRecordMode( bool isEnabled );
+    bool isRecordMode() const;
 
     // Returns the line number in the original LogData where the element
     // 'index' was found.
@@ -101,6 +112,8 @@ class LogFilteredData : public AbstractLogData {
     LinesCount getNbTotalLines() const;
     // Returns the number of matches (independently of the visibility)
     LinesCount getNbMatches() const;
+    // Returns the source line numbers of all matches
+    SearchResultArray getMatchingLines() const;
     // Returns the number of marks (independently of the visibility)
     LinesCount getNbMarks() const;
 
@@ -137,6 +150,11 @@ class LogFilteredData : public AbstractLogData {
     Visibility visibility() const;
 
     void iterateOverLines( const std::function<void( LineNumber )>& callback ) const;
+
+    // Number of source lines of the level between consecutive boundaries.
+    // Returns nothing if log levels were not indexed.
+    std::optional<klogg::vector<uint64_t>>
+    countLogLevelLines( LogLevel level, const klogg::vector<LineNumber>& boundaries ) const;
   Q_SIGNALS:
     // Sent when the search has progressed, give the number of matches (so far)
     // and the percentage of completion
@@ -153,12 +171,17 @@ class LogFilteredData : public AbstractLogData {
     QString doGetExpandedLineString( LineNumber line ) const override;
     klogg::vector<QString> doGetLines( LineNumber first, LinesCount number ) const override;
     klogg::vector<QString> doGetExpandedLines( LineNumber first, LinesCount number ) const override;
+    DecodedLines doGetLinesView( LineNumber first, LinesCount number ) const override;
+    bool doCanExportRawLines() const override;
+    bool doExportRawLines( LineNumber first, LinesCount number, QFileDevice& output,
+                           const std::function<bool( uint64_t, uint64_t )>& progress ) const override;
     klogg::vector<QString> doGetLines( LineNumber first, LinesCount number,
                                      const std::function<QString( LineNumber )>& lineGetter ) const;
     LineNumber doGetLineNumber( LineNumber index ) const override;
     LinesCount doGetNbLine() const override;
     LineLength doGetMaxLength() const override;
     LineLength doGetLineLength( LineNumber line ) const override;
+    bool doIsLineContinued( LineNumber line ) const override;
 
     void doSetDisplayEncoding( const char* encoding ) override;
     QTextCodec* doGetDisplayEncoding() const override;
@@ -173,11 +196,15 @@ class LogFilteredData : public AbstractLogData {
     bool isLineMatched( LineNumber lineNumber ) const;
     // Returns wheither the passed line has a mark on it.
     bool isLineMarked( LineNumber line ) const;
+    // Inverse search in record mode shows the records without any match
+    bool isInverseRecordSearch() const;
 
     // List of the matching line numbers
     SearchResultArray matching_lines_;
     SearchResultArray marks_;
     SearchResultArray marks_and_matches_;
+    // Lines found by inverse search in record mode, whole records of them match
+    SearchResultArray inverseMatches_;
 
     const LogData* sourceLogData_;
 
@@ -187,6 +214,8 @@ class LogFilteredData : public AbstractLogData {
     // Number of lines of the LogData that has been searched for:
     LinesCount nbLinesProcessed_;
 
+    bool isRecordMode_ = false;
+
     Visibility visibility_;
 
     LogFilteredDataWorker workerThread_;
@@ -227,6 +256,9 @@ class LogFilteredData : public AbstractLogData {
     std::unordered_map<SearchCacheKey, CachedSearchResult, SearchCacheKeyHash> searchResultsCache_;
     SearchCacheKey currentSearchKey_;
 
+    MemoryRegistration searchResultsCacheMemory_;
+    MemoryRegistration searchResultsMemory_;
+
     SearchCacheKey makeCacheKey( const RegularExpressionPattern& regExp, LineNumber startLine,
                                  LineNumber endLine )
     {
@@ -234,6 +266,10 @@ class LogFilteredData : public AbstractLogData {
     }
 
     void updateSearchResultsCache();
+    void updateSearchResultsCacheUsage();
+    void updateSearchResultsUsage();
+    // Called by memory governor when over the budget
+    void shedSearchResultsCache();
 
     inline LineNumber getExpectedSearchEnd( const SearchCacheKey& cacheKey ) const
     {
@@ -243,6 +279,9 @@ class LogFilteredData : public AbstractLogData {
     // Utility functions
     const SearchResultArray& currentResultArray() const;
     LineNumber findLogDataLine( LineNumber lineNum ) const;
+    // Groups lines into ranges of consecutive source lines,
+    // lines not found in the source get empty ranges
+    LineRanges findLogDataRanges( LineNumber first_line, LinesCount number ) const;
     LineNumber findFilteredLine( LineNumber lineNum ) const;
 
     // update maxLengthMarks_ when a Marks was changed.
@@ -126,6 +126,9 @@ private:
     LinesCount nbMatches_{ 0 };
 };
 
+// Number of threads matching lines in parallel, from search thread pool settings
+uint32_t searchThreadsCount();
+
 class SearchOperation : public QObject {
     Q_OBJECT
 public:
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LOGLEVELINDEX_H
+#define KLOGG_LOGLEVELINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <QFlags>
+#include <QRegularExpression>
+
+#include "containers.h"
+#include "linetypes.h"
+#include "logfiltereddataworker.h"
+
+enum class LogLevel : uint8_t {
+    None = 0,
+    Trace = 1 << 0,
+    Debug = 1 << 1,
+    Info = 1 << 2,
+    Warning = 1 << 3,
+    Error = 1 << 4,
+};
+
+Q_DECLARE_FLAGS( LogLevels, LogLevel )
+Q_DECLARE_OPERATORS_FOR_FLAGS( LogLevels )
+
+// Finds the level keyword (INFO, warn, Error, FATAL...) among the first
+// searchDepth bytes of a line. Works on bytes, so only encodings with
+// single byte line feed are supported.
+// A level pattern restricts the keyword to its place in the log format
+// (e.g. "^.{24}(\w+)" for a fixed column or "level=(\w+)" for a prefix):
+// the first capture group, or the whole match without groups, is the keyword.
+class LogLevelClassifier {
+  public:
+    explicit LogLevelClassifier( size_t searchDepth = 64,
+                                 const QRegularExpression& levelPattern = {} );
+
+    size_t searchDepth() const
+    {
+        return searchDepth_;
+    }
+
+    LogLevel classify( const char* line, size_t length ) const;
+
+  private:
+    LogLevel classifyByPattern( const char* line, size_t length ) const;
+
+  private:
+    size_t searchDepth_;
+    QRegularExpression levelPattern_;
+    bool hasLevelPattern_;
+};
+
+// Lines of every log level as bitmaps, lines without level are not stored.
+class LogLevelIndex {
+  public:
+    static constexpr size_t LevelsCount = 5;
+
+    // Drops levels of lines starting from firstLine (e.g. a line that had
+    // no line feed when it was indexed) and appends the new levels
+    void append( LineNumber firstLine, const klogg::vector<LogLevel>& levels );
+    void clear();
+
+    LinesCount size() const;
+    size_t allocatedSize() const;
+
+    const SearchResultArray& linesOfLevel( LogLevel level ) const;
+    SearchResultArray linesOfLevels( LogLevels levels ) const;
+
+  private:
+    std::array<SearchResultArray, LevelsCount> lines_;
+    LineNumber::UnderlyingType size_ = 0;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_PAGECACHE_H
+#define KLOGG_PAGECACHE_H
+
+#include <cstdint>
+
+enum class PageCacheAdvice {
+    // File is read from start to end, larger read-ahead pays off
+    Sequential,
+    // Range will be read soon, e.g. lines around the visible ones
+    WillNeed,
+    // Range was read and won't be needed again, e.g. behind a scan
+    DontNeed,
+};
+
+// Passes the advice to the kernel page cache where it is supported
+// (posix_fadvise on Linux), does nothing elsewhere
+void advisePageCache( int fileDescriptor, int64_t offset, int64_t size, PageCacheAdvice advice );
+
+// True if pages of a one-off scan (indexing, search) of the file should be
+// dropped from page cache after reading, according to the configured policy.
+// Automatic policy drops pages of files too large to stay cached anyway.
+bool shouldDropScannedPages( int64_t fileSize );
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_RECORDINDEX_H
+#define KLOGG_RECORDINDEX_H
+
+#include <cstddef>
+
+#include "containers.h"
+#include "linetypes.h"
+#include "logfiltereddataworker.h"
+
+// First lines of multi-line records, e.g. a message followed by its stack
+// trace. Lines before the first record start are a record of their own.
+class RecordIndex {
+  public:
+    // Record start pattern is matched against this many bytes from the line start
+    static constexpr size_t StartSearchDepth = 256;
+
+    // Drops flags of lines starting from firstLine (e.g. a line that had
+    // no line feed when it was indexed) and appends the new flags
+    void append( LineNumber firstLine, const klogg::vector<bool>& isRecordStart );
+    void clear();
+
+    LinesCount size() const;
+    size_t allocatedSize() const;
+
+    const SearchResultArray& recordStarts() const;
+
+    // All lines of the records containing any of the passed lines,
+    // lines that are not indexed yet are kept as is
+    SearchResultArray expandToRecords( const SearchResultArray& lines ) const;
+    // Passed lines of the records having all their lines passed, e.g. records
+    // without a match for inverse search results; lines that are not
+    // indexed yet are kept as is
+    SearchResultArray wholeRecordsOf( const SearchResultArray& lines ) const;
+
+  private:
+    SearchResultArray starts_;
+    LineNumber::UnderlyingType size_ = 0;
+};
+
+#endif
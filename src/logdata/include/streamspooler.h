@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_STREAMSPOOLER_H
+#define KLOGG_STREAMSPOOLER_H
+
+#include <atomic>
+#include <memory>
+
+#include <QString>
+
+// Copies a stream that can't be seeked (stdin, FIFO, socket) into a spool file,
+// the file grows as data comes and is indexed and followed as any
+// growing log. Reading is done by a separate thread, blocked in read
+// most of the time, so when the spooler is destroyed the thread is left
+// to finish on its own and stops without writing after its next read.
+class StreamSpooler {
+  public:
+    // Name standard input has on command line
+    static constexpr auto StdinName = "-";
+
+    StreamSpooler( const QString& streamName, const QString& spoolFileName );
+    ~StreamSpooler();
+
+    StreamSpooler( const StreamSpooler& ) = delete;
+    StreamSpooler& operator=( const StreamSpooler& ) = delete;
+
+    // Returns false if the spool file can't be created
+    bool start();
+
+    QString streamName() const;
+    QString spoolFileName() const;
+
+    // Stdin, FIFO or Unix domain socket (named pipe on Windows)
+    static bool isStream( const QString& fileName );
+
+  private:
+    struct SpoolState {
+        QString streamName;
+        QString spoolFileName;
+        std::atomic_bool isStopRequested{};
+    };
+
+    static void spool( const std::shared_ptr<SpoolState>& state );
+
+    std::shared_ptr<SpoolState> state_;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_TEMPLATEMINING_H
+#define KLOGG_TEMPLATEMINING_H
+
+#include <cstdint>
+#include <functional>
+
+#include <QString>
+
+#include "atomicflag.h"
+#include "containers.h"
+#include "linechunks.h"
+
+class LogData;
+
+struct TemplateMiningParameters {
+    // Share of equal tokens needed for a line to join an existing template
+    double similarityThreshold = 0.5;
+    // Number of leading tokens used to route lines in the parse tree
+    size_t prefixDepth = 2;
+    // Tokens that do not fit into a tree node are routed to its wildcard child
+    size_t maxChildren = 100;
+};
+
+struct LogTemplate {
+    // Tokens separated by spaces, variable tokens are replaced by <*>
+    QString text;
+    // Regular expression matching lines of this template
+    QString pattern;
+    uint64_t count = 0;
+    LineNumber firstLine;
+    LineNumber lastLine;
+};
+
+struct TemplateMiningResult {
+    // Sorted by count, most frequent first
+    klogg::vector<LogTemplate> templates;
+
+    uint64_t processedLines = 0;
+    bool isInterrupted = false;
+};
+
+// Groups lines of the selection into templates using Drain-like fixed depth
+// parse tree: lines are routed by token count and leading tokens and join
+// the most similar template of the leaf, tokens with digits are always variable.
+// Every thread builds its own tree, trees are merged at the end.
+// Progress callback is called from the calling thread.
+TemplateMiningResult mineTemplates( const LogData& logData, const LinesSelection& selection,
+                                    const TemplateMiningParameters& parameters,
+                                    AtomicFlag& interruptRequested,
+                                    const std::function<void( int )>& progress );
+
+#endif
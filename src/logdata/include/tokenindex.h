@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_TOKENINDEX_H
+#define KLOGG_TOKENINDEX_H
+
+#include <cstdint>
+
+#include <QRegularExpression>
+#include <QString>
+
+#include "containers.h"
+#include "linetypes.h"
+#include "logfiltereddataworker.h"
+
+struct TokenPosting {
+    uint64_t tokenHash;
+    LineNumber::UnderlyingType line;
+};
+
+// Finds tokens (e.g. trace or request ids) in lines using a regular expression
+// matching the whole token. Like the default search, tokens are matched
+// and compared case-insensitively.
+class TokenExtractor {
+  public:
+    explicit TokenExtractor( const QString& pattern );
+
+    bool isValid() const;
+
+    // True if the whole text is a token
+    bool isToken( const QString& text ) const;
+    // True if the token is one of tokens extracted from the text
+    bool hasToken( QStringView text, const QString& token ) const;
+
+    void extract( LineNumber line, QStringView text, klogg::vector<TokenPosting>& postings ) const;
+
+    static uint64_t hashToken( QStringView token );
+
+  private:
+    QRegularExpression regex_;
+};
+
+// Lines of every token of a file. Postings are kept sorted by token hash,
+// recently appended ones are merged into the main array once there are
+// enough of them, so appending in follow mode does not rewrite the whole index.
+class TokenIndex {
+  public:
+    // Drops postings of lines starting from firstLine (e.g. a line that had
+    // no line feed when it was indexed) and adds postings of new lines
+    void append( LineNumber firstLine, klogg::vector<TokenPosting> postings,
+                 LinesCount indexedLines );
+    void clear();
+
+    LinesCount indexedLines() const;
+    size_t allocatedSize() const;
+
+    SearchResultArray find( uint64_t tokenHash ) const;
+
+  private:
+    void dropLines( LineNumber firstLine );
+
+  private:
+    klogg::vector<TokenPosting> postings_;
+    klogg::vector<TokenPosting> recentPostings_;
+    LineNumber::UnderlyingType indexedLines_ = 0;
+    // Postings of lines before this one may be in the main array
+    LineNumber::UnderlyingType mergedLines_ = 0;
+};
+
+#endif
@@ -69,6 +69,51 @@ klogg::vector<QString> AbstractLogData::getExpandedLines( LineNumber first_line,
     return doGetExpandedLines( first_line, number );
 }
 
+// Simple wrapper in order to use a clean Template Method
+DecodedLines AbstractLogData::getLinesView( LineNumber first_line, LinesCount number ) const
+{
+    return doGetLinesView( first_line, number );
+}
+
+QString AbstractLogData::getLinesText( LineNumber first_line, LinesCount number,
+                                       LineNumber end_line, const QString& separator ) const
+{
+    const auto lines = getLinesView( first_line, number );
+
+    QString text;
+    text.reserve( lines.arena().size()
+                  + static_cast<int>( lines.size() ) * separator.size() );
+    for ( auto i = 0u; i < lines.size(); ++i ) {
+        const auto line = lines[ i ];
+        text.append( line.data(), static_cast<int>( line.size() ) );
+
+        // Filtered data may have the line without its rest
+        const auto index = first_line + LinesCount( i );
+        const auto nextIndex = index + 1_lcount;
+        const auto isJoined = nextIndex < end_line && isLineContinued( index )
+                              && getLineNumber( nextIndex ) == getLineNumber( index ) + 1_lcount;
+        if ( !isJoined ) {
+            text.append( separator );
+        }
+    }
+
+    return text;
+}
+
+// Simple wrapper in order to use a clean Template Method
+bool AbstractLogData::canExportRawLines() const
+{
+    return doCanExportRawLines();
+}
+
+// Simple wrapper in order to use a clean Template Method
+bool AbstractLogData::exportRawLines(
+    LineNumber first_line, LinesCount number, QFileDevice& output,
+    const std::function<bool( uint64_t, uint64_t )>& progress ) const
+{
+    return doExportRawLines( first_line, number, output, progress );
+}
+
 LineNumber AbstractLogData::getLineNumber( LineNumber index ) const
 {
     LineNumber ln = doGetLineNumber( index );
@@ -95,6 +140,12 @@ LineLength AbstractLogData::getLineLength( LineNumber line ) const
     return doGetLineLength( line );
 }
 
+// Simple wrapper in order to use a clean Template Method
+bool AbstractLogData::isLineContinued( LineNumber line ) const
+{
+    return doIsLineContinued( line );
+}
+
 void AbstractLogData::setDisplayEncoding( const char* encoding )
 {
     doSetDisplayEncoding( encoding );
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binarycontent.h"
+
+#include <algorithm>
+#include <array>
+
+#include <QFile>
+#include <simdutf.h>
+
+#include "containers.h"
+#include "log.h"
+
+namespace {
+
+constexpr int64_t FileSampleSize = 64 * 1024;
+
+// Text may have a few NULs (padding, broken writes), but not that many
+constexpr size_t MaxNulPercent = 1;
+constexpr size_t MaxControlPercent = 10;
+constexpr size_t MaxControlPercentWithInvalidUtf8 = 1;
+
+// Longest UTF-8 sequence that can be cut by the end of the data
+constexpr size_t MaxTruncatedSequence = 3;
+
+// Indexing blocks are checked by evenly spaced samples, not byte by byte
+constexpr size_t BlockSamplesCount = 16;
+constexpr size_t BlockSampleSize = 4 * 1024;
+
+uint32_t codeUnitAt( const unsigned char* data, int width, bool isLittleEndian )
+{
+    uint32_t unit = 0;
+    for ( int i = 0; i < width; ++i ) {
+        const auto byteIndex = isLittleEndian ? width - 1 - i : i;
+        unit = ( unit << 8 ) | data[ byteIndex ];
+    }
+    return unit;
+}
+
+bool isControl( uint32_t unit )
+{
+    switch ( unit ) {
+    case '\t':
+    case '\n':
+    case '\v':
+    case '\f':
+    case '\r':
+    case 0x1b: // escape sequences of colored output
+        return false;
+    default:
+        return unit < 0x20 || unit == 0x7f;
+    }
+}
+
+struct UnitCounts {
+    size_t units = 0;
+    size_t nuls = 0;
+    size_t controls = 0;
+};
+
+void countUnits( std::string_view data, const EncodingParameters& encodingParams,
+                 UnitCounts& counts )
+{
+    const auto width = std::max( 1, encodingParams.lineFeedWidth );
+    const auto isLittleEndian = encodingParams.lineFeedIndex == 0;
+
+    const auto unitsCount = data.size() / static_cast<size_t>( width );
+    const auto* bytes = reinterpret_cast<const unsigned char*>( data.data() );
+
+    for ( size_t i = 0; i < unitsCount; ++i ) {
+        const auto unit = codeUnitAt( bytes + i * static_cast<size_t>( width ), width,
+                                      isLittleEndian );
+        if ( unit == 0 ) {
+            ++counts.nuls;
+        }
+        else if ( isControl( unit ) ) {
+            ++counts.controls;
+        }
+    }
+    counts.units += unitsCount;
+}
+
+// Sequences cut by the beginning or the end of the data are not errors
+bool hasInvalidUtf8( std::string_view data )
+{
+    size_t skipped = 0;
+    while ( skipped < MaxTruncatedSequence && skipped < data.size()
+            && ( static_cast<unsigned char>( data[ skipped ] ) & 0xC0 ) == 0x80 ) {
+        ++skipped;
+    }
+    data.remove_prefix( skipped );
+
+    const auto validation = simdutf::validate_utf8_with_errors( data.data(), data.size() );
+    return validation.error != simdutf::error_code::SUCCESS
+           && validation.count + MaxTruncatedSequence < data.size();
+}
+
+template <typename InvalidUtf8Check>
+bool isBinary( const UnitCounts& counts, const EncodingParameters& encodingParams,
+               InvalidUtf8Check hasInvalidUtf8Data )
+{
+    if ( counts.units == 0 ) {
+        return false;
+    }
+
+    if ( counts.nuls * 100 > counts.units * MaxNulPercent
+         || counts.controls * 100 > counts.units * MaxControlPercent ) {
+        return true;
+    }
+
+    return encodingParams.isUtf8Compatible
+           && counts.controls * 100 > counts.units * MaxControlPercentWithInvalidUtf8
+           && hasInvalidUtf8Data();
+}
+
+} // namespace
+
+bool isBinaryContent( std::string_view data, const EncodingParameters& encodingParams )
+{
+    UnitCounts counts;
+    countUnits( data, encodingParams, counts );
+
+    return isBinary( counts, encodingParams, [ data ] { return hasInvalidUtf8( data ); } );
+}
+
+bool isBinaryBlock( std::string_view block, const EncodingParameters& encodingParams )
+{
+    if ( block.size() <= BlockSamplesCount * BlockSampleSize ) {
+        return isBinaryContent( block, encodingParams );
+    }
+
+    // Samples start at code unit boundaries, sample size is a multiple of any width
+    const auto width = static_cast<size_t>( std::max( 1, encodingParams.lineFeedWidth ) );
+    const auto step = ( block.size() - BlockSampleSize ) / ( BlockSamplesCount - 1 );
+
+    std::array<std::string_view, BlockSamplesCount> samples;
+    UnitCounts counts;
+    for ( size_t i = 0; i < BlockSamplesCount; ++i ) {
+        const auto sampleStart = i * step / width * width;
+        samples[ i ] = block.substr( sampleStart, BlockSampleSize );
+        countUnits( samples[ i ], encodingParams, counts );
+    }
+
+    return isBinary( counts, encodingParams, [ &samples ] {
+        return std::any_of( samples.cbegin(), samples.cend(), hasInvalidUtf8 );
+    } );
+}
+
+bool isBinaryFile( const QString& fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    klogg::vector<char> sample( static_cast<size_t>( FileSampleSize ) );
+    const auto readBytes = file.read( sample.data(), FileSampleSize );
+    if ( readBytes <= 0 ) {
+        return false;
+    }
+    sample.resize( static_cast<size_t>( readBytes ) );
+
+    const auto* codec = EncodingDetector::getInstance().detectEncoding( sample );
+    const auto isBinary
+        = isBinaryContent( { sample.data(), sample.size() }, EncodingParameters( codec ) );
+
+    LOG_INFO << "File " << fileName << " looks like " << ( isBinary ? "binary" : "text" )
+             << " data";
+    return isBinary;
+}
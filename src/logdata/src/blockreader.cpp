@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "blockreader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "log.h"
+#include "pagecache.h"
+
+namespace {
+
+// File handle of one worker, opened by the first request,
+// so idle workers don't hold the file
+class WorkerFile {
+  public:
+    WorkerFile( const QString& fileName, BlockReader::CacheHints cacheHints,
+                BlockReader::FileAccess fileAccess )
+        : file_{ fileName }
+        , cacheHints_{ cacheHints }
+        , fileAccess_{ fileAccess }
+    {
+    }
+
+    ~WorkerFile()
+    {
+        close();
+    }
+
+    void close()
+    {
+#ifdef Q_OS_LINUX
+        if ( directFd_ >= 0 ) {
+            ::close( directFd_ );
+            directFd_ = -1;
+        }
+#endif
+        file_.close();
+    }
+
+    WorkerFile( const WorkerFile& ) = delete;
+    WorkerFile& operator=( const WorkerFile& ) = delete;
+
+    int64_t read( int64_t offset, char* buffer, int64_t size )
+    {
+#ifdef Q_OS_LINUX
+        if ( cacheHints_.directIo ) {
+            if ( directFd_ < 0 ) {
+                directFd_ = ::open( QFile::encodeName( file_.fileName() ).constData(),
+                                    O_RDONLY | O_DIRECT );
+
+                if ( directFd_ >= 0 && !isExpectedFile() ) {
+                    ::close( directFd_ );
+                    directFd_ = -1;
+                    return -1;
+                }
+            }
+
+            if ( directFd_ >= 0 ) {
+                return readDirect( offset, buffer, size );
+            }
+
+            // E.g. tmpfs has no direct IO
+            LOG_WARNING << "Direct IO is not supported for " << file_.fileName();
+            cacheHints_.directIo = false;
+        }
+#endif
+
+        if ( !file_.isOpen() ) {
+            openFileByHandle( &file_ );
+            if ( !file_.isOpen() ) {
+                LOG_WARNING << "Block reader can't open " << file_.fileName() << ": "
+                            << file_.errorString();
+                return -1;
+            }
+
+            if ( !isExpectedFile() ) {
+                file_.close();
+                return -1;
+            }
+
+            if ( cacheHints_.dropBehind ) {
+                advisePageCache( file_.handle(), 0, file_.size(), PageCacheAdvice::Sequential );
+            }
+        }
+
+        if ( !file_.seek( offset ) ) {
+            return -1;
+        }
+
+        const auto readBytes = file_.read( buffer, size );
+        if ( cacheHints_.dropBehind && readBytes > 0 ) {
+            advisePageCache( file_.handle(), offset, readBytes, PageCacheAdvice::DontNeed );
+        }
+        return readBytes;
+    }
+
+  private:
+    // Checked right after opening, by name as the file watcher does
+    bool isExpectedFile() const
+    {
+        if ( fileAccess_.expectedId == FileId{} ) {
+            return true;
+        }
+
+        if ( FileId::getFileId( file_.fileName() ) != fileAccess_.expectedId ) {
+            LOG_WARNING << "Block reader opened " << file_.fileName()
+                        << ", but it is not the file being read anymore";
+            return false;
+        }
+        return true;
+    }
+
+#ifdef Q_OS_LINUX
+    // Direct reads must be aligned, so they go through an aligned buffer
+    int64_t readDirect( int64_t offset, char* buffer, int64_t size )
+    {
+        constexpr int64_t Alignment = 4096;
+
+        const auto alignedOffset = offset / Alignment * Alignment;
+        const auto alignedSize
+            = ( offset + size + Alignment - 1 ) / Alignment * Alignment - alignedOffset;
+
+        if ( alignedSize > alignedBufferSize_ ) {
+            alignedBuffer_.reset( static_cast<char*>(
+                std::aligned_alloc( Alignment, static_cast<size_t>( alignedSize ) ) ) );
+            alignedBufferSize_ = alignedBuffer_ ? alignedSize : 0;
+            if ( !alignedBuffer_ ) {
+                return -1;
+            }
+        }
+
+        int64_t alignedRead = 0;
+        while ( alignedRead < alignedSize ) {
+            const auto readBytes = ::pread( directFd_, alignedBuffer_.get() + alignedRead,
+                                            static_cast<size_t>( alignedSize - alignedRead ),
+                                            alignedOffset + alignedRead );
+            if ( readBytes < 0 && errno == EINTR ) {
+                continue;
+            }
+            if ( readBytes < 0 ) {
+                return -1;
+            }
+
+            alignedRead += readBytes;
+
+            // Only the end of file gives a short read
+            if ( readBytes == 0 || readBytes % Alignment != 0 ) {
+                break;
+            }
+        }
+
+        const auto skipped = offset - alignedOffset;
+        const auto copied = std::clamp( alignedRead - skipped, int64_t{ 0 }, size );
+        std::memcpy( buffer, alignedBuffer_.get() + skipped, static_cast<size_t>( copied ) );
+        return copied;
+    }
+
+    struct FreeDeleter {
+        void operator()( char* buffer ) const
+        {
+            std::free( buffer );
+        }
+    };
+
+    int directFd_ = -1;
+    std::unique_ptr<char, FreeDeleter> alignedBuffer_;
+    int64_t alignedBufferSize_ = 0;
+#endif
+
+    QFile file_;
+    BlockReader::CacheHints cacheHints_;
+    BlockReader::FileAccess fileAccess_;
+};
+
+} // namespace
+
+BlockReader::BlockReader( const QString& fileName, int queueDepth, CacheHints cacheHints,
+                          FileAccess fileAccess )
+    : fileName_{ fileName }
+    , cacheHints_{ cacheHints }
+    , fileAccess_{ fileAccess }
+{
+    const auto workersCount = std::max( 1, queueDepth );
+    workers_.reserve( static_cast<size_t>( workersCount ) );
+    for ( auto i = 0; i < workersCount; ++i ) {
+        workers_.emplace_back( [ this ] { work(); } );
+    }
+}
+
+BlockReader::~BlockReader()
+{
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        stopRequested_ = true;
+    }
+    wakeup_.notify_all();
+
+    for ( auto& worker : workers_ ) {
+        worker.join();
+    }
+}
+
+std::future<int64_t> BlockReader::read( int64_t offset, char* buffer, int64_t size )
+{
+    std::promise<int64_t> result;
+    auto future = result.get_future();
+
+    {
+        std::unique_lock<std::mutex> lock( mutex_ );
+        requests_.push_back( Request{ offset, buffer, size, std::move( result ) } );
+    }
+    wakeup_.notify_one();
+
+    return future;
+}
+
+int BlockReader::queueDepth() const
+{
+    return static_cast<int>( workers_.size() );
+}
+
+BlockReader::Stats BlockReader::stats() const
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    Stats stats;
+    stats.bytes = bytes_;
+    if ( busyTime_.count() > 0 ) {
+        stats.queueDepth = inFlightTime_ / busyTime_;
+        stats.megabytesPerSecond
+            = static_cast<double>( bytes_ ) / ( 1024 * 1024 ) / busyTime_.count();
+    }
+    return stats;
+}
+
+void BlockReader::updateStats( std::chrono::steady_clock::time_point now )
+{
+    if ( inFlight_ > 0 ) {
+        const auto passed = now - lastChange_;
+        busyTime_ += passed;
+        inFlightTime_ += passed * inFlight_;
+    }
+    lastChange_ = now;
+}
+
+void BlockReader::work()
+{
+    WorkerFile file( fileName_, cacheHints_, fileAccess_ );
+
+    while ( true ) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            wakeup_.wait( lock, [ this ] { return stopRequested_ || !requests_.empty(); } );
+
+            if ( requests_.empty() ) {
+                return;
+            }
+
+            request = std::move( requests_.front() );
+            requests_.pop_front();
+
+            updateStats( std::chrono::steady_clock::now() );
+            ++inFlight_;
+        }
+
+        const auto readBytes = file.read( request.offset, request.buffer, request.size );
+
+        bool hasNoRequests = false;
+        {
+            std::unique_lock<std::mutex> lock( mutex_ );
+            updateStats( std::chrono::steady_clock::now() );
+            --inFlight_;
+            bytes_ += static_cast<uint64_t>( std::max( int64_t{ 0 }, readBytes ) );
+            hasNoRequests = requests_.empty();
+        }
+
+        request.result.set_value( readBytes );
+
+        if ( fileAccess_.keepClosed && hasNoRequests ) {
+            file.close();
+        }
+    }
+}
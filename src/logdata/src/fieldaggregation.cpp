@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fieldaggregation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QRegularExpression>
+
+#include <robin_hood.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "log.h"
+#include "logdata.h"
+#include "tracing.h"
+
+namespace {
+
+// Values are kept as UTF-16 to avoid converting every extracted value
+using ValueCounts = robin_hood::unordered_flat_map<std::u16string, uint64_t>;
+
+std::u16string toKey( QStringView value )
+{
+    return std::u16string( reinterpret_cast<const char16_t*>( value.data() ),
+                           static_cast<size_t>( value.size() ) );
+}
+
+QString jsonValueToString( const QJsonValue& value )
+{
+    switch ( value.type() ) {
+    case QJsonValue::String:
+        return value.toString();
+    case QJsonValue::Double:
+        return QString::number( value.toDouble(), 'g', 15 );
+    case QJsonValue::Bool:
+        return value.toBool() ? QStringLiteral( "true" ) : QStringLiteral( "false" );
+    case QJsonValue::Null:
+        return QStringLiteral( "null" );
+    case QJsonValue::Array:
+        return QString::fromUtf8(
+            QJsonDocument( value.toArray() ).toJson( QJsonDocument::Compact ) );
+    case QJsonValue::Object:
+        return QString::fromUtf8(
+            QJsonDocument( value.toObject() ).toJson( QJsonDocument::Compact ) );
+    case QJsonValue::Undefined:
+        break;
+    }
+    return {};
+}
+
+// Per thread state, regular expression is not shared between threads
+class ValueCounter {
+  public:
+    explicit ValueCounter( const FieldExtractor& extractor )
+        : type_( extractor.type )
+    {
+        if ( type_ == FieldExtractor::Type::RegexCapture ) {
+            regex_.setPattern( extractor.expression );
+            regex_.setPatternOptions( extractor.isCaseSensitive
+                                          ? QRegularExpression::NoPatternOption
+                                          : QRegularExpression::CaseInsensitiveOption );
+            regex_.optimize();
+        }
+        else {
+            jsonPath_ = extractor.expression.split( '.' );
+        }
+    }
+
+    void countLine( QStringView line )
+    {
+        ++processedLines;
+
+        if ( type_ == FieldExtractor::Type::RegexCapture ) {
+            countRegexCapture( line );
+        }
+        else {
+            countJsonField( line );
+        }
+    }
+
+    ValueCounts counts;
+    uint64_t processedLines = 0;
+    uint64_t linesWithValue = 0;
+
+  private:
+    void countRegexCapture( QStringView line )
+    {
+        const auto lineString
+            = QString::fromRawData( line.data(), static_cast<int>( line.size() ) );
+        const auto match = regex_.match( lineString );
+        if ( !match.hasMatch() ) {
+            return;
+        }
+
+        const auto group = regex_.captureCount() > 0 ? 1 : 0;
+        if ( match.capturedStart( group ) < 0 ) {
+            return;
+        }
+
+        ++linesWithValue;
+        ++counts[ toKey( line.mid( match.capturedStart( group ), match.capturedLength( group ) ) ) ];
+    }
+
+    void countJsonField( QStringView line )
+    {
+        const auto objectStart = line.indexOf( QLatin1Char( '{' ) );
+        if ( objectStart < 0 ) {
+            return;
+        }
+
+        const auto document = QJsonDocument::fromJson( line.mid( objectStart ).toUtf8() );
+        if ( !document.isObject() ) {
+            return;
+        }
+
+        auto value = QJsonValue( document.object() );
+        for ( const auto& field : qAsConst( jsonPath_ ) ) {
+            value = value.toObject().value( field );
+            if ( value.isUndefined() ) {
+                return;
+            }
+        }
+
+        const auto valueString = jsonValueToString( value );
+        ++linesWithValue;
+        ++counts[ toKey( valueString ) ];
+    }
+
+  private:
+    FieldExtractor::Type type_;
+    QRegularExpression regex_;
+    QStringList jsonPath_;
+};
+
+} // namespace
+
+FieldAggregationResult aggregateField( const LogData& logData, const FieldExtractor& extractor,
+                                       const LinesSelection& range, size_t maxValues,
+                                       AtomicFlag& interruptRequested,
+                                       const std::function<void( int )>& progress )
+{
+    FieldAggregationResult result;
+
+    if ( extractor.type == FieldExtractor::Type::RegexCapture ) {
+        const QRegularExpression regex( extractor.expression );
+        if ( !regex.isValid() ) {
+            result.error = regex.errorString();
+            return result;
+        }
+    }
+    else if ( extractor.expression.isEmpty() ) {
+        result.error = QStringLiteral( "JSON field name is empty" );
+        return result;
+    }
+
+    LOG_INFO << "Aggregating " << extractor.expression << " from line " << range.startLine
+             << " to " << range.endLine;
+
+    using namespace std::chrono;
+    const auto startTime = steady_clock::now();
+
+    tbb::enumerable_thread_specific<ValueCounter> counters(
+        [ &extractor ] { return ValueCounter( extractor ); } );
+
+    const auto isCompleted = processLineChunks(
+        logData, range, interruptRequested, progress, [ &counters ]( const LinesChunk& chunk ) {
+            KLOGG_TRACE_SCOPE( "aggregate" );
+
+            auto& counter = counters.local();
+            chunk.forEachLine(
+                [ &counter ]( LineNumber, QStringView line ) { counter.countLine( line ); } );
+        } );
+
+    if ( !isCompleted ) {
+        LOG_INFO << "Aggregation interrupted";
+        result.isInterrupted = true;
+        return result;
+    }
+
+    // Merge into the biggest map to move as few values as possible
+    ValueCounts merged;
+    for ( auto& counter : counters ) {
+        result.processedLines += counter.processedLines;
+        result.linesWithValue += counter.linesWithValue;
+
+        if ( counter.counts.size() > merged.size() ) {
+            std::swap( counter.counts, merged );
+        }
+        for ( const auto& value : counter.counts ) {
+            merged[ value.first ] += value.second;
+        }
+    }
+
+    result.distinctValues = merged.size();
+
+    klogg::vector<std::pair<const std::u16string*, uint64_t>> sortedValues;
+    sortedValues.reserve( merged.size() );
+    for ( const auto& value : merged ) {
+        sortedValues.emplace_back( &value.first, value.second );
+    }
+
+    const auto valuesCount = std::min( maxValues, sortedValues.size() );
+    std::partial_sort( sortedValues.begin(),
+                       sortedValues.begin() + static_cast<std::ptrdiff_t>( valuesCount ),
+                       sortedValues.end(), []( const auto& lhs, const auto& rhs ) {
+                           return lhs.second > rhs.second
+                                  || ( lhs.second == rhs.second && *lhs.first < *rhs.first );
+                       } );
+
+    result.values.reserve( valuesCount );
+    for ( auto index = 0u; index < valuesCount; ++index ) {
+        const auto& value = *sortedValues[ index ].first;
+        result.values.push_back(
+            { QString::fromUtf16( value.data(), static_cast<int>( value.size() ) ),
+              sortedValues[ index ].second } );
+    }
+
+    LOG_INFO << "Aggregated " << result.processedLines << " lines, " << result.distinctValues
+             << " distinct values in "
+             << duration_cast<milliseconds>( steady_clock::now() - startTime ).count() << " ms";
+
+    return result;
+}
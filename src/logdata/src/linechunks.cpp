@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linechunks.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <tbb/flow_graph.h>
+
+#include "configuration.h"
+#include "logdata.h"
+#include "progress.h"
+#include "tracing.h"
+
+namespace {
+
+struct RawChunk {
+    LineNumber chunkStart;
+    LogData::RawLines lines;
+};
+
+} // namespace
+
+bool processLineChunks( const LogData& logData, const LinesSelection& selection,
+                        AtomicFlag& interruptRequested, const std::function<void( int )>& progress,
+                        const std::function<void( const LinesChunk& )>& processor )
+{
+    const auto endLine = std::min( selection.endLine, LineNumber( logData.getNbLine().get() ) );
+    if ( selection.startLine >= endLine ) {
+        return true;
+    }
+
+    const auto& config = Configuration::get();
+    const auto nbLinesInChunk
+        = static_cast<LinesCount::UnderlyingType>( config.searchReadBufferSizeLines() );
+    const auto matchingThreadsCount = static_cast<size_t>( searchThreadsCount() );
+
+    const auto* selectedLines = selection.lines ? &( *selection.lines ) : nullptr;
+
+    tbb::flow::graph chunksGraph;
+    auto chunkPrefetcher
+        = tbb::flow::limiter_node<RawChunk*>( chunksGraph, matchingThreadsCount * 3 );
+
+    auto chunkProcessor = tbb::flow::function_node<RawChunk*, tbb::flow::continue_msg>(
+        chunksGraph, matchingThreadsCount,
+        [ &processor, &interruptRequested, selectedLines ]( RawChunk* chunk ) {
+            std::unique_ptr<RawChunk> chunkOwner{ chunk };
+            if ( interruptRequested ) {
+                return tbb::flow::continue_msg{};
+            }
+
+            LinesChunk decodedChunk{ chunk->chunkStart, chunk->lines.decodeLinesToArena(),
+                                     selectedLines };
+            processor( decodedChunk );
+
+            return tbb::flow::continue_msg{};
+        } );
+
+    tbb::flow::make_edge( chunkPrefetcher, chunkProcessor );
+    tbb::flow::make_edge( chunkProcessor, chunkPrefetcher.decrementer() );
+
+    const auto totalLines = ( endLine - selection.startLine ).get();
+    int reportedProgress = -1;
+
+    auto sendChunk = [ & ]( LineNumber chunkStart, LinesCount linesInChunk ) {
+        auto* chunk = new RawChunk{ chunkStart, [ & ] {
+                                       KLOGG_TRACE_SCOPE( "read chunk" );
+                                       return logData.getLinesRaw(
+                                           chunkStart, linesInChunk,
+                                           LogData::ReadPurpose::Scan );
+                                   }() };
+
+        while ( !chunkPrefetcher.try_put( chunk ) && !interruptRequested ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        }
+        if ( interruptRequested ) {
+            delete chunk;
+            return;
+        }
+
+        const auto percentage = calculateProgress(
+            ( chunkStart + linesInChunk - selection.startLine ).get(), totalLines );
+        if ( percentage != reportedProgress && progress ) {
+            progress( percentage );
+            reportedProgress = percentage;
+        }
+    };
+
+    if ( selectedLines == nullptr ) {
+        for ( auto chunkStart = selection.startLine; chunkStart < endLine && !interruptRequested;
+              chunkStart = chunkStart + LinesCount( nbLinesInChunk ) ) {
+            sendChunk( chunkStart, LinesCount( std::min( nbLinesInChunk,
+                                                         ( endLine - chunkStart ).get() ) ) );
+        }
+    }
+    else {
+        // Read only the parts of the file that have selected lines
+        std::optional<LineNumber::UnderlyingType> chunkStart;
+        LineNumber::UnderlyingType chunkEnd = 0;
+        for ( const auto line : *selectedLines ) {
+            if ( interruptRequested || line >= endLine.get() ) {
+                break;
+            }
+            if ( line < selection.startLine.get() ) {
+                continue;
+            }
+
+            if ( chunkStart && line - *chunkStart >= nbLinesInChunk ) {
+                sendChunk( LineNumber( *chunkStart ), LinesCount( chunkEnd - *chunkStart ) );
+                chunkStart.reset();
+            }
+
+            if ( !chunkStart ) {
+                chunkStart = line;
+            }
+            chunkEnd = line + 1;
+        }
+
+        if ( chunkStart && !interruptRequested ) {
+            sendChunk( LineNumber( *chunkStart ), LinesCount( chunkEnd - *chunkStart ) );
+        }
+    }
+
+    chunksGraph.wait_for_all();
+
+    return !interruptRequested;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linehashindex.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+constexpr auto NoFirstLine = std::numeric_limits<LineNumber::UnderlyingType>::max();
+}
+
+void LineHashIndex::append( LineNumber firstLine, const klogg::vector<uint64_t>& hashes )
+{
+    const auto keptLines = std::min( lineIds_.size(), static_cast<size_t>( firstLine.get() ) );
+    for ( auto line = keptLines; line < lineIds_.size(); ++line ) {
+        auto& idFirstLine = firstLines_[ lineIds_[ line ] ];
+        if ( idFirstLine >= keptLines ) {
+            idFirstLine = NoFirstLine;
+        }
+    }
+    lineIds_.resize( keptLines );
+
+    lineIds_.reserve( lineIds_.size() + hashes.size() );
+    for ( const auto hash : hashes ) {
+        const auto newId = static_cast<uint32_t>( hashes_.size() );
+        const auto id = idsByHash_.try_emplace( hash, newId ).first->second;
+        if ( id == newId ) {
+            hashes_.push_back( hash );
+            firstLines_.push_back( lineIds_.size() );
+        }
+        else if ( firstLines_[ id ] == NoFirstLine ) {
+            firstLines_[ id ] = lineIds_.size();
+        }
+        lineIds_.push_back( id );
+    }
+}
+
+void LineHashIndex::clear()
+{
+    lineIds_ = {};
+    hashes_ = {};
+    firstLines_ = {};
+    idsByHash_ = {};
+}
+
+LinesCount LineHashIndex::size() const
+{
+    return LinesCount( lineIds_.size() );
+}
+
+size_t LineHashIndex::allocatedSize() const
+{
+    return lineIds_.capacity() * sizeof( uint32_t ) + hashes_.capacity() * sizeof( uint64_t )
+           + firstLines_.capacity() * sizeof( LineNumber::UnderlyingType )
+           + ( idsByHash_.mask() + 1 ) * ( sizeof( std::pair<uint64_t, uint32_t> ) + 1 );
+}
+
+uint64_t LineHashIndex::hashOfLine( LineNumber line ) const
+{
+    return hashes_[ lineIds_[ line.get() ] ];
+}
+
+SearchResultArray LineHashIndex::filterLines( DuplicateLinesFilter filter, LineNumber boundary,
+                                              const std::optional<SearchResultArray>& lines ) const
+{
+    SearchResultArray result;
+
+    const auto nbLines = static_cast<LineNumber::UnderlyingType>( lineIds_.size() );
+
+    klogg::vector<bool> seenIds;
+    if ( filter == DuplicateLinesFilter::FirstOccurrence && lines ) {
+        seenIds.resize( hashes_.size() );
+    }
+
+    std::optional<uint32_t> previousId;
+    auto filterLine = [ & ]( LineNumber::UnderlyingType line ) {
+        const auto id = lineIds_[ line ];
+        switch ( filter ) {
+        case DuplicateLinesFilter::CollapseRepeated:
+            if ( previousId != id ) {
+                result.add( line );
+            }
+            previousId = id;
+            break;
+        case DuplicateLinesFilter::FirstOccurrence:
+            if ( !lines ) {
+                // Without a set of lines first occurrence is known for every id
+                if ( firstLines_[ id ] == line ) {
+                    result.add( line );
+                }
+            }
+            else if ( !seenIds[ id ] ) {
+                seenIds[ id ] = true;
+                result.add( line );
+            }
+            break;
+        case DuplicateLinesFilter::NewSinceLine:
+            if ( line >= boundary.get() && firstLines_[ id ] >= boundary.get() ) {
+                result.add( line );
+            }
+            break;
+        }
+    };
+
+    if ( lines ) {
+        for ( const auto line : *lines ) {
+            if ( line >= nbLines ) {
+                break;
+            }
+            filterLine( line );
+        }
+    }
+    else {
+        const auto firstLine = filter == DuplicateLinesFilter::NewSinceLine
+                                   ? std::min( boundary.get(), nbLines )
+                                   : LineNumber::UnderlyingType{ 0 };
+        for ( auto line = firstLine; line < nbLines; ++line ) {
+            filterLine( line );
+        }
+    }
+
+    result.runOptimize();
+    return result;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linetypes.h"
+
+#include <cstring>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define KLOGG_UNTABIFY_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef KLOGG_UNTABIFY_SSE2
+unsigned countTrailingZeros( unsigned mask )
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward( &index, mask );
+    return static_cast<unsigned>( index );
+#else
+    return static_cast<unsigned>( __builtin_ctz( mask ) );
+#endif
+}
+#endif
+
+// Returns position of the first tab or NUL starting from position,
+// or size if there are none.
+size_t findTabOrNull( const char16_t* data, size_t size, size_t position )
+{
+#ifdef KLOGG_UNTABIFY_SSE2
+    const auto tabs = _mm_set1_epi16( '\t' );
+    const auto nulls = _mm_setzero_si128();
+
+    constexpr size_t charsPerBlock = sizeof( __m128i ) / sizeof( char16_t );
+    for ( ; position + charsPerBlock <= size; position += charsPerBlock ) {
+        const auto block
+            = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + position ) );
+        const auto matches
+            = _mm_or_si128( _mm_cmpeq_epi16( block, tabs ), _mm_cmpeq_epi16( block, nulls ) );
+        const auto mask = static_cast<unsigned>( _mm_movemask_epi8( matches ) );
+        if ( mask != 0 ) {
+            return position + countTrailingZeros( mask ) / sizeof( char16_t );
+        }
+    }
+#endif
+
+    for ( ; position < size; ++position ) {
+        if ( data[ position ] == u'\t' || data[ position ] == u'\0' ) {
+            return position;
+        }
+    }
+
+    return size;
+}
+
+size_t tabWidth( size_t column )
+{
+    return TabStop - ( column % TabStop );
+}
+
+} // namespace
+
+namespace {
+
+QString expandTabsAndNulls( const char16_t* input, size_t size, size_t firstSpecial,
+                            LineColumn initialPosition )
+{
+    const auto initialColumn = static_cast<size_t>( initialPosition.get() );
+
+    // Compute the expanded size first to fill the result without reallocations
+    size_t expandedSize = 0;
+    size_t chunkStart = 0;
+    for ( auto special = firstSpecial; special < size;
+          special = findTabOrNull( input, size, special + 1 ) ) {
+        expandedSize += special - chunkStart;
+        expandedSize += input[ special ] == u'\t' ? tabWidth( initialColumn + expandedSize ) : 1;
+        chunkStart = special + 1;
+    }
+    expandedSize += size - chunkStart;
+
+    QString expandedLine( type_safe::narrow_cast<int>( expandedSize ), Qt::Uninitialized );
+    auto* output = reinterpret_cast<char16_t*>( expandedLine.data() );
+
+    size_t outputPosition = 0;
+    chunkStart = 0;
+    for ( auto special = firstSpecial; special < size;
+          special = findTabOrNull( input, size, special + 1 ) ) {
+        const auto chunkLength = special - chunkStart;
+        std::memcpy( output + outputPosition, input + chunkStart,
+                     chunkLength * sizeof( char16_t ) );
+        outputPosition += chunkLength;
+
+        const auto spaces
+            = input[ special ] == u'\t' ? tabWidth( initialColumn + outputPosition ) : 1;
+        std::fill_n( output + outputPosition, spaces, u' ' );
+        outputPosition += spaces;
+
+        chunkStart = special + 1;
+    }
+    std::memcpy( output + outputPosition, input + chunkStart,
+                 ( size - chunkStart ) * sizeof( char16_t ) );
+
+    return expandedLine;
+}
+
+} // namespace
+
+QString untabify( QString&& line, LineColumn initialPosition )
+{
+    const auto* input = reinterpret_cast<const char16_t*>( line.constData() );
+    const auto size = static_cast<size_t>( line.size() );
+    const auto firstSpecial = findTabOrNull( input, size, 0 );
+
+    if ( firstSpecial == size ) {
+        return std::move( line );
+    }
+
+    return expandTabsAndNulls( input, size, firstSpecial, initialPosition );
+}
+
+QString untabify( QStringView line, LineColumn initialPosition )
+{
+    const auto* input = reinterpret_cast<const char16_t*>( line.data() );
+    const auto size = static_cast<size_t>( line.size() );
+    const auto firstSpecial = findTabOrNull( input, size, 0 );
+
+    if ( firstSpecial == size ) {
+        return QString::fromRawData( line.data(), type_safe::narrow_cast<int>( line.size() ) );
+    }
+
+    return expandTabsAndNulls( input, size, firstSpecial, initialPosition );
+}
+
+LineLength getUntabifiedLength( std::string_view utf8Line )
+{
+    const auto* begin = utf8Line.data();
+    const auto size = utf8Line.size();
+    if ( size == 0 ) {
+        return LineLength( 0 );
+    }
+
+    size_t totalSpaces = 0;
+    auto* tab = static_cast<const char*>( std::memchr( begin, '\t', size ) );
+    while ( tab != nullptr ) {
+        const auto tabPosition = static_cast<size_t>( tab - begin );
+        totalSpaces += TabStop - ( ( tabPosition + totalSpaces ) % TabStop ) - 1;
+
+        tab = static_cast<const char*>(
+            std::memchr( tab + 1, '\t', size - tabPosition - 1 ) );
+    }
+
+    return LineLength( type_safe::narrow_cast<LineLength::UnderlyingType>(
+        static_cast<int64_t>( size + totalSpaces ) ) );
+}
@@ -47,24 +47,112 @@
 #include <utility>
 #include <vector>
 
+#include <QFile>
 #include <QFileInfo>
 
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <unistd.h>
+#if defined( __GLIBC__ ) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+#define KLOGG_HAS_COPY_FILE_RANGE
+#endif
+#endif
+
 #include <simdutf.h>
+#include <tbb/enumerable_thread_specific.h>
 
+#include "blockreader.h"
 #include "configuration.h"
 #include "containers.h"
 #include "linetypes.h"
 #include "log.h"
 #include "logfiltereddata.h"
+#include "linechunks.h"
+#include "pagecache.h"
+#include "performancecounters.h"
+#include "runnable_lambda.h"
+#include "tracing.h"
 
 #include "logdata.h"
 
+namespace {
+
+// Page cache read-ahead around lines read for the view
+constexpr int64_t VisibleReadAheadSize = 1024 * 1024;
+
+// Copies bytes from the source file at offset to the current position of the output.
+bool copyFileRange( QFile& source, qint64 offset, qint64 length, QFileDevice& output )
+{
+#ifdef KLOGG_HAS_COPY_FILE_RANGE
+    // Let the kernel copy data without bringing it to user space
+    if ( output.flush() && source.handle() >= 0 && output.handle() >= 0 ) {
+        auto sourceOffset = static_cast<loff_t>( offset );
+        bool hasCopied = false;
+        while ( length > 0 ) {
+            const auto copied = ::copy_file_range( source.handle(), &sourceOffset, output.handle(),
+                                                   nullptr, static_cast<size_t>( length ), 0 );
+            if ( copied > 0 ) {
+                length -= copied;
+                hasCopied = true;
+            }
+            else if ( copied < 0 && errno == EINTR ) {
+                continue;
+            }
+            else {
+                // Not supported for these files, copy the rest through buffers
+                break;
+            }
+        }
+        offset = static_cast<qint64>( sourceOffset );
+
+        if ( hasCopied ) {
+            // Keep QFileDevice position in sync with the descriptor
+            output.seek( output.size() );
+        }
+
+        if ( length == 0 ) {
+            return true;
+        }
+    }
+#endif
+
+    if ( !source.seek( offset ) ) {
+        return false;
+    }
+
+    constexpr qint64 CopyBufferSize = 1024 * 1024;
+    QByteArray buffer( static_cast<int>( std::min( length, CopyBufferSize ) ), Qt::Uninitialized );
+    while ( length > 0 ) {
+        const auto bytesRead
+            = source.read( buffer.data(), std::min( length, static_cast<qint64>( buffer.size() ) ) );
+        if ( bytesRead <= 0 ) {
+            return false;
+        }
+
+        if ( output.write( buffer.constData(), bytesRead ) != bytesRead ) {
+            return false;
+        }
+
+        length -= bytesRead;
+    }
+
+    return true;
+}
+
+} // namespace
+
 LogData::LogData()
     : AbstractLogData()
     , indexing_data_( std::make_shared<IndexingData>() )
     , operationQueue_( [ this ] { attached_file_->attachReader(); } )
     , codec_( QTextCodec::codecForName( "ISO-8859-1" ) )
+    , decodeBuffersMemory_( MemoryGovernor::instance().registerConsumer(
+          "Decode buffers", MemoryShedPriority::DecodeBuffers ) )
+    , tokenIndexMemory_( MemoryGovernor::instance().registerConsumer(
+          "Token index", MemoryShedPriority::LineIndex ) )
 {
+    tokenIndexPool_.setMaxThreadCount( 1 );
+
     // Initialise the file watcher
     connect( &FileWatcher::getFileWatcher(), &FileWatcher::fileChanged, this,
              &LogData::fileChangedOnDisk, Qt::QueuedConnection );
@@ -97,6 +185,7 @@ LogData::~LogData()
 {
     LOG_DEBUG << "Destroying log data";
     operationQueue_.shutdown();
+    resetTokenIndex();
 }
 
 void LogData::setPrefilter( const QString& prefilterPattern )
@@ -136,6 +225,246 @@ QDateTime LogData::getLastModifiedDate() const
     return lastModifiedDate_;
 }
 
+std::optional<SearchResultArray>
+LogData::filterDuplicateLines( DuplicateLinesFilter filter, LineNumber boundary,
+                               const std::optional<SearchResultArray>& lines ) const
+{
+    return IndexingData::ConstAccessor{ indexing_data_.get() }.filterDuplicateLines(
+        filter, boundary, lines );
+}
+
+std::optional<SearchResultArray> LogData::linesOfLogLevels( LogLevels levels ) const
+{
+    IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+    if ( !scopedAccessor.hasLogLevels() ) {
+        return {};
+    }
+
+    return scopedAccessor.getLogLevels().linesOfLevels( levels );
+}
+
+std::optional<klogg::vector<uint64_t>>
+LogData::countLogLevelLines( LogLevel level, const klogg::vector<LineNumber>& boundaries ) const
+{
+    IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+    if ( !scopedAccessor.hasLogLevels() ) {
+        return {};
+    }
+
+    const auto& lines = scopedAccessor.getLogLevels().linesOfLevel( level );
+    // Number of lines before the boundary
+    const auto rankBefore = [ &lines ]( LineNumber line ) -> uint64_t {
+        return line.get() > 0 ? lines.rank( line.get() - 1 ) : 0;
+    };
+
+    klogg::vector<uint64_t> counts;
+    if ( boundaries.empty() ) {
+        return counts;
+    }
+
+    counts.reserve( boundaries.size() - 1 );
+    auto previousRank = rankBefore( boundaries.front() );
+    for ( auto boundary = boundaries.begin() + 1; boundary != boundaries.end(); ++boundary ) {
+        const auto rank = rankBefore( *boundary );
+        counts.push_back( rank - previousRank );
+        previousRank = rank;
+    }
+
+    return counts;
+}
+
+bool LogData::hasRecords() const
+{
+    return IndexingData::ConstAccessor{ indexing_data_.get() }.hasRecords();
+}
+
+std::optional<SearchResultArray>
+LogData::expandToRecords( const SearchResultArray& lines ) const
+{
+    IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+    if ( !scopedAccessor.hasRecords() ) {
+        return {};
+    }
+
+    return scopedAccessor.getRecords().expandToRecords( lines );
+}
+
+std::optional<SearchResultArray>
+LogData::wholeRecordsOf( const SearchResultArray& lines ) const
+{
+    IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+    if ( !scopedAccessor.hasRecords() ) {
+        return {};
+    }
+
+    return scopedAccessor.getRecords().wholeRecordsOf( lines );
+}
+
+std::optional<SearchResultArray> LogData::findTokenLines( const QString& token,
+                                                          AtomicFlag& interruptRequested ) const
+{
+    SearchResultArray candidateLines;
+    QString pattern;
+    {
+        SharedLock lock( tokenIndexMutex_ );
+        if ( tokenIndexPattern_.isEmpty() || tokenIndexedSize_ != getFileSize()
+             || tokenIndex_.indexedLines() != getNbLine() ) {
+            return {};
+        }
+
+        if ( !TokenExtractor( tokenIndexPattern_ ).isToken( token ) ) {
+            return {};
+        }
+
+        pattern = tokenIndexPattern_;
+        candidateLines = tokenIndex_.find( TokenExtractor::hashToken( token ) );
+    }
+
+    if ( candidateLines.isEmpty() ) {
+        return candidateLines;
+    }
+
+    // Index keeps only token hashes, so lines are checked to have the token.
+    // Only the parts of the file with candidate lines are read, in chunks
+    const auto firstLine = LineNumber( candidateLines.minimum() );
+    const auto endLine = LineNumber( candidateLines.maximum() + 1 );
+
+    tbb::enumerable_thread_specific<TokenExtractor> extractors( pattern );
+    tbb::enumerable_thread_specific<SearchResultArray> threadLines;
+
+    const auto isCompleted = processLineChunks(
+        *this, { firstLine, endLine, std::move( candidateLines ) }, interruptRequested,
+        []( int ) {},
+        [ &extractors, &threadLines, &token ]( const LinesChunk& chunk ) {
+            KLOGG_TRACE_SCOPE( "check token lines" );
+
+            const auto& extractor = extractors.local();
+            auto& lines = threadLines.local();
+            chunk.forEachLine( [ &extractor, &lines, &token ]( LineNumber line, QStringView text ) {
+                if ( extractor.hasToken( text, token ) ) {
+                    lines.add( line.get() );
+                }
+            } );
+        } );
+
+    if ( !isCompleted ) {
+        return {};
+    }
+
+    SearchResultArray lines;
+    for ( const auto& linesOfThread : threadLines ) {
+        lines |= linesOfThread;
+    }
+
+    return lines;
+}
+
+void LogData::updateTokenIndex()
+{
+    const auto pattern = Configuration::get().tokenIndexPattern();
+    if ( pattern != tokenIndexPattern_ ) {
+        resetTokenIndex();
+
+        UniqueLock lock( tokenIndexMutex_ );
+        tokenIndexPattern_ = pattern;
+    }
+
+    if ( pattern.isEmpty() ) {
+        return;
+    }
+
+    if ( !TokenExtractor( pattern ).isValid() ) {
+        LOG_WARNING << "Invalid token index pattern " << pattern;
+        return;
+    }
+
+    UniqueLock lock( tokenIndexMutex_ );
+    // Running build picks up new lines itself
+    if ( isTokenIndexBuilding_ ) {
+        return;
+    }
+
+    isTokenIndexBuilding_ = true;
+    tokenIndexPool_.start( createRunnable( [ this, pattern ] { buildTokenIndex( pattern ); } ) );
+}
+
+void LogData::resetTokenIndex()
+{
+    tokenIndexInterrupt_.set();
+    tokenIndexPool_.waitForDone();
+    tokenIndexInterrupt_.clear();
+
+    UniqueLock lock( tokenIndexMutex_ );
+    tokenIndex_.clear();
+    tokenIndexedSize_ = 0;
+    tokenIndexMemory_.setUsage( tokenIndex_.allocatedSize() );
+}
+
+void LogData::buildTokenIndex( const QString& pattern )
+{
+    tbb::enumerable_thread_specific<TokenExtractor> extractors(
+        [ &pattern ] { return TokenExtractor( pattern ); } );
+    tbb::enumerable_thread_specific<klogg::vector<TokenPosting>> threadPostings;
+
+    using namespace std::chrono;
+
+    while ( true ) {
+        LineNumber firstLine;
+        qint64 fileSize = 0;
+        {
+            UniqueLock lock( tokenIndexMutex_ );
+            fileSize = getFileSize();
+            if ( tokenIndexInterrupt_ || fileSize == tokenIndexedSize_ ) {
+                isTokenIndexBuilding_ = false;
+                return;
+            }
+
+            // The last line is indexed again as it could have had no line feed
+            const auto indexedLines = tokenIndex_.indexedLines();
+            firstLine = indexedLines.get() > 0 ? LineNumber( indexedLines.get() - 1 ) : 0_lnum;
+        }
+
+        const auto nbLines = getNbLine();
+        const auto startTime = steady_clock::now();
+
+        const auto isCompleted = processLineChunks(
+            *this, { firstLine, LineNumber( nbLines.get() ), {} }, tokenIndexInterrupt_,
+            []( int ) {},
+            [ &extractors, &threadPostings ]( const LinesChunk& chunk ) {
+                KLOGG_TRACE_SCOPE( "index tokens" );
+
+                const auto& extractor = extractors.local();
+                auto& postings = threadPostings.local();
+                chunk.forEachLine( [ &extractor, &postings ]( LineNumber line, QStringView text ) {
+                    extractor.extract( line, text, postings );
+                } );
+            } );
+
+        klogg::vector<TokenPosting> postings;
+        for ( auto& threadPosting : threadPostings ) {
+            if ( isCompleted ) {
+                postings.insert( postings.end(), threadPosting.begin(), threadPosting.end() );
+            }
+            threadPosting.clear();
+        }
+
+        UniqueLock lock( tokenIndexMutex_ );
+        if ( !isCompleted ) {
+            isTokenIndexBuilding_ = false;
+            return;
+        }
+
+        LOG_INFO << "Indexed " << postings.size() << " tokens in lines " << firstLine << " to "
+                 << nbLines << " in "
+                 << duration_cast<milliseconds>( steady_clock::now() - startTime ).count()
+                 << " ms";
+
+        tokenIndex_.append( firstLine, std::move( postings ), nbLines );
+        tokenIndexedSize_ = fileSize;
+        tokenIndexMemory_.setUsage( tokenIndex_.allocatedSize() );
+    }
+}
+
 // Return an initialised LogFilteredData. The search is not started.
 std::unique_ptr<LogFilteredData> LogData::getNewFilteredData() const
 {
@@ -145,6 +474,7 @@ std::unique_ptr<LogFilteredData> LogData::getNewFilteredData() const
 void LogData::reload( QTextCodec* forcedEncoding )
 {
     operationQueue_.interrupt();
+    resetTokenIndex();
 
     // Re-open the file, useful in case the file has been moved
     attached_file_->reOpenFile();
@@ -193,6 +523,10 @@ void LogData::fileChangedOnDisk( const QString& filename )
         attached_file_->reOpenFile();
     }
 
+    if ( !fileChangeNoticedTime_ ) {
+        fileChangeNoticedTime_ = std::chrono::steady_clock::now();
+    }
+
     operationQueue_.enqueueOperation<CheckDataChangesOperation>();
 }
 
@@ -212,7 +546,17 @@ void LogData::indexingFinished( LoadingStatus status )
         QFileInfo fileInfo( indexingFileName_ );
         if ( fileInfo.exists() )
             lastModifiedDate_ = fileInfo.lastModified();
+
+        updateTokenIndex();
+    }
+
+    if ( fileChangeNoticedTime_ && fileChangedOnDisk_ != MonitoredFileStatus::Unchanged ) {
+        using namespace std::chrono;
+        PerformanceCounters::instance().setFollowLag( static_cast<uint64_t>(
+            duration_cast<milliseconds>( steady_clock::now() - *fileChangeNoticedTime_ )
+                .count() ) );
     }
+    fileChangeNoticedTime_.reset();
 
     fileChangedOnDisk_ = MonitoredFileStatus::Unchanged;
 
@@ -232,6 +576,7 @@ void LogData::checkFileChangesFinished( MonitoredFileStatus status )
         switch ( status ) {
         case MonitoredFileStatus::Truncated:
             fileChangedOnDisk_ = MonitoredFileStatus::Truncated;
+            resetTokenIndex();
             operationQueue_.enqueueOperation<FullReindexOperation>();
             break;
         case MonitoredFileStatus::DataAdded:
@@ -240,10 +585,12 @@ void LogData::checkFileChangesFinished( MonitoredFileStatus status )
             break;
         case MonitoredFileStatus::Unchanged:
             fileChangedOnDisk_ = MonitoredFileStatus::Unchanged;
+            fileChangeNoticedTime_.reset();
             break;
         }
     }
     else {
+        resetTokenIndex();
         operationQueue_.enqueueOperation<FullReindexOperation>();
     }
 
@@ -277,6 +624,12 @@ LineLength LogData::doGetLineLength( LineNumber line ) const
     return LineLength{ doGetExpandedLineString( line ).size() };
 }
 
+bool LogData::doIsLineContinued( LineNumber line ) const
+{
+    return IndexingData::ConstAccessor{ indexing_data_.get() }.getSplitLines().contains(
+        line.get() );
+}
+
 void LogData::doSetDisplayEncoding( const char* encoding )
 {
     LOG_DEBUG << "AbstractLogData::setDisplayEncoding: " << encoding;
@@ -341,59 +694,247 @@ klogg::vector<QString> LogData::doGetExpandedLines( LineNumber first_line, Lines
     } );
 }
 
+DecodedLines LogData::doGetLinesView( LineNumber first_line, LinesCount number ) const
+{
+    LOG_DEBUG << "firstLine:" << first_line << " nb:" << number;
+
+    if ( number.get() == 0 ) {
+        return {};
+    }
+
+    DecodedLines decodedLines;
+    try {
+        const auto rawLines = getLinesRaw( first_line, number, ReadPurpose::View );
+        decodedLines = rawLines.decodeLinesToArena();
+        decodedLines.chopCarriageReturns();
+    } catch ( const std::bad_alloc& e ) {
+        LOG_ERROR << "not enough memory " << e.what();
+        decodedLines.appendLine( u"KLOGG WARNING: not enough memory" );
+    }
+
+    while ( decodedLines.size() < number.get() ) {
+        decodedLines.appendLine( u"KLOGG WARNING: failed to read some lines before this one" );
+    }
+
+    return decodedLines;
+}
+
+bool LogData::doCanExportRawLines() const
+{
+    // Prefilter changes lines content, it has to be applied to decoded text
+    return prefilterPattern_.isEmpty();
+}
+
+bool LogData::doExportRawLines( LineNumber first_line, LinesCount number, QFileDevice& output,
+                                const std::function<bool( uint64_t, uint64_t )>& progress ) const
+{
+    return exportRawLineRanges( { { first_line, number } }, output, progress );
+}
+
+bool LogData::exportRawLineRanges(
+    const LineRanges& ranges, QFileDevice& output,
+    const std::function<bool( uint64_t, uint64_t )>& progress ) const
+{
+    QFile source( indexingFileName_ );
+    if ( !source.open( QIODevice::ReadOnly ) ) {
+        LOG_ERROR << "Failed to open " << indexingFileName_ << " for export";
+        return false;
+    }
+
+    // Bytes of another file there (e.g. after rotation) would not match the index
+    if ( FileId::getFileId( indexingFileName_ ) != attached_file_->getFileId() ) {
+        LOG_ERROR << "File " << indexingFileName_ << " was replaced, export canceled";
+        return false;
+    }
+
+    const auto fileSize = source.size();
+
+    klogg::vector<std::pair<qint64, qint64>> byteRanges;
+    byteRanges.reserve( ranges.size() );
+    {
+        IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+        const auto nbLines = scopedAccessor.getNbLines();
+
+        for ( const auto& [ firstLine, linesCount ] : ranges ) {
+            if ( linesCount.get() == 0 ) {
+                continue;
+            }
+
+            if ( ( firstLine + linesCount ).get() > nbLines.get() ) {
+                LOG_WARNING << "Lines out of bound asked for export";
+                return false;
+            }
+
+            // Lines cut while indexing are exported whole
+            auto rangeBegin = firstLine;
+            auto rangeLast = firstLine + linesCount - 1_lcount;
+            const auto& splitLines = scopedAccessor.getSplitLines();
+            if ( !splitLines.isEmpty() ) {
+                while ( rangeBegin > 0_lnum && splitLines.contains( rangeBegin.get() - 1 ) ) {
+                    rangeBegin = rangeBegin - 1_lcount;
+                }
+                while ( splitLines.contains( rangeLast.get() ) ) {
+                    rangeLast = rangeLast + 1_lcount;
+                }
+            }
+
+            const auto begin
+                = ( rangeBegin == 0_lnum )
+                      ? 0
+                      : scopedAccessor.getEndOfLineOffset( rangeBegin - 1_lcount ).get();
+            const auto end = scopedAccessor.getEndOfLineOffset( rangeLast ).get();
+
+            if ( !byteRanges.empty() && byteRanges.back().second >= begin ) {
+                byteRanges.back().second = std::max( byteRanges.back().second, end );
+            }
+            else {
+                byteRanges.emplace_back( begin, end );
+            }
+        }
+    }
+
+    // Last line of a file without final line feed ends past the end of file
+    bool addFinalLineFeed = false;
+    if ( !byteRanges.empty() && byteRanges.back().second > fileSize ) {
+        byteRanges.back().second = fileSize;
+        addFinalLineFeed = true;
+    }
+
+    const auto totalBytes = std::accumulate(
+        byteRanges.cbegin(), byteRanges.cend(), uint64_t{ 0 }, []( uint64_t acc, const auto& r ) {
+            return acc + static_cast<uint64_t>( r.second - r.first );
+        } );
+
+    LOG_INFO << "Exporting " << byteRanges.size() << " byte ranges, " << totalBytes << " bytes";
+
+    // Copy in slices to report progress for large ranges
+    constexpr qint64 SliceSize = 64 * 1024 * 1024;
+    uint64_t copiedBytes = 0;
+    for ( const auto& [ begin, end ] : byteRanges ) {
+        for ( auto sliceBegin = begin; sliceBegin < end; sliceBegin += SliceSize ) {
+            const auto sliceLength = std::min( SliceSize, end - sliceBegin );
+            if ( !copyFileRange( source, sliceBegin, sliceLength, output ) ) {
+                LOG_ERROR << "Failed to copy " << sliceLength << " bytes at " << sliceBegin;
+                return false;
+            }
+
+            copiedBytes += static_cast<uint64_t>( sliceLength );
+            if ( !progress( copiedBytes, totalBytes ) ) {
+                return false;
+            }
+        }
+    }
+
+    if ( addFinalLineFeed ) {
+        std::unique_ptr<QTextEncoder> encoder{ codec_.codec()->makeEncoder(
+            QTextCodec::IgnoreHeader ) };
+        const auto lineFeed = encoder->fromUnicode( QString( QChar::LineFeed ) );
+        if ( output.write( lineFeed ) != lineFeed.size() ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 LineNumber LogData::doGetLineNumber( LineNumber index ) const
 {
     return index;
 }
 
-LogData::RawLines LogData::getLinesRaw( LineNumber firstLine, LinesCount number ) const
+std::optional<OffsetInFile> LogData::prepareRawLines( RawLines& rawLines, LineNumber firstLine,
+                                                     LinesCount number ) const
 {
-    RawLines rawLines;
     rawLines.startLine = firstLine;
 
-    try {
-        IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
-        if ( (firstLine + number).get() > scopedAccessor.getNbLines().get() ) {
-            LOG_WARNING << "Lines out of bound asked for";
-            return {}; /* exception? */
+    IndexingData::ConstAccessor scopedAccessor{ indexing_data_.get() };
+    if ( (firstLine + number).get() > scopedAccessor.getNbLines().get() ) {
+        LOG_WARNING << "Lines out of bound asked for";
+        return {}; /* exception? */
+    }
+
+    rawLines.endOfLines.reserve( number.get() );
+    rawLines.prefilterPattern
+        = !prefilterPattern_.isEmpty()
+              ? QRegularExpression( prefilterPattern_, QRegularExpression::CaseInsensitiveOption )
+              : QRegularExpression{};
+
+    const auto firstByte = ( firstLine == 0_lnum )
+                               ? 0
+                               : scopedAccessor.getEndOfLineOffset( firstLine - 1_lcount ).get();
+
+    klogg::vector<OffsetInFile> endOfLines
+        = scopedAccessor.getEndOfLineOffsets( firstLine, number );
+
+    const auto lastByte = endOfLines.back().get();
+
+    std::transform(
+        endOfLines.begin(), endOfLines.end(), std::back_inserter( rawLines.endOfLines ),
+        [ firstByte ]( const OffsetInFile& offset ) { return offset.get() - firstByte; } );
+
+    const auto& splitLines = scopedAccessor.getSplitLines();
+    if ( !splitLines.isEmpty() ) {
+        for ( auto index = 0u; index < number.get(); ++index ) {
+            if ( splitLines.contains( firstLine.get() + index ) ) {
+                rawLines.splitLines.push_back( index );
+            }
         }
+    }
 
-        rawLines.endOfLines.reserve( number.get() );
-        rawLines.prefilterPattern
-            = !prefilterPattern_.isEmpty()
-                  ? QRegularExpression( prefilterPattern_,
-                                        QRegularExpression::CaseInsensitiveOption )
-                  : QRegularExpression{};
+    const auto bytesToRead = lastByte - firstByte;
+    LOG_DEBUG << "will try to read:" << bytesToRead << " bytes";
 
-        ScopedFileHolder<FileHolder> fileHolder( attached_file_.get() );
+    // Give caches a chance to be dropped before the allocation fails
+    if ( !MemoryGovernor::instance().requestAllocation( static_cast<uint64_t>( bytesToRead ) ) ) {
+        LOG_WARNING_LIMITED( 1 ) << "Memory budget exceeded, reading " << bytesToRead
+                                 << " bytes anyway";
+    }
 
-        const auto firstByte
-            = ( firstLine == 0_lnum )
-                  ? 0
-                  : scopedAccessor.getEndOfLineOffset( firstLine - 1_lcount ).get();
+    rawLines.memoryReservation_
+        = decodeBuffersMemory_.reserve( static_cast<uint64_t>( bytesToRead ) );
+    rawLines.buffer.resize( static_cast<std::size_t>( bytesToRead ) );
+    rawLines.textDecoder = codec_.makeDecoder();
 
-        klogg::vector<OffsetInFile> endOfLines
-            = scopedAccessor.getEndOfLineOffsets( firstLine, number );
+    return OffsetInFile( firstByte );
+}
 
-        const auto lastByte = endOfLines.back().get();
+LogData::RawLines LogData::getLinesRaw( LineNumber firstLine, LinesCount number,
+                                       ReadPurpose purpose ) const
+{
+    RawLines rawLines;
 
-        std::transform(
-            endOfLines.begin(), endOfLines.end(), std::back_inserter( rawLines.endOfLines ),
-            [ firstByte ]( const OffsetInFile& offset ) { return offset.get() - firstByte; } );
+    try {
+        const auto firstByte = prepareRawLines( rawLines, firstLine, number );
+        if ( !firstByte ) {
+            return {};
+        }
 
-        const auto bytesToRead = lastByte - firstByte;
-        LOG_DEBUG << "will try to read:" << bytesToRead << " bytes";
-        rawLines.buffer.resize( static_cast<std::size_t>( bytesToRead ) );
+        ScopedFileHolder<FileHolder> fileHolder( attached_file_.get() );
 
-        fileHolder.getFile()->seek( firstByte );
+        const auto bytesToRead = static_cast<int64_t>( rawLines.buffer.size() );
+        fileHolder.getFile()->seek( firstByte->get() );
         const auto bytesRead = fileHolder.getFile()->read( rawLines.buffer.data(), bytesToRead );
 
         if ( bytesRead != bytesToRead ) {
             LOG_DEBUG << "failed to read " << bytesToRead << " bytes, got " << bytesRead;
         }
 
+        const auto fileDescriptor = fileHolder.getFile()->handle();
+        if ( purpose == ReadPurpose::View ) {
+            // Lines around are likely to be shown next when scrolling
+            const auto readAhead = std::min( bytesToRead, VisibleReadAheadSize );
+            advisePageCache( fileDescriptor, firstByte->get() + bytesToRead, readAhead,
+                             PageCacheAdvice::WillNeed );
+            advisePageCache( fileDescriptor, std::max( int64_t{ 0 }, firstByte->get() - readAhead ),
+                             std::min( readAhead, firstByte->get() ), PageCacheAdvice::WillNeed );
+        }
+        else if ( purpose == ReadPurpose::Scan && bytesRead > 0
+                  && shouldDropScannedPages( getFileSize() ) ) {
+            advisePageCache( fileDescriptor, firstByte->get(), bytesRead,
+                             PageCacheAdvice::DontNeed );
+        }
+
         LOG_DEBUG << "done reading lines:" << rawLines.buffer.size();
-        rawLines.textDecoder = codec_.makeDecoder();
         return rawLines;
 
     } catch ( const std::bad_alloc& ) {
@@ -404,6 +945,46 @@ LogData::RawLines LogData::getLinesRaw( LineNumber firstLine, LinesCount number
     }
 }
 
+std::unique_ptr<BlockReader> LogData::createBlockReader( int queueDepth ) const
+{
+    BlockReader::CacheHints cacheHints;
+    cacheHints.dropBehind = shouldDropScannedPages( getFileSize() );
+
+    // Workers open the file by name, reads of another file there
+    // (e.g. after rotation) fail instead of giving wrong lines
+    BlockReader::FileAccess fileAccess;
+    fileAccess.expectedId = attached_file_->getFileId();
+    fileAccess.keepClosed = keepFileClosed_;
+
+    return std::make_unique<BlockReader>( indexingFileName_, queueDepth, cacheHints, fileAccess );
+}
+
+LogData::PendingRawLines LogData::getLinesRawAsync( LineNumber firstLine, LinesCount number,
+                                                    BlockReader& reader ) const
+{
+    PendingRawLines pendingLines;
+
+    try {
+        const auto firstByte = prepareRawLines( pendingLines.lines, firstLine, number );
+        if ( !firstByte ) {
+            pendingLines.lines = {};
+            return pendingLines;
+        }
+
+        // Moving the lines keeps the buffer the reader fills
+        pendingLines.bytesRead
+            = reader.read( firstByte->get(), pendingLines.lines.buffer.data(),
+                           klogg::ssize( pendingLines.lines.buffer ) );
+        return pendingLines;
+
+    } catch ( const std::bad_alloc& ) {
+        LOG_ERROR << "not enough memory";
+        pendingLines.lines.endOfLines.clear();
+        pendingLines.lines.buffer.clear();
+        return pendingLines;
+    }
+}
+
 klogg::vector<QString> LogData::getLinesFromFile( LineNumber firstLine, LinesCount number,
                                                   QString ( *processLine )( QString&& ) ) const
 {
@@ -454,6 +1035,8 @@ void LogData::doDetachReader() const
 
 klogg::vector<QString> LogData::RawLines::decodeLines() const
 {
+    KLOGG_TRACE_SCOPE( "decode lines" );
+
     if ( this->endOfLines.empty() ) {
         return klogg::vector<QString>();
     }
@@ -466,9 +1049,10 @@ klogg::vector<QString> LogData::RawLines::decodeLines() const
         size_t currentLineIndex = 0;
         const auto lineFeedWidth = textDecoder.encodingParams.lineFeedWidth;
         for ( const auto& lineEnd : this->endOfLines ) {
-            const auto length = lineEnd - lineStart - lineFeedWidth;
-            LOG_DEBUG << "line " << this->startLine.get() + currentLineIndex << ", length "
-                      << length;
+            const auto length
+                = lineEnd - lineStart - ( isSplitLine( currentLineIndex ) ? 0 : lineFeedWidth );
+            LOG_DEBUG_LIMITED( 10 ) << "line " << this->startLine.get() + currentLineIndex
+                                    << ", length " << length;
 
             constexpr auto maxlength = std::numeric_limits<int>::max() / 2;
             if ( length >= maxlength ) {
@@ -492,6 +1076,7 @@ klogg::vector<QString> LogData::RawLines::decodeLines() const
             decodedLines.push_back( std::move( decodedLine ) );
 
             lineStart = lineEnd;
+            ++currentLineIndex;
         }
     } catch ( const std::bad_alloc& ) {
         LOG_ERROR << "not enough memory";
@@ -506,6 +1091,58 @@ klogg::vector<QString> LogData::RawLines::decodeLines() const
     return decodedLines;
 }
 
+DecodedLines LogData::RawLines::decodeLinesToArena() const
+{
+    KLOGG_TRACE_SCOPE( "decode lines" );
+
+    DecodedLines decodedLines;
+    if ( this->endOfLines.empty() || textDecoder.decoder == nullptr ) {
+        return decodedLines;
+    }
+
+    if ( !prefilterPattern.pattern().isEmpty() || !splitLines.empty() ) {
+        // Prefilter can remove line feeds and split lines have none,
+        // so lines have to be decoded one by one
+        const auto lines = decodeLines();
+        decodedLines.reserve( lines.size() );
+        for ( const auto& line : lines ) {
+            decodedLines.appendLine( line );
+        }
+        return decodedLines;
+    }
+
+    try {
+        decodedLines.reserve( endOfLines.size() );
+        decodedLines.setArena(
+            textDecoder.decoder->toUnicode( buffer.data(), klogg::isize( buffer ) ) );
+
+        const auto wholeString = QStringView{ decodedLines.arena() };
+        qsizetype lineStart = 0;
+        while ( decodedLines.size() < endOfLines.size() ) {
+            const auto lineEnd = wholeString.indexOf( QChar::LineFeed, lineStart );
+            if ( lineEnd < 0 ) {
+                if ( lineStart < wholeString.size() ) {
+                    decodedLines.addLine( lineStart, wholeString.size() - lineStart );
+                }
+                break;
+            }
+
+            decodedLines.addLine( lineStart, lineEnd - lineStart );
+            lineStart = lineEnd + 1;
+        }
+    } catch ( const std::bad_alloc& ) {
+        LOG_ERROR << "not enough memory";
+        decodedLines = DecodedLines{};
+        decodedLines.appendLine( u"KLOGG WARNING: not enough memory" );
+    }
+
+    while ( decodedLines.size() < this->endOfLines.size() ) {
+        decodedLines.appendLine( u"KLOGG WARNING: failed to decode some lines before this one" );
+    }
+
+    return decodedLines;
+}
+
 klogg::vector<std::string_view> LogData::RawLines::buildUtf8View() const
 {
     klogg::vector<std::string_view> lines;
@@ -513,6 +1150,10 @@ klogg::vector<std::string_view> LogData::RawLines::buildUtf8View() const
         return lines;
     }
 
+    if ( !splitLines.empty() ) {
+        return buildSplitUtf8View();
+    }
+
     try {
         // const auto optimizeForNotLatinEncodings
         //     = Configuration::get().optimizeForNotLatinEncodings();
@@ -539,6 +1180,9 @@ klogg::vector<std::string_view> LogData::RawLines::buildUtf8View() const
                 utf16Data.remove( prefilterPattern );
             }
 
+            MemoryGovernor::instance().requestAllocation( buffer.size() * 2 );
+            memoryReservation_.grow( buffer.size() * 2 );
+
             size_t resultSize = 0;
             // if ( !optimizeForNotLatinEncodings ) {
             //     utf8Data_ = utf16Data.toUtf8();
@@ -578,3 +1222,57 @@ klogg::vector<std::string_view> LogData::RawLines::buildUtf8View() const
 
     return lines;
 }
+
+bool LogData::RawLines::isSplitLine( size_t index ) const
+{
+    return std::binary_search( splitLines.cbegin(), splitLines.cend(), index );
+}
+
+// Split lines have no line feed to look for, so lines are cut by their offsets
+klogg::vector<std::string_view> LogData::RawLines::buildSplitUtf8View() const
+{
+    klogg::vector<std::string_view> lines;
+    lines.reserve( endOfLines.size() );
+
+    try {
+        if ( prefilterPattern.pattern().isEmpty() && textDecoder.encodingParams.isUtf8Compatible ) {
+            const auto lineFeedWidth = textDecoder.encodingParams.lineFeedWidth;
+            qint64 lineStart = 0;
+            for ( auto index = 0u; index < endOfLines.size(); ++index ) {
+                const auto lineEnd
+                    = std::min( endOfLines[ index ], static_cast<qint64>( buffer.size() ) );
+                const auto length = std::max(
+                    qint64{ 0 }, lineEnd - lineStart - ( isSplitLine( index ) ? 0 : lineFeedWidth ) );
+                lines.emplace_back( buffer.data() + lineStart, static_cast<size_t>( length ) );
+                lineStart = lineEnd;
+            }
+            return lines;
+        }
+
+        klogg::vector<size_t> lineEnds;
+        lineEnds.reserve( endOfLines.size() );
+        utf8Data_.clear();
+        for ( const auto& line : decodeLines() ) {
+            const auto utf8Line = line.toUtf8();
+            utf8Data_.insert( utf8Data_.end(), utf8Line.cbegin(), utf8Line.cend() );
+            lineEnds.push_back( utf8Data_.size() );
+        }
+
+        MemoryGovernor::instance().requestAllocation( utf8Data_.size() );
+        memoryReservation_.grow( utf8Data_.size() );
+
+        size_t lineStart = 0;
+        for ( const auto lineEnd : lineEnds ) {
+            lines.emplace_back( utf8Data_.data() + lineStart, lineEnd - lineStart );
+            lineStart = lineEnd;
+        }
+    } catch ( const std::exception& e ) {
+        LOG_ERROR << "failed to transform lines to utf8 " << e.what();
+    }
+
+    while ( lines.size() < endOfLines.size() ) {
+        lines.emplace_back();
+    }
+
+    return lines;
+}
@@ -37,8 +37,10 @@
  */
 
 #include <chrono>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <future>
 #include <qglobal.h>
 #include <qthread.h>
 #include <string_view>
@@ -50,6 +52,8 @@
 #include <QSemaphore>
 #include <tuple>
 
+#include "binarycontent.h"
+#include "blockreader.h"
 #include "configuration.h"
 #include "containers.h"
 #include "dispatch_to.h"
@@ -60,9 +64,13 @@
 #include "log.h"
 #include "logdata.h"
 #include "memory_info.h"
+#include "pagecache.h"
+#include "performancecounters.h"
 #include "progress.h"
 #include "readablesize.h"
+#include "regularexpression.h"
 #include "runnable_lambda.h"
+#include "tracing.h"
 
 #include "logdataworker.h"
 
@@ -125,14 +133,43 @@ QTextCodec* IndexingData::getForcedEncoding() const
 }
 
 void IndexingData::addAll( const klogg::vector<char>& block, LineLength length,
-                           const FastLinePositionArray& newLinePosition, QTextCodec* encoding )
+                           const FastLinePositionArray& newLinePosition, QTextCodec* encoding,
+                           const klogg::vector<uint64_t>& lineHashes,
+                           const klogg::vector<LogLevel>& lineLevels,
+                           const klogg::vector<bool>& lineRecordStarts,
+                           const klogg::vector<size_t>& splitLines )
 
 {
+    KLOGG_TRACE_SCOPE( "addAll" );
+
     maxLength_ = std::max( maxLength_, length );
     std::visit(
         [ &newLinePosition ]( auto& linePosition ) { linePosition.append_list( newLinePosition ); },
         linePosition_ );
 
+    if ( !lineHashes.empty() ) {
+        // Appending may have replaced the fake final line
+        const auto firstNewLine = getNbLines() - LinesCount( lineHashes.size() );
+        lineHashes_.append( LineNumber( firstNewLine.get() ), lineHashes );
+    }
+
+    if ( !lineLevels.empty() ) {
+        const auto firstNewLine = getNbLines() - LinesCount( lineLevels.size() );
+        logLevels_.append( LineNumber( firstNewLine.get() ), lineLevels );
+    }
+
+    if ( !lineRecordStarts.empty() ) {
+        const auto firstNewLine = getNbLines() - LinesCount( lineRecordStarts.size() );
+        records_.append( LineNumber( firstNewLine.get() ), lineRecordStarts );
+    }
+
+    if ( !splitLines.empty() ) {
+        const auto firstNewLine = getNbLines() - newLinePosition.size();
+        for ( const auto line : splitLines ) {
+            splitLines_.add( firstNewLine.get() + line );
+        }
+    }
+
     if ( !block.empty() ) {
         hash_.size += klogg::ssize( block );
 
@@ -143,6 +180,34 @@ void IndexingData::addAll( const klogg::vector<char>& block, LineLength length,
     }
 
     encodingGuess_ = encoding;
+
+    memoryRegistration_.setUsage( allocatedSize() );
+}
+
+bool IndexingData::hasLineHashes() const
+{
+    return lineHashes_.size() == getNbLines();
+}
+
+std::optional<SearchResultArray>
+IndexingData::filterDuplicateLines( DuplicateLinesFilter filter, LineNumber boundary,
+                                    const std::optional<SearchResultArray>& lines ) const
+{
+    if ( !hasLineHashes() ) {
+        return {};
+    }
+
+    return lineHashes_.filterLines( filter, boundary, lines );
+}
+
+bool IndexingData::hasLogLevels() const
+{
+    return logLevels_.size() == getNbLines();
+}
+
+bool IndexingData::hasRecords() const
+{
+    return records_.size() == getNbLines();
 }
 
 int IndexingData::getProgress() const
@@ -160,6 +225,10 @@ void IndexingData::clear()
     const auto& config = Configuration::get();
 
     maxLength_ = 0_length;
+    lineHashes_.clear();
+    logLevels_.clear();
+    records_.clear();
+    splitLines_ = {};
     hash_ = {};
     hashBuilder_.reset();
     if ( config.useCompressedIndex() ) {
@@ -173,12 +242,16 @@ void IndexingData::clear()
 
     progress_ = {};
     useFastModificationDetection_ = config.fastModificationDetection();
+
+    memoryRegistration_.setUsage( allocatedSize() );
 }
 
 size_t IndexingData::allocatedSize() const
 {
     return std::visit( []( const auto& linePosition ) { return linePosition.allocatedSize(); },
-                       linePosition_ );
+                       linePosition_ )
+           + lineHashes_.allocatedSize() + logLevels_.allocatedSize() + records_.allocatedSize()
+           + splitLines_.getSizeInBytes( false );
 }
 
 LogDataWorker::LogDataWorker( const std::shared_ptr<IndexingData>& indexing_data )
@@ -316,78 +389,84 @@ void LogDataWorker::onCheckFileFinished( const MonitoredFileStatus result )
 //
 namespace parse_data_block {
 
-std::string_view::size_type findNextMultiByteDelimeter( EncodingParameters encodingParams,
-                                                        std::string_view data, char delimeter )
-{
-    auto nextDelimeter = data.find( delimeter );
+// Line feed of the encoding known at compile time: width of a code unit and
+// index of the '\n' byte in it. The parse loop is instantiated for every
+// line feed, so delimiter search and offsets are inlined into it.
+template <int LineFeedWidth, int LineFeedIndex> struct LineFeed {
+    static_assert( LineFeedIndex == 0 || LineFeedIndex == LineFeedWidth - 1,
+                   "Line feed byte is either the first or the last one of a code unit" );
 
-    if ( nextDelimeter == std::string_view::npos ) {
-        return nextDelimeter;
-    }
+    static constexpr int Width = LineFeedWidth;
+    static constexpr int BeforeCrOffset = LineFeedIndex;
 
-    const auto isNotDelimeter = [ &encodingParams, data ]( std::string_view::size_type checkPos ) {
-        const auto lineFeedWidth
-            = static_cast<std::string_view::size_type>( encodingParams.lineFeedWidth );
+    static std::string_view::size_type findNextDelimeter( std::string_view data, char delimeter )
+    {
+        auto nextDelimeter = data.find( delimeter );
 
-        const auto isCheckForward = encodingParams.lineFeedIndex == 0;
+        if constexpr ( Width > 1 ) {
+            constexpr auto lineFeedWidth = static_cast<std::string_view::size_type>( Width );
+            constexpr auto isCheckForward = LineFeedIndex == 0;
 
-        if ( isCheckForward && checkPos + lineFeedWidth > data.size() ) {
-            return true;
-        }
-        else if ( !isCheckForward && checkPos < lineFeedWidth - 1 ) {
-            return true;
-        }
+            const auto isNotDelimeter = [ data ]( std::string_view::size_type checkPos ) {
+                if constexpr ( isCheckForward ) {
+                    if ( checkPos + lineFeedWidth > data.size() ) {
+                        return true;
+                    }
+                }
+                else {
+                    if ( checkPos < lineFeedWidth - 1 ) {
+                        return true;
+                    }
+                }
+
+                for ( auto i = 1u; i < lineFeedWidth; ++i ) {
+                    const auto nextByte
+                        = isCheckForward ? data[ checkPos + i ] : data[ checkPos - i ];
+                    if ( nextByte != '\0' ) {
+                        return true;
+                    }
+                }
+
+                return false;
+            };
 
-        for ( auto i = 1u; i < lineFeedWidth; ++i ) {
-            const auto nextByte = isCheckForward ? data[ checkPos + i ] : data[ checkPos - i ];
-            if ( nextByte != '\0' ) {
-                return true;
+            while ( nextDelimeter != std::string_view::npos && isNotDelimeter( nextDelimeter ) ) {
+                nextDelimeter = data.find( delimeter, nextDelimeter + 1 );
             }
         }
 
-        return false;
-    };
-
-    while ( nextDelimeter != std::string_view::npos && isNotDelimeter( nextDelimeter ) ) {
-        nextDelimeter = data.find( delimeter, nextDelimeter + 1 );
+        return nextDelimeter;
     }
 
-    return nextDelimeter;
-}
-
-std::string_view::size_type findNextSingleByteDelimeter( EncodingParameters, std::string_view data,
-                                                         char delimeter )
-{
-    return data.find( delimeter );
-}
-
-int charOffsetWithinBlock( const char* blockStart, const char* pointer,
-                           const EncodingParameters& encodingParams )
-{
-    return type_safe::narrow_cast<int>( std::distance( blockStart, pointer ) )
-           - encodingParams.getBeforeCrOffset();
-}
+    static int charOffsetWithinBlock( const char* blockStart, const char* pointer )
+    {
+        return type_safe::narrow_cast<int>( std::distance( blockStart, pointer ) )
+               - BeforeCrOffset;
+    }
+};
 
-using FindDelimeter = std::string_view::size_type ( * )( EncodingParameters encodingParams,
-                                                         std::string_view, char );
+using SingleByteLineFeed = LineFeed<1, 0>;
+using Utf16LeLineFeed = LineFeed<2, 0>;
+using Utf16BeLineFeed = LineFeed<2, 1>;
+using Utf32LeLineFeed = LineFeed<4, 0>;
+using Utf32BeLineFeed = LineFeed<4, 3>;
 
+template <typename LineFeedType>
 LineLength::UnderlyingType
 expandTabsInLine( const klogg::vector<char>& block, std::string_view blockToExpand,
-                  int posWithinBlock, EncodingParameters encodingParams,
-                  FindDelimeter findNextDelimeter,
-                  LineLength::UnderlyingType initialAdditionalSpaces = 0 )
+                  int posWithinBlock, LineLength::UnderlyingType initialAdditionalSpaces = 0 )
 {
     auto additionalSpaces = initialAdditionalSpaces;
     while ( !blockToExpand.empty() ) {
-        const auto nextTab = findNextDelimeter( encodingParams, blockToExpand, '\t' );
+        const auto nextTab = LineFeedType::findNextDelimeter( blockToExpand, '\t' );
         if ( nextTab == std::string_view::npos ) {
             break;
         }
 
         const auto tabPosWithinBlock
-            = charOffsetWithinBlock( block.data(), blockToExpand.data() + nextTab, encodingParams );
+            = LineFeedType::charOffsetWithinBlock( block.data(), blockToExpand.data() + nextTab );
 
-        LOG_DEBUG << "Tab at " << tabPosWithinBlock;
+        LOG_DEBUG_LIMITED( 10 ) << "Tab at " << tabPosWithinBlock;
 
         const auto currentExpandedSize = tabPosWithinBlock - posWithinBlock + additionalSpaces;
 
@@ -402,43 +481,170 @@ expandTabsInLine( const klogg::vector<char>& block, std::string_view blockToExpa
     return additionalSpaces;
 }
 
+template <typename LineFeedType>
 std::tuple<bool, int, LineLength::UnderlyingType>
-findNextLineFeed( const klogg::vector<char>& block, int posWithinBlock, const IndexingState& state,
-                  FindDelimeter findNextDelimeter )
+findNextLineFeed( const klogg::vector<char>& block, int posWithinBlock, const IndexingState& state )
 {
     const auto searchStart = block.data() + posWithinBlock;
     const auto searchLineSize = static_cast<size_t>( klogg::ssize( block ) - posWithinBlock );
 
     const auto blockView = std::string_view( searchStart, searchLineSize );
-    const auto nextLineFeed = findNextDelimeter( state.encodingParams, blockView, '\n' );
+    const auto nextLineFeed = LineFeedType::findNextDelimeter( blockView, '\n' );
 
     const auto isEndOfBlock = nextLineFeed == std::string_view::npos;
     const auto nextLineSize = !isEndOfBlock ? nextLineFeed : searchLineSize;
 
-    posWithinBlock
-        = charOffsetWithinBlock( block.data(), searchStart + nextLineSize, state.encodingParams );
+    posWithinBlock = LineFeedType::charOffsetWithinBlock( block.data(), searchStart + nextLineSize );
 
-    const auto additionalSpaces
-        = expandTabsInLine( block, blockView.substr( 0, nextLineSize ), posWithinBlock,
-                            state.encodingParams, findNextDelimeter, state.additional_spaces );
+    const auto additionalSpaces = expandTabsInLine<LineFeedType>(
+        block, blockView.substr( 0, nextLineSize ), posWithinBlock, state.additional_spaces );
 
     return std::make_tuple( isEndOfBlock, posWithinBlock, additionalSpaces );
 }
-} // namespace parse_data_block
 
-FastLinePositionArray IndexOperation::parseDataBlock( OffsetInFile::UnderlyingType blockBeginning,
-                                                      const klogg::vector<char>& block,
-                                                      IndexingState& state ) const
+// Keeps the first bytes of the line that continues in the next block
+void appendLinePrefix( IndexingState& state, const char* data, size_t size )
 {
-    using namespace parse_data_block;
+    if ( state.linePrefix.size() < state.linePrefixSize ) {
+        state.linePrefix.append(
+            data, std::min( size, state.linePrefixSize - state.linePrefix.size() ) );
+    }
+}
+
+// Level and record start are decided by the line prefix only,
+// so lines split between blocks are classified the same way
+void classifyLine( IndexingState& state, bool classifyLevels, bool matchRecordStarts,
+                   const char* data, size_t size )
+{
+    size = std::min( size, state.linePrefixSize );
 
-    FindDelimeter findNextDelimeter;
-    if ( state.encodingParams.lineFeedWidth == 1 ) {
-        findNextDelimeter = findNextSingleByteDelimeter;
+    if ( classifyLevels ) {
+        state.lineLevels.push_back( state.levelClassifier.classify( data, size ) );
     }
-    else {
-        findNextDelimeter = findNextMultiByteDelimeter;
+
+    if ( matchRecordStarts ) {
+        state.lineRecordStarts.push_back(
+            state.recordStartMatcher->hasMatch( std::string_view( data, size ) ) );
     }
+}
+
+// Adds the part of the line in the block to the line hash and prefix,
+// a line ended in the block gets its hash, level and record start flag
+void indexLineContent( IndexingState& state, const char* data, size_t size, bool isLineEnded,
+                       bool classifyLevels, bool matchRecordStarts )
+{
+    if ( state.hashLines ) {
+        state.lineDigest.addData( data, size );
+        if ( isLineEnded ) {
+            state.lineHashes.push_back( state.lineDigest.digest() );
+            state.lineDigest.reset();
+        }
+    }
+
+    if ( classifyLevels || matchRecordStarts ) {
+        if ( isLineEnded && state.linePrefix.empty() ) {
+            // Whole line is in the block
+            classifyLine( state, classifyLevels, matchRecordStarts, data, size );
+        }
+        else {
+            appendLinePrefix( state, data, size );
+            if ( isLineEnded ) {
+                classifyLine( state, classifyLevels, matchRecordStarts, state.linePrefix.data(),
+                              state.linePrefix.size() );
+                state.linePrefix.clear();
+            }
+        }
+    }
+}
+
+// Moves the cut of a long line back to keep a character in one piece,
+// at most one character is skipped
+OffsetInFile::UnderlyingType findLineCut( const klogg::vector<char>& block,
+                                          OffsetInFile::UnderlyingType cut,
+                                          OffsetInFile::UnderlyingType minCut,
+                                          const EncodingParameters& encodingParams )
+{
+    const auto isCutAllowed = [ &block, &encodingParams ]( OffsetInFile::UnderlyingType position ) {
+        if ( encodingParams.lineFeedWidth == 1 ) {
+            // UTF-8 continuation byte
+            return ( static_cast<unsigned char>( block[ static_cast<size_t>( position ) ] ) & 0xC0 )
+                   != 0x80;
+        }
+        if ( encodingParams.lineFeedWidth == 2 && position + 1 < klogg::ssize( block ) ) {
+            // Low surrogate of a UTF-16 pair
+            const auto highByte = static_cast<unsigned char>(
+                block[ static_cast<size_t>( position + ( encodingParams.isUtf16LE ? 1 : 0 ) ) ] );
+            return ( highByte & 0xFC ) != 0xDC;
+        }
+        return true;
+    };
+
+    const auto step = encodingParams.lineFeedWidth;
+    for ( auto i = 0; i < 3 && cut - step > minCut && !isCutAllowed( cut ); ++i ) {
+        cut -= step;
+    }
+
+    return cut;
+}
+
+// Cuts the line ending at lineEnd into lines of split size without line feed,
+// the rest of the line shorter than split size is left to the caller
+template <typename LineFeedType>
+void splitLongLine( const klogg::vector<char>& block, OffsetInFile::UnderlyingType blockBeginning,
+                    OffsetInFile::UnderlyingType lineEnd, IndexingState& state,
+                    OffsetInFile::UnderlyingType splitLineSize,
+                    FastLinePositionArray& linePositions, bool classifyLevels,
+                    bool matchRecordStarts )
+{
+    while ( lineEnd - state.pos > splitLineSize ) {
+        // Rest of the line was shorter than split size at the end of previous
+        // block, so the cut is always in this block
+        const auto segmentStart = std::max( state.pos, blockBeginning ) - blockBeginning;
+        const auto cut = findLineCut(
+            block, std::max( state.pos + splitLineSize - blockBeginning, segmentStart ),
+            segmentStart, state.encodingParams );
+
+        const auto segment = std::string_view( block.data() + segmentStart,
+                                               static_cast<size_t>( cut - segmentStart ) );
+        indexLineContent( state, segment.data(), segment.size(), true, classifyLevels,
+                          matchRecordStarts );
+
+        const auto additionalSpaces = expandTabsInLine<LineFeedType>(
+            block, segment, type_safe::narrow_cast<int>( segmentStart ) );
+        const auto length = type_safe::narrow_cast<LineLength::UnderlyingType>(
+                                blockBeginning + cut - state.pos )
+                                / LineFeedType::Width
+                            + additionalSpaces;
+        state.max_length = std::max( state.max_length, length );
+
+        state.splitLines.push_back( linePositions.size().get() );
+        state.end = blockBeginning + cut;
+        state.pos = state.end;
+        linePositions.append( OffsetInFile( state.pos ) );
+    }
+
+    const auto rest = std::string_view( block.data() + ( state.pos - blockBeginning ),
+                                        static_cast<size_t>( lineEnd - state.pos ) );
+    state.additional_spaces = expandTabsInLine<LineFeedType>(
+        block, rest, type_safe::narrow_cast<int>( state.pos - blockBeginning ) );
+}
+
+template <typename LineFeedType>
+FastLinePositionArray parseBlock( OffsetInFile::UnderlyingType blockBeginning,
+                                  const klogg::vector<char>& block, IndexingState& state )
+{
+    // Level keywords and record starts are searched in bytes,
+    // so only ASCII compatible encodings
+    const auto classifyLevels = state.classifyLevels && LineFeedType::Width == 1;
+    const auto matchRecordStarts
+        = state.recordStartMatcher != nullptr && LineFeedType::Width == 1;
+
+    // Binary data is cut into short lines even if long lines are not split
+    const auto splitLineSize
+        = state.isBinaryBlock ? ( state.splitLineSize > 0
+                                      ? std::min( state.splitLineSize, BinaryLineSize )
+                                      : BinaryLineSize )
+                              : state.splitLineSize;
 
     bool isEndOfBlock = false;
     FastLinePositionArray linePositions;
@@ -457,21 +663,34 @@ FastLinePositionArray IndexOperation::parseDataBlock( OffsetInFile::UnderlyingTy
 
         if ( !isEndOfBlock ) {
             std::tie( isEndOfBlock, posWithinBlock, state.additional_spaces )
-                = findNextLineFeed( block, posWithinBlock, state, findNextDelimeter );
+                = findNextLineFeed<LineFeedType>( block, posWithinBlock, state );
         }
 
         const auto currentDataEnd = posWithinBlock + blockBeginning;
 
+        if ( splitLineSize > 0 && currentDataEnd - state.pos > splitLineSize ) {
+            splitLongLine<LineFeedType>( block, blockBeginning, currentDataEnd, state,
+                                         splitLineSize, linePositions, classifyLevels,
+                                         matchRecordStarts );
+        }
+
+        const auto lineStart = state.pos > blockBeginning ? state.pos - blockBeginning : 0;
+        const auto* lineData = block.data() + lineStart;
+        const auto lineDataSize = static_cast<size_t>( posWithinBlock - lineStart );
+
+        indexLineContent( state, lineData, lineDataSize, !isEndOfBlock, classifyLevels,
+                          matchRecordStarts );
+
         const auto length
             = type_safe::narrow_cast<LineLength::UnderlyingType>( currentDataEnd - state.pos )
-                  / state.encodingParams.lineFeedWidth
+                  / LineFeedType::Width
               + state.additional_spaces;
 
         state.max_length = std::max( state.max_length, length );
 
         if ( !isEndOfBlock ) {
             state.end = currentDataEnd;
-            state.pos = state.end + state.encodingParams.lineFeedWidth;
+            state.pos = state.end + LineFeedType::Width;
             state.additional_spaces = 0;
             linePositions.append( OffsetInFile( state.pos ) );
         }
@@ -480,12 +699,52 @@ FastLinePositionArray IndexOperation::parseDataBlock( OffsetInFile::UnderlyingTy
     return linePositions;
 }
 
+} // namespace parse_data_block
+
+FastLinePositionArray IndexOperation::parseDataBlock( OffsetInFile::UnderlyingType blockBeginning,
+                                                      const klogg::vector<char>& block,
+                                                      IndexingState& state ) const
+{
+    KLOGG_TRACE_SCOPE( "parse block" );
+
+    using namespace parse_data_block;
+
+    const auto isLineFeedFirst = state.encodingParams.lineFeedIndex == 0;
+
+    switch ( state.encodingParams.lineFeedWidth ) {
+    case 1:
+        return parseBlock<SingleByteLineFeed>( blockBeginning, block, state );
+    case 2:
+        return isLineFeedFirst ? parseBlock<Utf16LeLineFeed>( blockBeginning, block, state )
+                               : parseBlock<Utf16BeLineFeed>( blockBeginning, block, state );
+    case 4:
+        return isLineFeedFirst ? parseBlock<Utf32LeLineFeed>( blockBeginning, block, state )
+                               : parseBlock<Utf32BeLineFeed>( blockBeginning, block, state );
+    default:
+        LOG_ERROR << "Unsupported line feed width " << state.encodingParams.lineFeedWidth
+                  << ", parsing as single byte";
+        return parseBlock<SingleByteLineFeed>( blockBeginning, block, state );
+    }
+}
+
 void IndexOperation::guessEncoding( const klogg::vector<char>& block,
                                     IndexingData::MutateAccessor& scopedAccessor,
                                     IndexingState& state ) const
 {
     if ( !state.encodingGuess ) {
         state.encodingGuess = EncodingDetector::getInstance().detectEncoding( block );
+
+        // Detector guesses anything for binary data without BOM, single byte
+        // encoding at least keeps every byte visible
+        const auto blockArray = QByteArray::fromRawData( block.data(), klogg::isize( block ) );
+        if ( state.detectBinary && QTextCodec::codecForUtfText( blockArray, nullptr ) == nullptr
+             && isBinaryBlock( { block.data(), block.size() },
+                               EncodingParameters( state.encodingGuess ) ) ) {
+            LOG_INFO << "Binary data, ignoring encoding guess "
+                     << state.encodingGuess->name().toStdString();
+            state.encodingGuess = QTextCodec::codecForName( "ISO-8859-1" );
+        }
+
         LOG_INFO << "Encoding guess " << state.encodingGuess->name().toStdString();
     }
 
@@ -508,30 +767,69 @@ void IndexOperation::guessEncoding( const klogg::vector<char>& block,
 }
 
 std::chrono::microseconds IndexOperation::readFileInBlocks( QFile& file,
-                                                            BlockPrefetcher& blockPrefetcher )
+                                                            BlockPrefetcher& blockPrefetcher,
+                                                            BlockBufferPool& bufferPool )
 {
     using namespace std::chrono;
     using clock = high_resolution_clock;
 
-    LOG_INFO << "Starting IO thread";
+    const auto queueDepth = std::max( 1, Configuration::get().ioQueueDepth() );
+
+    BlockReader::CacheHints cacheHints;
+    cacheHints.dropBehind = shouldDropScannedPages( file.size() );
+    cacheHints.directIo = Configuration::get().directIndexReads();
+
+    BlockReader reader( fileName_, queueDepth, cacheHints );
+
+    LOG_INFO << "Starting IO thread, queue depth " << queueDepth << ", drop behind "
+             << cacheHints.dropBehind << ", direct IO " << cacheHints.directIo;
+
+    using PendingBlock = std::pair<BlockData, std::future<int64_t>>;
+    std::deque<PendingBlock> pendingBlocks;
+
+    auto nextBlockOffset = file.pos();
+    auto readEnd = nextBlockOffset;
 
     int sentBlocksCount = 0;
 
     microseconds ioDuration{};
-    while ( !file.atEnd() ) {
+    while ( !interruptRequest_ ) {
+        // Reads of next blocks are in flight while the parser is busy
+        while ( klogg::ssize( pendingBlocks ) < queueDepth && nextBlockOffset < file.size() ) {
+            BlockBuffer* buffer = nullptr;
+            if ( !bufferPool.try_pop( buffer ) ) {
+                buffer = new BlockBuffer;
+            }
+            buffer->resize( IndexingBlockSize );
 
-        if ( interruptRequest_ ) {
+            auto readResult = reader.read( nextBlockOffset, buffer->data(), klogg::ssize( *buffer ) );
+            pendingBlocks.emplace_back( BlockData{ nextBlockOffset, buffer },
+                                        std::move( readResult ) );
+            nextBlockOffset += IndexingBlockSize;
+        }
+
+        if ( pendingBlocks.empty() ) {
             break;
         }
 
-        BlockData blockData{ file.pos(), new klogg::vector<char>( IndexingBlockSize ) };
+        auto blockData = pendingBlocks.front().first;
+        auto readResult = std::move( pendingBlocks.front().second );
+        pendingBlocks.pop_front();
 
         clock::time_point ioT1 = clock::now();
-        const auto readBytes
-            = file.read( blockData.second->data(), klogg::ssize( *blockData.second ) );
+        const auto readBytes = [ & ] {
+            KLOGG_TRACE_SCOPE( "read block" );
+            return readResult.get();
+        }();
+        clock::time_point ioT2 = clock::now();
 
-        if ( readBytes < 0 ) {
-            LOG_ERROR << "Reading past the end of file";
+        ioDuration += duration_cast<microseconds>( ioT2 - ioT1 );
+
+        if ( readBytes <= 0 ) {
+            if ( readBytes < 0 ) {
+                LOG_ERROR << "Failed to read block at " << blockData.first;
+            }
+            bufferPool.push( blockData.second );
             break;
         }
 
@@ -539,26 +837,48 @@ std::chrono::microseconds IndexOperation::readFileInBlocks( QFile& file,
             blockData.second->resize( static_cast<size_t>( readBytes ) );
         }
 
-        clock::time_point ioT2 = clock::now();
-
-        ioDuration += duration_cast<microseconds>( ioT2 - ioT1 );
+        readEnd = blockData.first + readBytes;
 
         if ( sentBlocksCount % 10 == 0 ) {
             LOG_INFO << "Sending block " << blockData.first << " size " << blockData.second->size();
         }
 
-        while ( !blockPrefetcher.try_put( std::move( blockData ) ) && !interruptRequest_ ) {
+        auto isSent = false;
+        while ( !( isSent = blockPrefetcher.try_put( blockData ) ) && !interruptRequest_ ) {
             std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
         }
+
+        if ( !isSent ) {
+            bufferPool.push( blockData.second );
+            break;
+        }
         sentBlocksCount++;
+
+        // File was truncated while it was read, blocks after the short one are not valid
+        if ( readEnd < blockData.first + IndexingBlockSize ) {
+            break;
+        }
+    }
+
+    // Buffers can be reused only when reads into them are done
+    for ( auto& pendingBlock : pendingBlocks ) {
+        pendingBlock.second.wait();
+        bufferPool.push( pendingBlock.first.second );
     }
 
+    file.seek( readEnd );
+
     auto lastBlock = std::make_pair( -1, new klogg::vector<char>{} );
     while ( !blockPrefetcher.try_put( lastBlock ) && !interruptRequest_ ) {
         std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
     }
 
-    LOG_INFO << "IO thread done";
+    const auto readStats = reader.stats();
+    LOG_INFO << "IO thread done, read " << readableSize( readStats.bytes ) << " at "
+             << readStats.megabytesPerSecond << " MiB/s, queue depth " << readStats.queueDepth;
+    PerformanceCounters::instance().setReadStats( readStats.queueDepth,
+                                                  readStats.megabytesPerSecond );
+
     return ioDuration;
 }
 
@@ -567,7 +887,7 @@ void IndexOperation::indexNextBlock( IndexingState& state, const BlockData& bloc
     const auto& blockBeginning = blockData.first;
     const auto& block = *blockData.second;
 
-    LOG_DEBUG << "Indexing block " << blockBeginning << " start";
+    LOG_DEBUG_LIMITED( 10 ) << "Indexing block " << blockBeginning << " start";
 
     if ( blockBeginning < 0 ) {
         return;
@@ -578,6 +898,19 @@ void IndexOperation::indexNextBlock( IndexingState& state, const BlockData& bloc
     guessEncoding( block, scopedAccessor, state );
 
     if ( !block.empty() ) {
+        state.lineHashes.clear();
+        state.lineLevels.clear();
+        state.lineRecordStarts.clear();
+        state.splitLines.clear();
+
+        state.isBinaryBlock
+            = state.detectBinary
+              && isBinaryBlock( { block.data(), block.size() }, state.encodingParams );
+        if ( state.isBinaryBlock ) {
+            LOG_DEBUG_LIMITED( 10 ) << "Binary data in block " << blockBeginning;
+            ++state.binaryBlocksCount;
+        }
+
         const auto linePositions = parseDataBlock( blockBeginning, block, state );
         auto maxLength = state.max_length;
         if ( maxLength > std::numeric_limits<LineLength::UnderlyingType>::max() ) {
@@ -587,7 +920,10 @@ void IndexOperation::indexNextBlock( IndexingState& state, const BlockData& bloc
 
         scopedAccessor.addAll(
             block, LineLength( type_safe::narrow_cast<LineLength::UnderlyingType>( maxLength ) ),
-            linePositions, state.encodingGuess );
+            linePositions, state.encodingGuess, state.lineHashes, state.lineLevels,
+            state.lineRecordStarts, state.splitLines );
+
+        PerformanceCounters::instance().addIndexedBytes( block.size() );
 
         // Update the caller for progress indication
         const auto progress
@@ -595,15 +931,19 @@ void IndexOperation::indexNextBlock( IndexingState& state, const BlockData& bloc
 
         if ( progress != scopedAccessor.getProgress() ) {
             scopedAccessor.setProgress( progress );
-            LOG_DEBUG << "Indexing progress " << progress << ", indexed size " << state.pos;
+            LOG_DEBUG_LIMITED( 10 )
+                << "Indexing progress " << progress << ", indexed size " << state.pos;
             Q_EMIT indexingProgressed( progress );
+
+            // Index can't be shed, but caches can make room for it
+            MemoryGovernor::instance().requestAllocation( 0 );
         }
     }
     else {
         scopedAccessor.setEncodingGuess( state.encodingGuess );
     }
 
-    LOG_DEBUG << "Indexing block " << blockBeginning << " done";
+    LOG_DEBUG_LIMITED( 10 ) << "Indexing block " << blockBeginning << " done";
 }
 
 void IndexOperation::doIndex( OffsetInFile initialPosition )
@@ -644,6 +984,71 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
         LOG_INFO << "Initial encoding "
                  << ( state.fileTextCodec != nullptr ? state.fileTextCodec->name().toStdString()
                                                      : std::string{ "auto" } );
+
+        // Hashes, levels and records are appended only if all lines indexed before have them
+        state.hashLines = Configuration::get().indexLineHashes()
+                          && ( state.pos == 0 || scopedAccessor.hasLineHashes() );
+        state.classifyLevels = Configuration::get().indexLogLevels()
+                               && ( state.pos == 0 || scopedAccessor.hasLogLevels() );
+        QRegularExpression levelPattern( Configuration::get().logLevelPattern() );
+        if ( !levelPattern.isValid() ) {
+            LOG_WARNING << "Invalid log level pattern: " << levelPattern.errorString();
+        }
+        state.levelClassifier = LogLevelClassifier(
+            static_cast<size_t>( std::max( 1, Configuration::get().logLevelSearchDepth() ) ),
+            levelPattern );
+
+        const auto recordStartPattern = Configuration::get().recordStartPattern();
+        if ( !recordStartPattern.isEmpty()
+             && ( state.pos == 0 || scopedAccessor.hasRecords() ) ) {
+            const RegularExpression recordStart{ RegularExpressionPattern( recordStartPattern ) };
+            if ( recordStart.isValid() ) {
+                state.recordStartMatcher = recordStart.createMatcher();
+            }
+            else {
+                LOG_WARNING << "Invalid record start pattern: " << recordStart.errorString();
+            }
+        }
+
+        state.detectBinary = Configuration::get().detectBinaryContent();
+
+        if ( Configuration::get().splitLongLines() ) {
+            state.splitLineSize = std::max( 1, Configuration::get().longLineSplitSizeKb() ) * 1024;
+        }
+
+        // A few bytes more than level search depth to complete a keyword at the border
+        constexpr size_t KeywordSlack = 8;
+        if ( state.classifyLevels ) {
+            state.linePrefixSize = state.levelClassifier.searchDepth() + KeywordSlack;
+        }
+        if ( state.recordStartMatcher ) {
+            state.linePrefixSize = std::max( state.linePrefixSize, RecordIndex::StartSearchDepth );
+        }
+
+        const auto nbLines = scopedAccessor.getNbLines();
+        if ( ( state.hashLines || state.linePrefixSize > 0 ) && nbLines > 0_lcount ) {
+            const auto lastLine = LineNumber( nbLines.get() - 1 );
+            const auto lastLineEnd = scopedAccessor.getEndOfLineOffset( lastLine ).get();
+
+            // Last line had no line feed, the data appended continues it
+            if ( lastLineEnd > state.pos ) {
+                const auto lastLineStart
+                    = lastLine > 0_lnum
+                          ? scopedAccessor.getEndOfLineOffset( lastLine - 1_lcount ).get()
+                          : OffsetInFile::UnderlyingType{ 0 };
+
+                file.seek( lastLineStart );
+                const auto lineStartData = file.read( state.pos - lastLineStart );
+                if ( state.hashLines ) {
+                    state.lineDigest.addData( lineStartData );
+                }
+                if ( state.linePrefixSize > 0 ) {
+                    parse_data_block::appendLinePrefix(
+                        state, lineStartData.constData(),
+                        static_cast<size_t>( lineStartData.size() ) );
+                }
+            }
+        }
     }
 
     const auto& config = Configuration::get();
@@ -657,14 +1062,17 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
 
     const auto indexingStartTime = clock::now();
 
+    BlockBufferPool bufferPool;
+
     tbb::flow::graph indexingGraph;
     auto blockPrefetcher = tbb::flow::limiter_node<BlockData>( indexingGraph, prefetchBufferSize );
     auto blockQueue = tbb::flow::queue_node<BlockData>( indexingGraph );
 
     auto blockParser = tbb::flow::function_node<BlockData, tbb::flow::continue_msg>(
-        indexingGraph, tbb::flow::serial, [ this, &state ]( const BlockData& blockData ) {
+        indexingGraph, tbb::flow::serial,
+        [ this, &state, &bufferPool ]( const BlockData& blockData ) {
             indexNextBlock( state, blockData );
-            delete blockData.second;
+            bufferPool.push( blockData.second );
             return tbb::flow::continue_msg{};
         } );
 
@@ -673,13 +1081,23 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
     tbb::flow::make_edge( blockParser, blockPrefetcher.decrementer() );
 
     file.seek( state.pos );
-    ioDuration = readFileInBlocks( file, blockPrefetcher );
+    ioDuration = readFileInBlocks( file, blockPrefetcher, bufferPool );
     indexingGraph.wait_for_all();
 
+    BlockBuffer* freeBuffer = nullptr;
+    while ( bufferPool.try_pop( freeBuffer ) ) {
+        delete freeBuffer;
+    }
+
     IndexingData::MutateAccessor scopedAccessor{ indexing_data_.get() };
 
     LOG_DEBUG << "Indexed up to " << state.pos;
 
+    if ( state.binaryBlocksCount > 0 ) {
+        LOG_WARNING << "Binary data in " << state.binaryBlocksCount
+                    << " blocks, cut into lines of " << BinaryLineSize << " bytes";
+    }
+
     // Check if there is a non LF terminated line at the end of the file
     if ( !interruptRequest_ && state.file_size > state.pos ) {
         LOG_WARNING << "Non LF terminated file, adding a fake end of line";
@@ -688,7 +1106,21 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
         line_position.append( OffsetInFile( state.file_size + 1 ) );
         line_position.setFakeFinalLF();
 
-        scopedAccessor.addAll( {}, 0_length, line_position, state.encodingGuess );
+        klogg::vector<uint64_t> lastLineHash;
+        if ( state.hashLines ) {
+            lastLineHash.push_back( state.lineDigest.digest() );
+        }
+
+        state.lineLevels.clear();
+        state.lineRecordStarts.clear();
+        if ( state.encodingParams.lineFeedWidth == 1 ) {
+            parse_data_block::classifyLine( state, state.classifyLevels,
+                                            state.recordStartMatcher != nullptr,
+                                            state.linePrefix.data(), state.linePrefix.size() );
+        }
+
+        scopedAccessor.addAll( {}, 0_length, line_position, state.encodingGuess, lastLineHash,
+                               state.lineLevels, state.lineRecordStarts );
     }
 
     const auto endFilePos = file.pos();
@@ -726,6 +1158,10 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
                     / ( 1024 * 1024 )
              << " MiB/s";
     LOG_INFO << "Memory usage " << readableSize( usedMemory() );
+    for ( const auto& subsystem : MemoryGovernor::instance().usageBySubsystem() ) {
+        LOG_INFO << "Memory usage by " << subsystem.name << ": " << readableSize( subsystem.live )
+                 << ", peak " << readableSize( subsystem.peak );
+    }
 
     if ( interruptRequest_ ) {
         scopedAccessor.clear();
@@ -734,7 +1170,9 @@ void IndexOperation::doIndex( OffsetInFile initialPosition )
     if ( scopedAccessor.getMaxLength().get()
          == std::numeric_limits<LineLength::UnderlyingType>::max() ) {
         dispatchToMainThread( [] {
-            QMessageBox::critical( nullptr, "Klogg", "Can't index file: some lines are too long",
+            QMessageBox::critical( nullptr, "Klogg",
+                                   "Can't index file: some lines are too long. "
+                                   "Enable splitting of long lines in the options.",
                                    QMessageBox::Close );
         } );
 
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logdiff.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include <QRegularExpression>
+
+#include <robin_hood.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "filedigest.h"
+#include "linechunks.h"
+#include "log.h"
+#include "logdata.h"
+#include "tracing.h"
+
+namespace {
+
+using Hashes = klogg::vector<uint64_t>;
+
+struct LineHasher {
+    explicit LineHasher( const QString& maskPattern )
+        : mask( maskPattern )
+    {
+    }
+
+    uint64_t hash( QStringView line )
+    {
+        if ( !mask.pattern().isEmpty() ) {
+            maskedLine = line.toString();
+            maskedLine.replace( mask, QStringLiteral( "*" ) );
+            line = maskedLine;
+        }
+
+        digest.reset();
+        digest.addData( reinterpret_cast<const char*>( line.data() ),
+                        static_cast<size_t>( line.size() ) * sizeof( QChar ) );
+        return digest.digest();
+    }
+
+    QRegularExpression mask;
+    QString maskedLine;
+    FileDigest digest;
+};
+
+bool hashLines( const LogData& logData, const QString& maskPattern, Hashes& hashes,
+                AtomicFlag& interruptRequested, const std::function<void( int )>& progress )
+{
+    hashes.resize( logData.getNbLine().get() );
+
+    tbb::enumerable_thread_specific<LineHasher> hashers(
+        [ &maskPattern ] { return LineHasher( maskPattern ); } );
+
+    const LinesSelection selection{ 0_lnum, LineNumber( hashes.size() ), {} };
+
+    // Chunks cover disjoint line ranges, so threads never write to the same element
+    return processLineChunks( logData, selection, interruptRequested, progress,
+                              [ &hashers, &hashes ]( const LinesChunk& chunk ) {
+                                  KLOGG_TRACE_SCOPE( "hash lines" );
+
+                                  auto& hasher = hashers.local();
+                                  chunk.forEachLine(
+                                      [ &hasher, &hashes ]( LineNumber line, QStringView text ) {
+                                          hashes[ line.get() ] = hasher.hash( text );
+                                      } );
+                              } );
+}
+
+using HashCounts = robin_hood::unordered_flat_map<uint64_t, uint64_t>;
+
+void markRange( SearchResultArray& lines, size_t begin, size_t end )
+{
+    lines.addRange( static_cast<uint64_t>( begin ), static_cast<uint64_t>( end ) );
+}
+
+// Marks lines of the first range that have no unmatched pair in the second one
+void markUnmatched( const Hashes& first, size_t firstBegin, size_t firstEnd, const Hashes& second,
+                    size_t secondBegin, size_t secondEnd, SearchResultArray& unmatched )
+{
+    HashCounts counts;
+    for ( auto index = secondBegin; index < secondEnd; ++index ) {
+        ++counts[ second[ index ] ];
+    }
+
+    for ( auto index = firstBegin; index < firstEnd; ++index ) {
+        auto count = counts.find( first[ index ] );
+        if ( count != counts.end() && count->second > 0 ) {
+            --count->second;
+        }
+        else {
+            unmatched.add( static_cast<uint64_t>( index ) );
+        }
+    }
+}
+
+void diffByContent( const Hashes& first, const Hashes& second, LogDiffResult& result )
+{
+    const auto markAbsent = []( const Hashes& lines, const Hashes& other,
+                                SearchResultArray& absent ) {
+        robin_hood::unordered_flat_set<uint64_t> otherHashes;
+        otherHashes.reserve( other.size() );
+        otherHashes.insert( other.begin(), other.end() );
+
+        for ( auto index = 0u; index < lines.size(); ++index ) {
+            if ( otherHashes.count( lines[ index ] ) == 0 ) {
+                absent.add( static_cast<uint64_t>( index ) );
+            }
+        }
+    };
+
+    markAbsent( first, second, result.onlyInFirst );
+    markAbsent( second, first, result.onlyInSecond );
+}
+
+struct DiffRange {
+    size_t firstBegin;
+    size_t firstEnd;
+    size_t secondBegin;
+    size_t secondEnd;
+};
+
+struct Anchor {
+    size_t first;
+    size_t second;
+};
+
+// Lines present exactly once in both ranges, ordered by position in the first range
+klogg::vector<Anchor> findUniqueCommonLines( const Hashes& first, const Hashes& second,
+                                             const DiffRange& range )
+{
+    struct Occurrences {
+        uint32_t firstCount = 0;
+        uint32_t secondCount = 0;
+        size_t secondIndex = 0;
+    };
+
+    robin_hood::unordered_flat_map<uint64_t, Occurrences> occurrences;
+    occurrences.reserve( range.firstEnd - range.firstBegin );
+    for ( auto index = range.firstBegin; index < range.firstEnd; ++index ) {
+        auto& occurrence = occurrences[ first[ index ] ];
+        occurrence.firstCount = std::min( occurrence.firstCount + 1, 2u );
+    }
+
+    for ( auto index = range.secondBegin; index < range.secondEnd; ++index ) {
+        auto occurrence = occurrences.find( second[ index ] );
+        if ( occurrence != occurrences.end() ) {
+            occurrence->second.secondCount = std::min( occurrence->second.secondCount + 1, 2u );
+            occurrence->second.secondIndex = index;
+        }
+    }
+
+    klogg::vector<Anchor> anchors;
+    for ( auto index = range.firstBegin; index < range.firstEnd; ++index ) {
+        const auto& occurrence = occurrences[ first[ index ] ];
+        if ( occurrence.firstCount == 1 && occurrence.secondCount == 1 ) {
+            anchors.push_back( { index, occurrence.secondIndex } );
+        }
+    }
+
+    return anchors;
+}
+
+// Longest subsequence of anchors increasing in the second range, patience sorting
+klogg::vector<Anchor> longestIncreasingAnchors( const klogg::vector<Anchor>& anchors )
+{
+    constexpr auto NoAnchor = std::numeric_limits<size_t>::max();
+
+    klogg::vector<size_t> pileTops;
+    klogg::vector<size_t> previous( anchors.size(), NoAnchor );
+
+    for ( auto index = 0u; index < anchors.size(); ++index ) {
+        const auto pile = std::lower_bound( pileTops.begin(), pileTops.end(),
+                                            anchors[ index ].second,
+                                            [ &anchors ]( size_t top, size_t second ) {
+                                                return anchors[ top ].second < second;
+                                            } );
+
+        if ( pile != pileTops.begin() ) {
+            previous[ index ] = *( pile - 1 );
+        }
+
+        if ( pile == pileTops.end() ) {
+            pileTops.push_back( index );
+        }
+        else {
+            *pile = index;
+        }
+    }
+
+    klogg::vector<Anchor> sequence;
+    for ( auto index = pileTops.empty() ? NoAnchor : pileTops.back(); index != NoAnchor;
+          index = previous[ index ] ) {
+        sequence.push_back( anchors[ index ] );
+    }
+    std::reverse( sequence.begin(), sequence.end() );
+
+    return sequence;
+}
+
+bool diffAligned( const Hashes& first, const Hashes& second, AtomicFlag& interruptRequested,
+                  LogDiffResult& result )
+{
+    klogg::vector<DiffRange> ranges;
+    ranges.push_back( { 0, first.size(), 0, second.size() } );
+
+    while ( !ranges.empty() ) {
+        if ( interruptRequested ) {
+            return false;
+        }
+
+        auto range = ranges.back();
+        ranges.pop_back();
+
+        while ( range.firstBegin < range.firstEnd && range.secondBegin < range.secondEnd
+                && first[ range.firstBegin ] == second[ range.secondBegin ] ) {
+            ++range.firstBegin;
+            ++range.secondBegin;
+        }
+
+        while ( range.firstBegin < range.firstEnd && range.secondBegin < range.secondEnd
+                && first[ range.firstEnd - 1 ] == second[ range.secondEnd - 1 ] ) {
+            --range.firstEnd;
+            --range.secondEnd;
+        }
+
+        if ( range.firstBegin == range.firstEnd || range.secondBegin == range.secondEnd ) {
+            markRange( result.onlyInFirst, range.firstBegin, range.firstEnd );
+            markRange( result.onlyInSecond, range.secondBegin, range.secondEnd );
+            continue;
+        }
+
+        const auto anchors
+            = longestIncreasingAnchors( findUniqueCommonLines( first, second, range ) );
+
+        if ( anchors.empty() ) {
+            // Only repeated lines left, pair equal lines in order of appearance
+            markUnmatched( first, range.firstBegin, range.firstEnd, second, range.secondBegin,
+                           range.secondEnd, result.onlyInFirst );
+            markUnmatched( second, range.secondBegin, range.secondEnd, first, range.firstBegin,
+                           range.firstEnd, result.onlyInSecond );
+            continue;
+        }
+
+        auto firstBegin = range.firstBegin;
+        auto secondBegin = range.secondBegin;
+        for ( const auto& anchor : anchors ) {
+            ranges.push_back( { firstBegin, anchor.first, secondBegin, anchor.second } );
+            firstBegin = anchor.first + 1;
+            secondBegin = anchor.second + 1;
+        }
+        ranges.push_back( { firstBegin, range.firstEnd, secondBegin, range.secondEnd } );
+    }
+
+    return true;
+}
+
+} // namespace
+
+namespace logdiff {
+
+LogDiffResult diffHashes( const klogg::vector<uint64_t>& first,
+                          const klogg::vector<uint64_t>& second, LogDiffMode mode,
+                          AtomicFlag& interruptRequested )
+{
+    LogDiffResult result;
+
+    switch ( mode ) {
+    case LogDiffMode::Lines:
+        diffByContent( first, second, result );
+        break;
+    case LogDiffMode::Aligned:
+        result.isInterrupted = !diffAligned( first, second, interruptRequested, result );
+        break;
+    }
+
+    return result;
+}
+
+} // namespace logdiff
+
+LogDiffResult diffLogs( const LogData& first, const LogData& second,
+                        const LogDiffParameters& parameters, AtomicFlag& interruptRequested,
+                        const std::function<void( int )>& progress )
+{
+    LOG_INFO << "Comparing files with " << first.getNbLine() << " and " << second.getNbLine()
+             << " lines, mask " << parameters.maskPattern;
+
+    using namespace std::chrono;
+    const auto startTime = steady_clock::now();
+
+    Hashes firstHashes;
+    Hashes secondHashes;
+
+    const auto isCompleted
+        = hashLines( first, parameters.maskPattern, firstHashes, interruptRequested,
+                     [ &progress ]( int percent ) { progress( percent / 2 ); } )
+          && hashLines( second, parameters.maskPattern, secondHashes, interruptRequested,
+                        [ &progress ]( int percent ) { progress( 50 + percent / 2 ); } );
+
+    if ( !isCompleted ) {
+        LOG_INFO << "Comparing files interrupted";
+        LogDiffResult result;
+        result.isInterrupted = true;
+        return result;
+    }
+
+    const auto hashTime = steady_clock::now();
+
+    auto result
+        = logdiff::diffHashes( firstHashes, secondHashes, parameters.mode, interruptRequested );
+
+    const auto endTime = steady_clock::now();
+
+    LOG_INFO << "Found " << result.onlyInFirst.cardinality() << " and "
+             << result.onlyInSecond.cardinality() << " different lines, hashing took "
+             << duration_cast<milliseconds>( hashTime - startTime ).count()
+             << " ms, comparing took "
+             << duration_cast<milliseconds>( endTime - hashTime ).count() << " ms";
+
+    return result;
+}
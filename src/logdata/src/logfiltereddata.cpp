@@ -46,6 +46,7 @@
 #include <QString>
 #include <QTimer>
 
+#include <algorithm>
 #include <cassert>
 #include <functional>
 #include <numeric>
@@ -56,6 +57,7 @@
 #include "logfiltereddata.h"
 
 #include "configuration.h"
+#include "performancecounters.h"
 #include "readablesize.h"
 #include "synchronization.h"
 
@@ -86,6 +88,12 @@ LogFilteredData::LogFilteredData( const LogData* logData )
 
     connect( &searchProgressThrottler_, &KDToolBox::KDGenericSignalThrottler::triggered, this,
              &LogFilteredData::handleSearchProgressedThrottled );
+
+    searchResultsCacheMemory_ = MemoryGovernor::instance().registerConsumer(
+        "Search results cache", MemoryShedPriority::SearchResultsCache, this,
+        [ this ] { shedSearchResultsCache(); } );
+    searchResultsMemory_ = MemoryGovernor::instance().registerConsumer(
+        "Search results", MemoryShedPriority::SearchResults );
 }
 
 void LogFilteredData::runSearch( const RegularExpressionPattern& regExp )
@@ -110,6 +118,8 @@ void LogFilteredData::runSearch( const RegularExpressionPattern& regExp, LineNum
     bool shouldRunSearch = true;
     if ( config.useSearchResultsCache() ) {
         const auto cachedResults = searchResultsCache_.find( currentSearchKey_ );
+        PerformanceCounters::instance().addSearchCacheLookup( cachedResults
+                                                              != std::end( searchResultsCache_ ) );
         if ( cachedResults != std::end( searchResultsCache_ ) ) {
             LOG_INFO << "Got result from cache";
             shouldRunSearch = false;
@@ -117,6 +127,7 @@ void LogFilteredData::runSearch( const RegularExpressionPattern& regExp, LineNum
             maxLength_ = cachedResults->second.maxLength;
 
             marks_and_matches_ = matching_lines_ | marks_;
+            updateSearchResultsUsage();
 
             Q_EMIT searchProgressed( LinesCount( matching_lines_.cardinality() ), 100, startLine );
         }
@@ -152,15 +163,60 @@ void LogFilteredData::clearSearch( bool dropCache )
 
     currentRegExp_ = {};
     matching_lines_ = {};
+    inverseMatches_ = {};
     marks_and_matches_ = marks_;
     maxLength_ = 0_length;
     nbLinesProcessed_ = 0_lcount;
+    updateSearchResultsUsage();
 
     if ( dropCache ) {
         searchResultsCache_.clear();
+        updateSearchResultsCacheUsage();
     }
 }
 
+void LogFilteredData::setMatchingLines( SearchResultArray lines )
+{
+    clearSearch();
+
+    if ( isRecordMode_ ) {
+        if ( auto records = sourceLogData_->expandToRecords( lines ) ) {
+            lines = std::move( *records );
+        }
+    }
+
+    matching_lines_ = std::move( lines );
+    marks_and_matches_ = matching_lines_ | marks_;
+    // Longest line of the file is a cheap upper bound
+    maxLength_ = sourceLogData_->getMaxLength();
+    nbLinesProcessed_ = getNbTotalLines();
+    updateSearchResultsUsage();
+
+    Q_EMIT searchProgressed( LinesCount( matching_lines_.cardinality() ), 100, 0_lnum );
+}
+
+void LogFilteredData::setRecordMode( bool isEnabled )
+{
+    if ( isEnabled == isRecordMode_ ) {
+        return;
+    }
+
+    isRecordMode_ = isEnabled;
+    // Cached results were found in the other mode
+    searchResultsCache_.clear();
+    updateSearchResultsCacheUsage();
+}
+
+bool LogFilteredData::isRecordMode() const
+{
+    return isRecordMode_;
+}
+
+bool LogFilteredData::isInverseRecordSearch() const
+{
+    return isRecordMode_ && currentRegExp_.isExclude && sourceLogData_->hasRecords();
+}
+
 LineNumber LogFilteredData::getMatchingLineNumber( LineNumber matchNum ) const
 {
     return findLogDataLine( matchNum );
@@ -187,6 +243,11 @@ LinesCount LogFilteredData::getNbMatches() const
     return LinesCount( matching_lines_.cardinality() );
 }
 
+SearchResultArray LogFilteredData::getMatchingLines() const
+{
+    return matching_lines_;
+}
+
 LinesCount LogFilteredData::getNbMarks() const
 {
     return LinesCount( marks_.cardinality() );
@@ -210,6 +271,13 @@ LogFilteredData::LineType LogFilteredData::lineTypeByLine( LineNumber lineNumber
     return line_type;
 }
 
+std::optional<klogg::vector<uint64_t>>
+LogFilteredData::countLogLevelLines( LogLevel level,
+                                     const klogg::vector<LineNumber>& boundaries ) const
+{
+    return sourceLogData_->countLogLevelLines( level, boundaries );
+}
+
 void LogFilteredData::iterateOverLines( const std::function<void( LineNumber )>& callback ) const
 {
     using CallbackFn = std::function<void( LineNumber )>;
@@ -388,9 +456,38 @@ void LogFilteredData::updateSearchResultsCache()
             cacheSize -= cachedResult->second.matching_lines.cardinality();
             cachedResult = searchResultsCache_.erase( cachedResult );
         }
+
+        updateSearchResultsCacheUsage();
     }
 }
 
+void LogFilteredData::updateSearchResultsCacheUsage()
+{
+    const auto cacheBytes = std::accumulate(
+        searchResultsCache_.cbegin(), searchResultsCache_.cend(), uint64_t{ 0 },
+        []( const auto& acc, const auto& next ) {
+            return acc + next.second.matching_lines.getSizeInBytes( false );
+        } );
+
+    searchResultsCacheMemory_.setUsage( cacheBytes );
+}
+
+void LogFilteredData::updateSearchResultsUsage()
+{
+    searchResultsMemory_.setUsage( matching_lines_.getSizeInBytes( false )
+                                   + marks_and_matches_.getSizeInBytes( false )
+                                   + inverseMatches_.getSizeInBytes( false ) );
+}
+
+void LogFilteredData::shedSearchResultsCache()
+{
+    LOG_INFO << "LogFilteredData: dropping " << searchResultsCache_.size()
+             << " cached search results";
+
+    searchResultsCache_.clear();
+    updateSearchResultsCacheUsage();
+}
+
 //
 // Q_SLOTS:
 //
@@ -401,11 +498,48 @@ void LogFilteredData::handleSearchProgressed( LinesCount nbMatches, int progress
 
     const auto searchResults = workerThread_.getSearchResults();
 
-    matching_lines_ |= searchResults.newMatches;
-    marks_and_matches_ |= searchResults.newMatches;
+    std::optional<SearchResultArray> newRecords;
+    std::optional<SearchResultArray> wholeRecords;
+    if ( isInverseRecordSearch() ) {
+        // Records are shown once none of their lines matches,
+        // lines not searched yet keep their records out
+        inverseMatches_ |= searchResults.newMatches;
+        if ( progress == 100 ) {
+            // Records growing with the file may have got matching lines
+            wholeRecords = sourceLogData_->wholeRecordsOf( inverseMatches_ );
+        }
+        else if ( const auto touchedRecords
+                  = sourceLogData_->expandToRecords( searchResults.newMatches ) ) {
+            // Only records of the new lines may have become whole
+            newRecords = sourceLogData_->wholeRecordsOf( *touchedRecords & inverseMatches_ );
+        }
+    }
+    else if ( isRecordMode_ ) {
+        newRecords = sourceLogData_->expandToRecords( searchResults.newMatches );
+    }
+
+    if ( wholeRecords ) {
+        matching_lines_ = std::move( *wholeRecords );
+        marks_and_matches_ = matching_lines_ | marks_;
+        nbMatches = LinesCount( matching_lines_.cardinality() );
+        maxLength_ = sourceLogData_->getMaxLength();
+    }
+    else if ( newRecords ) {
+        // Records may start before the lines searched so far
+        matching_lines_ |= *newRecords;
+        marks_and_matches_ |= *newRecords;
+        nbMatches = LinesCount( matching_lines_.cardinality() );
+        // Longest line of the file is a cheap upper bound
+        maxLength_ = sourceLogData_->getMaxLength();
+    }
+    else {
+        matching_lines_ |= searchResults.newMatches;
+        marks_and_matches_ |= searchResults.newMatches;
+        maxLength_ = searchResults.maxLength;
+    }
 
-    maxLength_ = searchResults.maxLength;
     nbLinesProcessed_ = searchResults.processedLines;
+    updateSearchResultsUsage();
 
     if ( progress == 100
          && nbLinesProcessed_.get() == getExpectedSearchEnd( currentSearchKey_ ).get() ) {
@@ -510,6 +644,73 @@ klogg::vector<QString> LogFilteredData::doGetExpandedLines( LineNumber first_lin
                        [ this ]( const auto& line ) { return doGetExpandedLineString( line ); } );
 }
 
+AbstractLogData::LineRanges LogFilteredData::findLogDataRanges( LineNumber first_line,
+                                                                 LinesCount number ) const
+{
+    LineRanges ranges;
+
+    const auto endLine = first_line + number;
+    auto index = first_line;
+    while ( index < endLine ) {
+        const auto runStart = findLogDataLine( index );
+        if ( runStart == maxValue<LineNumber>() ) {
+            ranges.emplace_back( runStart, 0_lcount );
+            ++index;
+            continue;
+        }
+
+        auto runLength = 1_lcount;
+        while ( index + runLength < endLine
+                && findLogDataLine( index + runLength ) == runStart + runLength ) {
+            ++runLength;
+        }
+
+        ranges.emplace_back( runStart, runLength );
+        index = index + runLength;
+    }
+
+    return ranges;
+}
+
+// Implementation of the virtual function.
+// Consecutive source lines are read from the source in one request.
+DecodedLines LogFilteredData::doGetLinesView( LineNumber first_line, LinesCount number ) const
+{
+    DecodedLines lines;
+    lines.reserve( number.get() );
+
+    for ( const auto& [ runStart, runLength ] : findLogDataRanges( first_line, number ) ) {
+        if ( runLength.get() == 0 ) {
+            lines.appendLine( QStringView{} );
+        }
+        else {
+            lines.append( sourceLogData_->getLinesView( runStart, runLength ) );
+        }
+    }
+
+    return lines;
+}
+
+// Implementation of the virtual function.
+bool LogFilteredData::doCanExportRawLines() const
+{
+    return sourceLogData_->canExportRawLines();
+}
+
+// Implementation of the virtual function.
+// Consecutive source lines are copied from the file in one go.
+bool LogFilteredData::doExportRawLines(
+    LineNumber first_line, LinesCount number, QFileDevice& output,
+    const std::function<bool( uint64_t, uint64_t )>& progress ) const
+{
+    auto ranges = findLogDataRanges( first_line, number );
+    ranges.erase( std::remove_if( ranges.begin(), ranges.end(),
+                                  []( const auto& range ) { return range.second.get() == 0; } ),
+                  ranges.end() );
+
+    return sourceLogData_->exportRawLineRanges( ranges, output, progress );
+}
+
 klogg::vector<QString>
 LogFilteredData::doGetLines( LineNumber first_line, LinesCount number,
                              const std::function<QString( LineNumber )>& lineGetter ) const
@@ -550,6 +751,11 @@ LineLength LogFilteredData::doGetLineLength( LineNumber lineNum ) const
     return sourceLogData_->getLineLength( line );
 }
 
+bool LogFilteredData::doIsLineContinued( LineNumber lineNum ) const
+{
+    return sourceLogData_->isLineContinued( findLogDataLine( lineNum ) );
+}
+
 void LogFilteredData::doSetDisplayEncoding( const char* encoding )
 {
     LOG_DEBUG << "AbstractLogData::setDisplayEncoding: " << encoding;
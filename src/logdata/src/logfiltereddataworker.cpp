@@ -36,8 +36,10 @@
  * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <deque>
 #include <exception>
 #include <qsemaphore.h>
 #include <utility>
@@ -51,8 +53,10 @@
 #include "issuereporter.h"
 #include "linetypes.h"
 #include "log.h"
+#include "performancecounters.h"
 #include "progress.h"
 #include "runnable_lambda.h"
+#include "tracing.h"
 
 #include "logdata.h"
 #include "regularexpression.h"
@@ -99,7 +103,7 @@ struct SearchBlockData {
 PartialSearchResults filterLines( const PatternMatcher& matcher, const LogData::RawLines& rawLines,
                                   LineNumber chunkStart )
 {
-    LOG_DEBUG << "Filter lines at " << chunkStart;
+    LOG_DEBUG_LIMITED( 10 ) << "Filter lines at " << chunkStart;
     PartialSearchResults results;
     results.chunkStart = chunkStart;
     results.processedLines = LinesCount{ rawLines.endOfLines.size() };
@@ -124,6 +128,19 @@ PartialSearchResults filterLines( const PatternMatcher& matcher, const LogData::
 
 } // namespace
 
+uint32_t searchThreadsCount()
+{
+    const auto& config = Configuration::get();
+    if ( !config.useParallelSearch() ) {
+        return 1;
+    }
+
+    const auto configuredThreadPoolSize = config.searchThreadPoolSize();
+    return static_cast<uint32_t>(
+        qMax( 1, configuredThreadPoolSize == 0 ? tbb::info::default_concurrency()
+                                               : configuredThreadPoolSize ) );
+}
+
 SearchResults SearchData::takeCurrentResults() const
 {
     UniqueLock lock( dataMutex_ );
@@ -281,17 +298,13 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
     high_resolution_clock::time_point t1 = high_resolution_clock::now();
 
     const auto& config = Configuration::get();
-    const auto matchingThreadsCount = static_cast<uint32_t>( [ &config ]() {
-        if ( !config.useParallelSearch() ) {
-            return 1;
-        }
-        const auto configuredThreadPoolSize = config.searchThreadPoolSize();
-        return qMax( 1, configuredThreadPoolSize == 0 ? tbb::info::default_concurrency()
-                                                      : configuredThreadPoolSize );
-    }() );
+    const auto matchingThreadsCount = searchThreadsCount();
 
     LOG_INFO << "Using " << matchingThreadsCount << " matching threads";
 
+    auto searchCounters
+        = PerformanceCounters::instance().registerSearch( regexp_.pattern, matchingThreadsCount );
+
     tbb::flow::graph searchGraph;
 
     if ( initialLine < startLine_ ) {
@@ -323,7 +336,8 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
         regexMatchers.emplace_back(
             regularExpression.createMatcher(), microseconds{ 0 },
             RegexMatcherNode(
-                searchGraph, 1, [ &regexMatchers, index, this ]( const BlockDataType& blockData ) {
+                searchGraph, 1,
+                [ &regexMatchers, &searchCounters, index, this ]( const BlockDataType& blockData ) {
                     if ( interruptRequested_ ) {
                         LOG_INFO << "Matcher " << index << " interrupted";
                         auto results = std::make_shared<PartialSearchResults>();
@@ -333,6 +347,8 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
                         return blockData;
                     }
 
+                    KLOGG_TRACE_SCOPE( "match" );
+
                     const auto& matcher = std::get<PatternMatcherPtr>( regexMatchers.at( index ) );
                     const auto matchStartTime = high_resolution_clock::now();
 
@@ -343,10 +359,16 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
 
                     microseconds& matchDuration
                         = std::get<microseconds>( regexMatchers.at( index ) );
-                    matchDuration += duration_cast<microseconds>( matchEndTime - matchStartTime );
-                    LOG_DEBUG << "Searcher " << index << " block " << blockData->chunkStart
-                              << " sending matches "
-                              << blockData->searchResults.matchingLines.cardinality();
+                    const auto blockMatchDuration
+                        = duration_cast<microseconds>( matchEndTime - matchStartTime );
+                    matchDuration += blockMatchDuration;
+                    searchCounters.addMatchedBlock(
+                        blockData->lines.endOfLines.size(), blockData->lines.buffer.size(),
+                        static_cast<uint64_t>( blockMatchDuration.count() ) );
+                    LOG_DEBUG_LIMITED( 10 )
+                        << "Searcher " << index << " block " << blockData->chunkStart
+                        << " sending matches "
+                        << blockData->searchResults.matchingLines.cardinality();
                     return blockData;
                 } ) );
     }
@@ -370,6 +392,8 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
                     return tbb::flow::continue_msg{};
                 }
 
+                KLOGG_TRACE_SCOPE( "combine" );
+
                 const auto& matchResults = blockData->searchResults;
 
                 const auto matchProcessorStartTime = high_resolution_clock::now();
@@ -391,8 +415,9 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
                     searchData.addAll( maxLength, matchResults.matchingLines, matchesCount,
                                        processedLines );
 
-                    LOG_DEBUG << "done Searching chunk starting at " << matchResults.chunkStart
-                              << ", " << matchResults.processedLines << " lines read.";
+                    LOG_DEBUG_LIMITED( 10 )
+                        << "done Searching chunk starting at " << matchResults.chunkStart << ", "
+                        << matchResults.processedLines << " lines read.";
                 }
 
                 delete blockData;
@@ -424,37 +449,74 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
     tbb::flow::make_edge( resultsQueue, matchProcessor );
     tbb::flow::make_edge( matchProcessor, blockPrefetcher.decrementer() );
 
-    auto chunkStart = initialLine;
-    while ( chunkStart < endLine && !interruptRequested_ ) {
+    const auto queueDepth = std::max( 1, config.ioQueueDepth() );
+    const auto blockReader = sourceLogData_.createBlockReader( queueDepth );
+
+    using PendingChunk = std::pair<LineNumber, LogData::PendingRawLines>;
+    std::deque<PendingChunk> pendingChunks;
+
+    auto nextChunkStart = initialLine;
+    while ( !interruptRequested_ ) {
+        // Next chunks are read while matchers are busy with the current one
+        while ( klogg::ssize( pendingChunks ) < queueDepth && nextChunkStart < endLine ) {
+            const auto linesInChunk
+                = LinesCount( qMin( nbLinesInChunk.get(), ( endLine - nextChunkStart ).get() ) );
+            pendingChunks.emplace_back(
+                nextChunkStart,
+                sourceLogData_.getLinesRawAsync( nextChunkStart, linesInChunk, *blockReader ) );
+            nextChunkStart = nextChunkStart + nbLinesInChunk;
+        }
+
+        if ( pendingChunks.empty() ) {
+            break;
+        }
+
         const auto lineSourceStartTime = high_resolution_clock::now();
-        LOG_DEBUG << "Reading chunk starting at " << chunkStart;
 
-        const auto linesInChunk
-            = LinesCount( qMin( nbLinesInChunk.get(), ( endLine - chunkStart ).get() ) );
-        auto lines = sourceLogData_.getLinesRaw( chunkStart, linesInChunk );
+        auto [ chunkStart, pendingLines ] = std::move( pendingChunks.front() );
+        pendingChunks.pop_front();
+
+        LOG_DEBUG_LIMITED( 10 ) << "Reading chunk starting at " << chunkStart;
 
-        /*LOG_DEBUG << "Sending chunk starting at " << chunkStart << ", " <<
-            lines.second.size()
-                << " lines read.";*/
-        BlockDataType blockData = new SearchBlockData{ chunkStart, std::move( lines ) };
+        if ( pendingLines.bytesRead.valid() ) {
+            KLOGG_TRACE_SCOPE( "read chunk" );
+            const auto bytesRead = pendingLines.bytesRead.get();
+            if ( bytesRead != klogg::ssize( pendingLines.lines.buffer ) ) {
+                LOG_DEBUG << "failed to read " << pendingLines.lines.buffer.size()
+                          << " bytes, got " << bytesRead;
+            }
+        }
+
+        BlockDataType blockData
+            = new SearchBlockData{ chunkStart, std::move( pendingLines.lines ) };
 
         const auto lineSourceEndTime = high_resolution_clock::now();
         const auto chunkReadTime
             = duration_cast<microseconds>( lineSourceEndTime - lineSourceStartTime );
 
-        /*LOG_DEBUG << "Sent chunk starting at " << chunkStart << ", " <<
-        blockData->lines.second.size()
-                << " lines read in " << static_cast<float>( chunkReadTime.count() )
-        / 1000.f
-                << " ms";*/
-
-        chunkStart = chunkStart + nbLinesInChunk;
         fileReadingDuration += chunkReadTime;
 
-        while ( !blockPrefetcher.try_put( blockData ) && !interruptRequested_ ) {
+        auto isSent = false;
+        while ( !( isSent = blockPrefetcher.try_put( blockData ) ) && !interruptRequested_ ) {
             std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
         }
+
+        if ( !isSent ) {
+            delete blockData;
+        }
+    }
+
+    // Buffers of interrupted search can be freed only when reads into them are done
+    for ( auto& pendingChunk : pendingChunks ) {
+        if ( pendingChunk.second.bytesRead.valid() ) {
+            pendingChunk.second.bytesRead.wait();
+        }
     }
+    pendingChunks.clear();
+
+    const auto readStats = blockReader->stats();
+    PerformanceCounters::instance().setReadStats( readStats.queueDepth,
+                                                  readStats.megabytesPerSecond );
 
     searchGraph.wait_for_all();
 
@@ -463,7 +525,8 @@ void SearchOperation::doSearch( SearchData& searchData, LineNumber initialLine )
     const auto durationMs = duration_cast<milliseconds>( t2 - t1 );
 
     LOG_INFO << "Searching done, overall duration " << durationUs;
-    LOG_INFO << "Line reading took " << fileReadingDuration;
+    LOG_INFO << "Line reading took " << fileReadingDuration << ", "
+             << readStats.megabytesPerSecond << " MiB/s at queue depth " << readStats.queueDepth;
     LOG_INFO << "Results combining took " << matchCombiningDuration;
 
     for ( const auto& regexMatcher : regexMatchers ) {
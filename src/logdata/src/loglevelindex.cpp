@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loglevelindex.h"
+
+#include <algorithm>
+#include <string_view>
+
+namespace {
+
+struct LevelKeyword {
+    std::string_view keyword;
+    LogLevel level;
+};
+
+// Upper case, matched case-insensitively as whole words
+constexpr std::array<LevelKeyword, 17> LevelKeywords = { {
+    { "TRACE", LogLevel::Trace },
+    { "TRC", LogLevel::Trace },
+    { "VERBOSE", LogLevel::Trace },
+    { "DEBUG", LogLevel::Debug },
+    { "DBG", LogLevel::Debug },
+    { "INFO", LogLevel::Info },
+    { "INF", LogLevel::Info },
+    { "NOTICE", LogLevel::Info },
+    { "WARN", LogLevel::Warning },
+    { "WARNING", LogLevel::Warning },
+    { "WRN", LogLevel::Warning },
+    { "ERROR", LogLevel::Error },
+    { "ERR", LogLevel::Error },
+    { "FATAL", LogLevel::Error },
+    { "CRITICAL", LogLevel::Error },
+    { "SEVERE", LogLevel::Error },
+    { "PANIC", LogLevel::Error },
+} };
+
+constexpr size_t MaxKeywordLength = 8;
+
+bool isLetter( char c )
+{
+    return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' );
+}
+
+char toUpper( char c )
+{
+    return c >= 'a' && c <= 'z' ? static_cast<char>( c - 'a' + 'A' ) : c;
+}
+
+LogLevel levelOfWord( const char* word, size_t length )
+{
+    if ( length < 3 || length > MaxKeywordLength ) {
+        return LogLevel::None;
+    }
+
+    std::array<char, MaxKeywordLength> upperWord{};
+    std::transform( word, word + length, upperWord.begin(), toUpper );
+    const auto upperView = std::string_view( upperWord.data(), length );
+
+    for ( const auto& keyword : LevelKeywords ) {
+        if ( keyword.keyword == upperView ) {
+            return keyword.level;
+        }
+    }
+    return LogLevel::None;
+}
+
+size_t levelIndex( LogLevel level )
+{
+    auto bits = static_cast<uint8_t>( level );
+    size_t index = 0;
+    while ( bits > 1 ) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+} // namespace
+
+LogLevelClassifier::LogLevelClassifier( size_t searchDepth,
+                                        const QRegularExpression& levelPattern )
+    : searchDepth_( searchDepth )
+    , levelPattern_( levelPattern )
+    , hasLevelPattern_( !levelPattern.pattern().isEmpty() && levelPattern.isValid() )
+{
+    if ( hasLevelPattern_ ) {
+        levelPattern_.optimize();
+    }
+}
+
+LogLevel LogLevelClassifier::classify( const char* line, size_t length ) const
+{
+    if ( hasLevelPattern_ ) {
+        return classifyByPattern( line, length );
+    }
+
+    const auto end = std::min( length, searchDepth_ );
+
+    size_t position = 0;
+    while ( position < end ) {
+        if ( !isLetter( line[ position ] ) ) {
+            ++position;
+            continue;
+        }
+
+        const auto wordStart = position;
+        while ( position < length && isLetter( line[ position ] ) ) {
+            ++position;
+        }
+
+        const auto level = levelOfWord( line + wordStart, position - wordStart );
+        if ( level != LogLevel::None ) {
+            return level;
+        }
+    }
+
+    return LogLevel::None;
+}
+
+LogLevel LogLevelClassifier::classifyByPattern( const char* line, size_t length ) const
+{
+    // Keyword starting within the search depth is read to its end
+    const auto prefixLength = std::min( length, searchDepth_ + MaxKeywordLength );
+    const auto prefix = QString::fromUtf8( line, static_cast<int>( prefixLength ) );
+
+    const auto match = levelPattern_.match( prefix );
+    if ( !match.hasMatch() ) {
+        return LogLevel::None;
+    }
+
+    const auto group = levelPattern_.captureCount() > 0 ? 1 : 0;
+    if ( match.capturedStart( group ) < 0
+         || static_cast<size_t>( match.capturedStart( group ) ) >= searchDepth_ ) {
+        return LogLevel::None;
+    }
+
+    const auto keyword = match.captured( group ).toLatin1();
+    return levelOfWord( keyword.constData(), static_cast<size_t>( keyword.size() ) );
+}
+
+void LogLevelIndex::append( LineNumber firstLine, const klogg::vector<LogLevel>& levels )
+{
+    if ( firstLine.get() < size_ ) {
+        for ( auto& lines : lines_ ) {
+            for ( auto line = firstLine.get(); line < size_; ++line ) {
+                lines.remove( line );
+            }
+        }
+        size_ = firstLine.get();
+    }
+
+    for ( const auto level : levels ) {
+        if ( level != LogLevel::None ) {
+            lines_[ levelIndex( level ) ].add( size_ );
+        }
+        ++size_;
+    }
+}
+
+void LogLevelIndex::clear()
+{
+    for ( auto& lines : lines_ ) {
+        lines = {};
+    }
+    size_ = 0;
+}
+
+LinesCount LogLevelIndex::size() const
+{
+    return LinesCount( size_ );
+}
+
+size_t LogLevelIndex::allocatedSize() const
+{
+    size_t size = 0;
+    for ( const auto& lines : lines_ ) {
+        size += lines.getSizeInBytes( false );
+    }
+    return size;
+}
+
+const SearchResultArray& LogLevelIndex::linesOfLevel( LogLevel level ) const
+{
+    return lines_[ levelIndex( level ) ];
+}
+
+SearchResultArray LogLevelIndex::linesOfLevels( LogLevels levels ) const
+{
+    SearchResultArray result;
+    for ( auto index = 0u; index < LevelsCount; ++index ) {
+        if ( levels.testFlag( static_cast<LogLevel>( 1 << index ) ) ) {
+            result |= lines_[ index ];
+        }
+    }
+    return result;
+}
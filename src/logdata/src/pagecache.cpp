@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pagecache.h"
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#endif
+
+#include "configuration.h"
+#include "log.h"
+#include "memory_info.h"
+
+namespace {
+
+// Files larger than this part of RAM would push most of other data
+// out of page cache while gaining little from it themselves
+constexpr uint64_t AutoDropMemoryFraction = 4;
+
+} // namespace
+
+void advisePageCache( int fileDescriptor, int64_t offset, int64_t size, PageCacheAdvice advice )
+{
+#ifdef Q_OS_LINUX
+    if ( fileDescriptor < 0 || offset < 0 || size <= 0 ) {
+        return;
+    }
+
+    int nativeAdvice = POSIX_FADV_NORMAL;
+    switch ( advice ) {
+    case PageCacheAdvice::Sequential:
+        nativeAdvice = POSIX_FADV_SEQUENTIAL;
+        break;
+    case PageCacheAdvice::WillNeed:
+        nativeAdvice = POSIX_FADV_WILLNEED;
+        break;
+    case PageCacheAdvice::DontNeed:
+        nativeAdvice = POSIX_FADV_DONTNEED;
+        break;
+    }
+
+    const auto result = ::posix_fadvise( fileDescriptor, offset, size, nativeAdvice );
+    if ( result != 0 ) {
+        LOG_DEBUG << "posix_fadvise " << static_cast<int>( advice ) << " failed: " << result;
+    }
+#else
+    Q_UNUSED( fileDescriptor );
+    Q_UNUSED( offset );
+    Q_UNUSED( size );
+    Q_UNUSED( advice );
+#endif
+}
+
+bool shouldDropScannedPages( int64_t fileSize )
+{
+    switch ( Configuration::get().pageCachePolicy() ) {
+    case PageCachePolicy::KeepCached:
+        return false;
+    case PageCachePolicy::DropAfterScan:
+        return true;
+    case PageCachePolicy::Auto:
+        break;
+    }
+
+    const auto memory = physicalMemory();
+    return memory > 0 && static_cast<uint64_t>( fileSize ) > memory / AutoDropMemoryFraction;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recordindex.h"
+
+void RecordIndex::append( LineNumber firstLine, const klogg::vector<bool>& isRecordStart )
+{
+    if ( firstLine.get() < size_ ) {
+        for ( auto line = firstLine.get(); line < size_; ++line ) {
+            starts_.remove( line );
+        }
+        size_ = firstLine.get();
+    }
+
+    for ( const auto isStart : isRecordStart ) {
+        if ( isStart ) {
+            starts_.add( size_ );
+        }
+        ++size_;
+    }
+}
+
+void RecordIndex::clear()
+{
+    starts_ = {};
+    size_ = 0;
+}
+
+LinesCount RecordIndex::size() const
+{
+    return LinesCount( size_ );
+}
+
+size_t RecordIndex::allocatedSize() const
+{
+    return starts_.getSizeInBytes( false );
+}
+
+const SearchResultArray& RecordIndex::recordStarts() const
+{
+    return starts_;
+}
+
+SearchResultArray RecordIndex::expandToRecords( const SearchResultArray& lines ) const
+{
+    SearchResultArray records;
+
+    // Lines are visited in order, so lines of the last added
+    // record are skipped without looking up the starts
+    uint64_t recordEnd = 0;
+    for ( const auto line : lines ) {
+        if ( line >= size_ ) {
+            records.add( line );
+            continue;
+        }
+
+        if ( line < recordEnd ) {
+            continue;
+        }
+
+        // Number of record starts up to the line (inclusive)
+        const auto startsBefore = starts_.rank( line );
+
+        uint64_t recordStart = 0;
+        if ( startsBefore > 0 ) {
+            starts_.select( startsBefore - 1, &recordStart );
+        }
+
+        uint64_t nextStart = 0;
+        recordEnd = starts_.select( startsBefore, &nextStart ) ? nextStart : size_;
+
+        records.addRange( recordStart, recordEnd );
+    }
+
+    return records;
+}
+
+SearchResultArray RecordIndex::wholeRecordsOf( const SearchResultArray& lines ) const
+{
+    // Lines missing from the records touched by the passed lines
+    // rule out their records
+    const auto missingLines = expandToRecords( lines ) - lines;
+    return lines - expandToRecords( missingLines );
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "streamspooler.h"
+
+#include <cstdint>
+#include <thread>
+
+#include <QFile>
+
+#include <fcntl.h>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "containers.h"
+#include "log.h"
+
+namespace {
+
+// Read returns whatever the pipe has, so a slow stream is written in
+// small pieces and a fast one in chunks of this size
+constexpr size_t SpoolBufferSize = 1024 * 1024;
+
+constexpr int StdinDescriptor = 0;
+
+#ifdef Q_OS_WIN
+const auto PipePrefix = QStringLiteral( "\\\\.\\pipe\\" );
+#else
+// Unix domain socket can't be opened as a file, the spooler connects to it
+int connectSocket( const QByteArray& path )
+{
+    sockaddr_un address{};
+    if ( static_cast<size_t>( path.size() ) >= sizeof( address.sun_path ) ) {
+        return -1;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy( address.sun_path, path.constData(), static_cast<size_t>( path.size() ) );
+
+    const auto socketDescriptor = ::socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( socketDescriptor < 0 ) {
+        return -1;
+    }
+
+    if ( ::connect( socketDescriptor, reinterpret_cast<const sockaddr*>( &address ),
+                    sizeof( address ) )
+         != 0 ) {
+        ::close( socketDescriptor );
+        return -1;
+    }
+    return socketDescriptor;
+}
+#endif
+
+// Opening a FIFO blocks until there is a writer, so it is done
+// by the spooling thread
+int openStream( const QString& streamName )
+{
+#ifdef Q_OS_WIN
+    if ( streamName == StreamSpooler::StdinName ) {
+        ::_setmode( StdinDescriptor, _O_BINARY );
+        return StdinDescriptor;
+    }
+    return ::_wopen( reinterpret_cast<const wchar_t*>( streamName.utf16() ),
+                     _O_RDONLY | _O_BINARY );
+#else
+    if ( streamName == StreamSpooler::StdinName ) {
+        return StdinDescriptor;
+    }
+
+    const auto path = QFile::encodeName( streamName );
+    struct stat status {};
+    if ( ::stat( path.constData(), &status ) == 0 && S_ISSOCK( status.st_mode ) ) {
+        return connectSocket( path );
+    }
+    return ::open( path.constData(), O_RDONLY );
+#endif
+}
+
+void closeStream( int fileDescriptor )
+{
+    if ( fileDescriptor == StdinDescriptor ) {
+        return;
+    }
+#ifdef Q_OS_WIN
+    ::_close( fileDescriptor );
+#else
+    ::close( fileDescriptor );
+#endif
+}
+
+int64_t readStream( int fileDescriptor, char* buffer, size_t size )
+{
+#ifdef Q_OS_WIN
+    return ::_read( fileDescriptor, buffer, static_cast<unsigned>( size ) );
+#else
+    ssize_t readBytes = 0;
+    do {
+        readBytes = ::read( fileDescriptor, buffer, size );
+    } while ( readBytes < 0 && errno == EINTR );
+    return readBytes;
+#endif
+}
+
+} // namespace
+
+StreamSpooler::StreamSpooler( const QString& streamName, const QString& spoolFileName )
+    : state_{ std::make_shared<SpoolState>() }
+{
+    state_->streamName = streamName;
+    state_->spoolFileName = spoolFileName;
+}
+
+StreamSpooler::~StreamSpooler()
+{
+    state_->isStopRequested = true;
+}
+
+bool StreamSpooler::start()
+{
+    // File must exist before it is opened for indexing
+    QFile spoolFile( state_->spoolFileName );
+    if ( !spoolFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        LOG_ERROR << "Can't create spool file " << state_->spoolFileName << ": "
+                  << spoolFile.errorString();
+        return false;
+    }
+    spoolFile.close();
+
+    LOG_INFO << "Spooling " << state_->streamName << " to " << state_->spoolFileName;
+
+    std::thread( spool, state_ ).detach();
+    return true;
+}
+
+QString StreamSpooler::streamName() const
+{
+    return state_->streamName;
+}
+
+QString StreamSpooler::spoolFileName() const
+{
+    return state_->spoolFileName;
+}
+
+bool StreamSpooler::isStream( const QString& fileName )
+{
+    if ( fileName == StdinName ) {
+        return true;
+    }
+
+#ifdef Q_OS_WIN
+    return fileName.startsWith( PipePrefix, Qt::CaseInsensitive );
+#else
+    // Devices and other special files are not streams to spool
+    struct stat status {};
+    return ::stat( QFile::encodeName( fileName ).constData(), &status ) == 0
+           && ( S_ISFIFO( status.st_mode ) || S_ISSOCK( status.st_mode ) );
+#endif
+}
+
+void StreamSpooler::spool( const std::shared_ptr<SpoolState>& state )
+{
+    QFile spoolFile( state->spoolFileName );
+    if ( !spoolFile.open( QIODevice::WriteOnly | QIODevice::Append ) ) {
+        LOG_ERROR << "Can't open spool file " << state->spoolFileName << ": "
+                  << spoolFile.errorString();
+        return;
+    }
+
+    const auto fileDescriptor = openStream( state->streamName );
+    if ( fileDescriptor < 0 ) {
+        LOG_ERROR << "Can't open stream " << state->streamName;
+        return;
+    }
+
+    uint64_t spooledBytes = 0;
+    klogg::vector<char> buffer( SpoolBufferSize );
+    while ( !state->isStopRequested ) {
+        const auto readBytes = readStream( fileDescriptor, buffer.data(), buffer.size() );
+        if ( readBytes <= 0 ) {
+            if ( readBytes < 0 ) {
+                LOG_WARNING << "Failed to read stream " << state->streamName;
+            }
+            break;
+        }
+
+        // Stream was closed in the UI while the read was blocked
+        if ( state->isStopRequested ) {
+            break;
+        }
+
+        // Flushed right away for the file watcher to see new data
+        if ( spoolFile.write( buffer.data(), readBytes ) != readBytes || !spoolFile.flush() ) {
+            LOG_ERROR << "Failed to write spool file " << state->spoolFileName << ": "
+                      << spoolFile.errorString();
+            break;
+        }
+
+        spooledBytes += static_cast<uint64_t>( readBytes );
+    }
+
+    closeStream( fileDescriptor );
+
+    LOG_INFO << "Spooling " << state->streamName << " finished, " << spooledBytes << " bytes";
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "templatemining.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <QRegularExpression>
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include "log.h"
+#include "logdata.h"
+#include "tracing.h"
+
+namespace {
+
+using Token = std::u16string_view;
+using Tokens = klogg::vector<Token>;
+
+constexpr Token Wildcard = u"<*>";
+
+bool hasDigits( Token token )
+{
+    return std::any_of( token.begin(), token.end(),
+                        []( char16_t c ) { return c >= u'0' && c <= u'9'; } );
+}
+
+// Splits line by spaces and tabs, tokens with digits are replaced by wildcard
+void tokenize( QStringView line, Tokens& tokens )
+{
+    tokens.clear();
+
+    const auto* text = reinterpret_cast<const char16_t*>( line.data() );
+    const auto length = static_cast<size_t>( line.size() );
+
+    size_t tokenStart = 0;
+    for ( size_t position = 0; position <= length; ++position ) {
+        if ( position < length && text[ position ] != u' ' && text[ position ] != u'\t' ) {
+            continue;
+        }
+
+        if ( position > tokenStart ) {
+            const auto token = Token( text + tokenStart, position - tokenStart );
+            tokens.push_back( hasDigits( token ) ? Wildcard : token );
+        }
+        tokenStart = position + 1;
+    }
+}
+
+struct Cluster {
+    klogg::vector<std::u16string> tokens;
+    uint64_t count = 0;
+    LineNumber::UnderlyingType firstLine = 0;
+    LineNumber::UnderlyingType lastLine = 0;
+};
+
+struct TreeNode {
+    std::map<std::u16string, std::unique_ptr<TreeNode>, std::less<>> children;
+    klogg::vector<size_t> clusters;
+};
+
+class DrainTree {
+  public:
+    explicit DrainTree( const TemplateMiningParameters& parameters )
+        : parameters_( parameters )
+    {
+    }
+
+    void add( const Tokens& tokens, uint64_t count, LineNumber::UnderlyingType firstLine,
+              LineNumber::UnderlyingType lastLine )
+    {
+        auto& leaf = findLeaf( tokens );
+
+        Cluster* bestCluster = nullptr;
+        double bestSimilarity = -1;
+        size_t bestWildcards = 0;
+        for ( const auto index : leaf.clusters ) {
+            auto& cluster = clusters_[ index ];
+            size_t equalTokens = 0;
+            size_t wildcards = 0;
+            for ( auto i = 0u; i < tokens.size(); ++i ) {
+                if ( cluster.tokens[ i ] == Wildcard ) {
+                    ++wildcards;
+                }
+                else if ( cluster.tokens[ i ] == tokens[ i ] ) {
+                    ++equalTokens;
+                }
+            }
+
+            const auto similarity
+                = static_cast<double>( equalTokens ) / static_cast<double>( tokens.size() );
+            if ( similarity > bestSimilarity
+                 || ( similarity == bestSimilarity && wildcards > bestWildcards ) ) {
+                bestCluster = &cluster;
+                bestSimilarity = similarity;
+                bestWildcards = wildcards;
+            }
+        }
+
+        if ( bestCluster != nullptr && bestSimilarity >= parameters_.similarityThreshold ) {
+            for ( auto i = 0u; i < tokens.size(); ++i ) {
+                if ( bestCluster->tokens[ i ] != tokens[ i ] ) {
+                    bestCluster->tokens[ i ] = std::u16string( Wildcard );
+                }
+            }
+            bestCluster->count += count;
+            bestCluster->firstLine = std::min( bestCluster->firstLine, firstLine );
+            bestCluster->lastLine = std::max( bestCluster->lastLine, lastLine );
+            return;
+        }
+
+        Cluster cluster;
+        cluster.tokens.reserve( tokens.size() );
+        for ( const auto& token : tokens ) {
+            cluster.tokens.emplace_back( token );
+        }
+        cluster.count = count;
+        cluster.firstLine = firstLine;
+        cluster.lastLine = lastLine;
+
+        leaf.clusters.push_back( clusters_.size() );
+        clusters_.push_back( std::move( cluster ) );
+    }
+
+    const klogg::vector<Cluster>& clusters() const
+    {
+        return clusters_;
+    }
+
+  private:
+    TreeNode& findLeaf( const Tokens& tokens )
+    {
+        auto* node = &tokensCountNodes_[ tokens.size() ];
+
+        const auto depth = std::min( tokens.size(), parameters_.prefixDepth );
+        for ( auto i = 0u; i < depth; ++i ) {
+            auto key = tokens[ i ];
+            auto child = node->children.find( key );
+            if ( child == node->children.end() ) {
+                if ( node->children.size() >= parameters_.maxChildren ) {
+                    key = Wildcard;
+                    child = node->children.find( key );
+                }
+                if ( child == node->children.end() ) {
+                    child = node->children
+                                .emplace( std::u16string( key ), std::make_unique<TreeNode>() )
+                                .first;
+                }
+            }
+            node = child->second.get();
+        }
+
+        return *node;
+    }
+
+  private:
+    TemplateMiningParameters parameters_;
+    std::map<size_t, TreeNode> tokensCountNodes_;
+    klogg::vector<Cluster> clusters_;
+};
+
+// Per thread state
+struct TemplateMiner {
+    explicit TemplateMiner( const TemplateMiningParameters& parameters )
+        : tree( parameters )
+    {
+    }
+
+    DrainTree tree;
+    Tokens tokens;
+    uint64_t processedLines = 0;
+};
+
+QString toQString( const std::u16string& token )
+{
+    return QString::fromUtf16( token.data(), static_cast<int>( token.size() ) );
+}
+
+LogTemplate makeTemplate( const Cluster& cluster )
+{
+    LogTemplate logTemplate;
+    logTemplate.count = cluster.count;
+    logTemplate.firstLine = LineNumber( cluster.firstLine );
+    logTemplate.lastLine = LineNumber( cluster.lastLine );
+
+    QStringList text;
+    QStringList pattern;
+    for ( const auto& token : cluster.tokens ) {
+        const auto tokenString = toQString( token );
+        text.append( tokenString );
+        pattern.append( token == Wildcard ? QStringLiteral( "\\S+" )
+                                          : QRegularExpression::escape( tokenString ) );
+    }
+
+    logTemplate.text = text.join( QChar::Space );
+    logTemplate.pattern = QStringLiteral( "^\\s*%1\\s*$" ).arg( pattern.join( "\\s+" ) );
+    return logTemplate;
+}
+
+} // namespace
+
+TemplateMiningResult mineTemplates( const LogData& logData, const LinesSelection& selection,
+                                    const TemplateMiningParameters& parameters,
+                                    AtomicFlag& interruptRequested,
+                                    const std::function<void( int )>& progress )
+{
+    TemplateMiningResult result;
+
+    LOG_INFO << "Mining templates from line " << selection.startLine << " to "
+             << selection.endLine;
+
+    using namespace std::chrono;
+    const auto startTime = steady_clock::now();
+
+    tbb::enumerable_thread_specific<TemplateMiner> miners(
+        [ &parameters ] { return TemplateMiner( parameters ); } );
+
+    const auto isCompleted = processLineChunks(
+        logData, selection, interruptRequested, progress, [ &miners ]( const LinesChunk& chunk ) {
+            KLOGG_TRACE_SCOPE( "mine templates" );
+
+            auto& miner = miners.local();
+            chunk.forEachLine( [ &miner ]( LineNumber lineNumber, QStringView line ) {
+                ++miner.processedLines;
+
+                tokenize( line, miner.tokens );
+                if ( !miner.tokens.empty() ) {
+                    miner.tree.add( miner.tokens, 1, lineNumber.get(), lineNumber.get() );
+                }
+            } );
+        } );
+
+    if ( !isCompleted ) {
+        LOG_INFO << "Template mining interrupted";
+        result.isInterrupted = true;
+        return result;
+    }
+
+    // Templates of each thread are added to a single tree like lines
+    DrainTree merged( parameters );
+    Tokens tokens;
+    for ( const auto& miner : miners ) {
+        result.processedLines += miner.processedLines;
+
+        for ( const auto& cluster : miner.tree.clusters() ) {
+            tokens.assign( cluster.tokens.begin(), cluster.tokens.end() );
+            merged.add( tokens, cluster.count, cluster.firstLine, cluster.lastLine );
+        }
+    }
+
+    result.templates.reserve( merged.clusters().size() );
+    for ( const auto& cluster : merged.clusters() ) {
+        result.templates.push_back( makeTemplate( cluster ) );
+    }
+
+    std::sort( result.templates.begin(), result.templates.end(),
+               []( const LogTemplate& lhs, const LogTemplate& rhs ) {
+                   return lhs.count > rhs.count
+                          || ( lhs.count == rhs.count && lhs.firstLine < rhs.firstLine );
+               } );
+
+    LOG_INFO << "Found " << result.templates.size() << " templates in " << result.processedLines
+             << " lines in " << duration_cast<milliseconds>( steady_clock::now() - startTime ).count()
+             << " ms";
+
+    return result;
+}
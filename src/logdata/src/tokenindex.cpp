@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tokenindex.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "filedigest.h"
+
+namespace {
+
+bool isLess( const TokenPosting& lhs, const TokenPosting& rhs )
+{
+    return lhs.tokenHash < rhs.tokenHash
+           || ( lhs.tokenHash == rhs.tokenHash && lhs.line < rhs.line );
+}
+
+bool isLessHash( const TokenPosting& posting, uint64_t tokenHash )
+{
+    return posting.tokenHash < tokenHash;
+}
+
+void addLines( const klogg::vector<TokenPosting>& postings, uint64_t tokenHash,
+               SearchResultArray& lines )
+{
+    for ( auto posting = std::lower_bound( postings.begin(), postings.end(), tokenHash,
+                                           isLessHash );
+          posting != postings.end() && posting->tokenHash == tokenHash; ++posting ) {
+        lines.add( posting->line );
+    }
+}
+
+} // namespace
+
+TokenExtractor::TokenExtractor( const QString& pattern )
+    : regex_( pattern, QRegularExpression::CaseInsensitiveOption )
+{
+    regex_.optimize();
+}
+
+bool TokenExtractor::isValid() const
+{
+    return !regex_.pattern().isEmpty() && regex_.isValid();
+}
+
+bool TokenExtractor::isToken( const QString& text ) const
+{
+    auto matches = regex_.globalMatch( text );
+    while ( matches.hasNext() ) {
+        const auto match = matches.next();
+        if ( match.capturedStart() == 0 && match.capturedLength() == text.size() ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TokenExtractor::hasToken( QStringView text, const QString& token ) const
+{
+    const auto lineString = QString::fromRawData( text.data(), static_cast<int>( text.size() ) );
+
+    auto matches = regex_.globalMatch( lineString );
+    while ( matches.hasNext() ) {
+        const auto match = matches.next();
+        if ( text.mid( match.capturedStart(), match.capturedLength() )
+                 .compare( token, Qt::CaseInsensitive )
+             == 0 ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void TokenExtractor::extract( LineNumber line, QStringView text,
+                              klogg::vector<TokenPosting>& postings ) const
+{
+    const auto lineString = QString::fromRawData( text.data(), static_cast<int>( text.size() ) );
+
+    auto matches = regex_.globalMatch( lineString );
+    while ( matches.hasNext() ) {
+        const auto match = matches.next();
+        if ( match.capturedLength() > 0 ) {
+            const auto token = text.mid( match.capturedStart(), match.capturedLength() );
+            postings.push_back( { hashToken( token ), line.get() } );
+        }
+    }
+}
+
+uint64_t TokenExtractor::hashToken( QStringView token )
+{
+    const auto foldedToken = token.toString().toCaseFolded();
+
+    FileDigest digest;
+    digest.addData( reinterpret_cast<const char*>( foldedToken.constData() ),
+                    static_cast<size_t>( foldedToken.size() ) * sizeof( QChar ) );
+    return digest.digest();
+}
+
+void TokenIndex::append( LineNumber firstLine, klogg::vector<TokenPosting> postings,
+                         LinesCount indexedLines )
+{
+    if ( firstLine.get() < indexedLines_ ) {
+        dropLines( firstLine );
+    }
+
+    std::sort( postings.begin(), postings.end(), isLess );
+
+    const auto recentSize = recentPostings_.size();
+    recentPostings_.insert( recentPostings_.end(), std::make_move_iterator( postings.begin() ),
+                            std::make_move_iterator( postings.end() ) );
+    std::inplace_merge( recentPostings_.begin(),
+                        recentPostings_.begin() + static_cast<std::ptrdiff_t>( recentSize ),
+                        recentPostings_.end(), isLess );
+
+    indexedLines_ = indexedLines.get();
+
+    // Keep merging cost proportional to the appended data. The last line
+    // stays among recent postings as it is dropped by the next append
+    // if it had no line feed.
+    if ( recentPostings_.size() > postings_.size() / 8 ) {
+        const auto lastLine = indexedLines_ > 0 ? indexedLines_ - 1 : 0;
+        const auto merged = std::stable_partition(
+            recentPostings_.begin(), recentPostings_.end(),
+            [ lastLine ]( const TokenPosting& posting ) { return posting.line < lastLine; } );
+
+        const auto mainSize = postings_.size();
+        postings_.insert( postings_.end(), recentPostings_.begin(), merged );
+        std::inplace_merge( postings_.begin(),
+                            postings_.begin() + static_cast<std::ptrdiff_t>( mainSize ),
+                            postings_.end(), isLess );
+        recentPostings_.erase( recentPostings_.begin(), merged );
+        mergedLines_ = lastLine;
+    }
+}
+
+void TokenIndex::dropLines( LineNumber firstLine )
+{
+    const auto isDropped
+        = [ firstLine ]( const TokenPosting& posting ) { return posting.line >= firstLine.get(); };
+
+    recentPostings_.erase(
+        std::remove_if( recentPostings_.begin(), recentPostings_.end(), isDropped ),
+        recentPostings_.end() );
+
+    if ( firstLine.get() < mergedLines_ ) {
+        postings_.erase( std::remove_if( postings_.begin(), postings_.end(), isDropped ),
+                         postings_.end() );
+        mergedLines_ = firstLine.get();
+    }
+
+    indexedLines_ = firstLine.get();
+}
+
+void TokenIndex::clear()
+{
+    postings_ = {};
+    recentPostings_ = {};
+    indexedLines_ = 0;
+    mergedLines_ = 0;
+}
+
+LinesCount TokenIndex::indexedLines() const
+{
+    return LinesCount( indexedLines_ );
+}
+
+size_t TokenIndex::allocatedSize() const
+{
+    return ( postings_.capacity() + recentPostings_.capacity() ) * sizeof( TokenPosting );
+}
+
+SearchResultArray TokenIndex::find( uint64_t tokenHash ) const
+{
+    SearchResultArray lines;
+    addLines( postings_, tokenHash, lines );
+    addLines( recentPostings_, tokenHash, lines );
+    return lines;
+}
@@ -24,25 +24,64 @@
 #include <QMessageLogContext>
 #include <QString>
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <optional>
 #include <string>
 
 #include <cassert>
 
-#define LOG_IF_( severity )                                                                        \
-    if ( !logging::needLogging( severity ) ) {                                                     \
+// Messages with levels above this one are compiled out:
+// 1 - fatal, 2 - error, 3 - warning, 4 - info, 5 - debug
+#ifndef KLOGG_COMPILED_LOG_LEVEL
+#define KLOGG_COMPILED_LOG_LEVEL 5
+#endif
+
+#define LOG_IF_( severity, level )                                                                 \
+    if ( ( level ) > KLOGG_COMPILED_LOG_LEVEL || !logging::needLogging( severity ) ) {             \
         ;                                                                                          \
     }                                                                                              \
     else
 
-#define LOG_DEBUG LOG_IF_( QtDebugMsg ) qDebug().nospace()
-#define LOG_INFO LOG_IF_( QtInfoMsg ) qInfo().nospace()
-#define LOG_WARNING LOG_IF_( QtWarningMsg ) qWarning().nospace()
-#define LOG_ERROR LOG_IF_( QtCriticalMsg ) qCritical().nospace()
+#define LOG_DEBUG LOG_IF_( QtDebugMsg, 5 ) qDebug().nospace()
+#define LOG_INFO LOG_IF_( QtInfoMsg, 4 ) qInfo().nospace()
+#define LOG_WARNING LOG_IF_( QtWarningMsg, 3 ) qWarning().nospace()
+#define LOG_ERROR LOG_IF_( QtCriticalMsg, 2 ) qCritical().nospace()
+
+// Each call site gets its own limiter, messages over the limit are skipped
+// without being formatted.
+#define LOG_IF_LIMITED_( severity, level, messagesPerSecond )                                      \
+    LOG_IF_( severity, level )                                                                     \
+    if ( ![] {                                                                                     \
+             static logging::RateLimiter limiter{ messagesPerSecond };                            \
+             return limiter.allow();                                                               \
+         }() ) {                                                                                   \
+        ;                                                                                          \
+    }                                                                                              \
+    else
+
+#define LOG_DEBUG_LIMITED( messagesPerSecond )                                                     \
+    LOG_IF_LIMITED_( QtDebugMsg, 5, messagesPerSecond ) qDebug().nospace()
+#define LOG_INFO_LIMITED( messagesPerSecond )                                                      \
+    LOG_IF_LIMITED_( QtInfoMsg, 4, messagesPerSecond ) qInfo().nospace()
+#define LOG_WARNING_LIMITED( messagesPerSecond )                                                   \
+    LOG_IF_LIMITED_( QtWarningMsg, 3, messagesPerSecond ) qWarning().nospace()
 
 namespace logging {
 bool needLogging( QtMsgType type );
+
+class RateLimiter {
+  public:
+    explicit RateLimiter( uint32_t messagesPerSecond );
+
+    bool allow();
+
+  private:
+    const uint32_t messagesPerSecond_;
+    std::atomic<int64_t> windowStart_{ 0 };
+    std::atomic<uint32_t> messagesInWindow_{ 0 };
+};
 } // namespace logging
 
 template <typename T>
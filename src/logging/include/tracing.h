@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_TRACING_H
+#define KLOGG_TRACING_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <QString>
+
+// Records a span covering the rest of the enclosing scope.
+// Name must be a string literal, it is stored by pointer.
+#define KLOGG_TRACE_SCOPE( name ) KLOGG_TRACE_SCOPE_( name, __LINE__ )
+#define KLOGG_TRACE_SCOPE_( name, line ) KLOGG_TRACE_SCOPE__( name, line )
+#define KLOGG_TRACE_SCOPE__( name, line ) tracing::Span kloggTraceSpan##line{ name }
+
+namespace tracing {
+
+namespace detail {
+extern std::atomic<bool> isEnabled;
+
+int64_t now();
+void record( const char* name, int64_t start, int64_t end );
+} // namespace detail
+
+inline bool isEnabled()
+{
+    return detail::isEnabled.load( std::memory_order_relaxed );
+}
+
+// Spans are recorded only while tracing is enabled. Disabling
+// keeps already recorded spans until they are cleared.
+void setEnabled( bool enabled );
+
+// Drops all recorded spans, should not be called while tracing is enabled.
+void clear();
+
+// Writes recorded spans in Chrome trace event format
+// (chrome://tracing, https://ui.perfetto.dev).
+bool writeChromeTrace( const QString& fileName );
+
+class Span {
+  public:
+    explicit Span( const char* name )
+        : name_( name )
+        , start_( isEnabled() ? detail::now() : -1 )
+    {
+    }
+
+    ~Span()
+    {
+        if ( start_ >= 0 ) {
+            detail::record( name_, start_, detail::now() );
+        }
+    }
+
+    Span( const Span& ) = delete;
+    Span& operator=( const Span& ) = delete;
+
+  private:
+    const char* name_;
+    int64_t start_;
+};
+
+} // namespace tracing
+
+#endif
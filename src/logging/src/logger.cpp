@@ -21,25 +21,99 @@
 #include "log.h"
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
+#include <vector>
 
+#include <QByteArray>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
-#include <QTextStream>
 
 namespace logging {
 
-void kloggFileMessageHandler( QtMsgType type, const QMessageLogContext& context,
-                              const QString& msg );
-void kloggConsoleMessageHandler( QtMsgType type, const QMessageLogContext& context,
-                                 const QString& msg );
+void kloggMessageHandler( QtMsgType type, const QMessageLogContext& context, const QString& msg );
 void kloggNoopMessageHandler( QtMsgType, const QMessageLogContext&, const QString& ) {}
 
+namespace {
+
+// Bounded multi-producer single-consumer queue of formatted messages.
+// Producers never block, push fails when the queue is full.
+class MessageQueue {
+  public:
+    explicit MessageQueue( size_t capacity )
+        : slots_( capacity )
+        , mask_( capacity - 1 )
+    {
+        Q_ASSERT( ( capacity & mask_ ) == 0 );
+        for ( auto i = 0u; i < capacity; ++i ) {
+            slots_[ i ].sequence.store( i, std::memory_order_relaxed );
+        }
+    }
+
+    bool push( QByteArray&& message )
+    {
+        auto position = enqueuePosition_.load( std::memory_order_relaxed );
+        for ( ;; ) {
+            auto& slot = slots_[ position & mask_ ];
+            const auto sequence = slot.sequence.load( std::memory_order_acquire );
+            const auto difference
+                = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( position );
+
+            if ( difference == 0 ) {
+                if ( enqueuePosition_.compare_exchange_weak( position, position + 1,
+                                                             std::memory_order_relaxed ) ) {
+                    slot.message = std::move( message );
+                    slot.sequence.store( position + 1, std::memory_order_release );
+                    return true;
+                }
+            }
+            else if ( difference < 0 ) {
+                return false;
+            }
+            else {
+                position = enqueuePosition_.load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    // Must be called from one thread at a time
+    bool pop( QByteArray& message )
+    {
+        auto& slot = slots_[ dequeuePosition_ & mask_ ];
+        if ( slot.sequence.load( std::memory_order_acquire ) != dequeuePosition_ + 1 ) {
+            return false;
+        }
+
+        message = std::move( slot.message );
+        slot.message = QByteArray{};
+        slot.sequence.store( dequeuePosition_ + mask_ + 1, std::memory_order_release );
+        ++dequeuePosition_;
+        return true;
+    }
+
+  private:
+    struct Slot {
+        std::atomic<size_t> sequence{ 0 };
+        QByteArray message;
+    };
+
+    std::vector<Slot> slots_;
+    const size_t mask_;
+
+    alignas( 64 ) std::atomic<size_t> enqueuePosition_{ 0 };
+    alignas( 64 ) size_t dequeuePosition_{ 0 };
+};
+
+} // namespace
+
 class Logger {
   public:
     static Logger& instance()
@@ -48,73 +122,73 @@ class Logger {
         return l;
     }
 
-    void fileMessageHandler( QtMsgType type, const QMessageLogContext& context, const QString& msg )
+    ~Logger()
     {
-        if ( !needLogging( type ) ) {
-            return;
-        }
-        
-        const auto formattedMessage = qFormatLogMessage( type, context, msg );
-        const auto messageToPrint = formattedMessage.toUtf8();
-
-        ScopedLock lock( mutex_ );
-        QTextStream ts( logFile_.get() );
-        ts << messageToPrint << '\n';
-
-        if ( isConsoleLogEnabled_ ) {
-            std::cout << messageToPrint.constData() << std::endl;
-        }
+        stopWriter();
     }
 
-    void consoleMessageHandler( QtMsgType type, const QMessageLogContext& context,
-                                const QString& msg )
+    // Formats the message in the calling thread and hands it over to the writer thread.
+    void messageHandler( QtMsgType type, const QMessageLogContext& context, const QString& msg )
     {
         if ( !needLogging( type ) ) {
             return;
         }
 
-        const auto formattedMessage = qFormatLogMessage( type, context, msg );
-        const auto messageToPrint = formattedMessage.toUtf8();
+        auto messageToPrint = qFormatLogMessage( type, context, msg ).toUtf8();
+
+        if ( type == QtFatalMsg ) {
+            // Application is going to abort, write everything right now
+            stopWriter();
+            writeQueuedMessages();
+            writeMessage( messageToPrint );
+            flushSinks();
+            return;
+        }
 
-        ScopedLock lock( mutex_ );
-        std::cout << messageToPrint.constData() << std::endl;
+        if ( !queue_.push( std::move( messageToPrint ) ) ) {
+            droppedMessages_.fetch_add( 1, std::memory_order_relaxed );
+        }
     }
 
     void enableLogging( bool isEnabled, uint8_t logLevel )
     {
-        ScopedLock lock( mutex_ );
+        {
+            ScopedLock lock( mutex_ );
 
-        qSetMessagePattern( "%{time} %{type} [%{threadid}] [%{function}@%{line}] %{message}" );
+            qSetMessagePattern( "%{time} %{type} [%{threadid}] [%{function}@%{line}] %{message}" );
 
-        isConsoleLogEnabled_ = isEnabled;
-        logLevel_ = logLevel;
+            isConsoleLogEnabled_ = isEnabled;
+            logLevel_ = logLevel;
+        }
 
         setMessageHandler();
     }
 
     void enableFileLogging( bool isEnabled, uint8_t logLevel )
     {
-        ScopedLock lock( mutex_ );
+        {
+            ScopedLock lock( mutex_ );
 
-        qSetMessagePattern( "%{time} %{type} [%{threadid}] [%{function}@%{line}] %{message}" );
+            qSetMessagePattern( "%{time} %{type} [%{threadid}] [%{function}@%{line}] %{message}" );
 
-        isFileLogEnabled_ = isEnabled;
-        logLevel_ = logLevel;
+            isFileLogEnabled_ = isEnabled;
+            logLevel_ = logLevel;
 
-        if ( isEnabled && !logFile_ ) {
-            auto logFileName
-                = QString( "klogg_%1_%2.log" )
-                      .arg( QDateTime::currentDateTime().toString( "yyyy-MM-dd_HH-mm-ss" ) )
-                      .arg( QCoreApplication::applicationPid() );
+            if ( isEnabled && !logFile_ ) {
+                auto logFileName
+                    = QString( "klogg_%1_%2.log" )
+                          .arg( QDateTime::currentDateTime().toString( "yyyy-MM-dd_HH-mm-ss" ) )
+                          .arg( QCoreApplication::applicationPid() );
 
-            logFile_ = std::make_unique<QFile>( QDir::temp().filePath( logFileName ) );
-            if ( !logFile_->open( QIODevice::WriteOnly | QIODevice::Append ) ) {
+                logFile_ = std::make_unique<QFile>( QDir::temp().filePath( logFileName ) );
+                if ( !logFile_->open( QIODevice::WriteOnly | QIODevice::Append ) ) {
+                    logFile_.reset();
+                }
+            }
+            else if ( !isEnabled && logFile_ ) {
                 logFile_.reset();
             }
         }
-        else if ( !isEnabled && logFile_ ) {
-            logFile_.reset();
-        }
 
         setMessageHandler();
     }
@@ -133,18 +207,107 @@ class Logger {
     }
 
   private:
-    Logger() = default;
+    Logger()
+        : queue_( QueueCapacity )
+    {
+    }
 
     void setMessageHandler()
     {
         if ( !isAnyEnabled() ) {
             qInstallMessageHandler( logging::kloggNoopMessageHandler );
         }
-        else if ( logFile_ ) {
-            qInstallMessageHandler( logging::kloggFileMessageHandler );
-        }
         else {
-            qInstallMessageHandler( logging::kloggConsoleMessageHandler );
+            startWriter();
+            qInstallMessageHandler( logging::kloggMessageHandler );
+        }
+    }
+
+    void startWriter()
+    {
+        std::unique_lock<std::mutex> lock( writerMutex_ );
+        if ( writer_.joinable() ) {
+            return;
+        }
+
+        stopRequested_ = false;
+        writer_ = std::thread( [ this ] { writerLoop(); } );
+    }
+
+    void stopWriter()
+    {
+        std::unique_lock<std::mutex> lock( writerMutex_ );
+        if ( !writer_.joinable() || writer_.get_id() == std::this_thread::get_id() ) {
+            return;
+        }
+
+        {
+            std::unique_lock<std::mutex> wakeupLock( wakeupMutex_ );
+            stopRequested_ = true;
+        }
+        writerWakeup_.notify_one();
+        writer_.join();
+    }
+
+    void writerLoop()
+    {
+        while ( !stopRequested_ ) {
+            if ( !writeQueuedMessages() ) {
+                std::unique_lock<std::mutex> lock( wakeupMutex_ );
+                writerWakeup_.wait_for( lock, WriterPollInterval,
+                                        [ this ] { return stopRequested_.load(); } );
+            }
+        }
+
+        writeQueuedMessages();
+    }
+
+    // Returns false if there was nothing to write
+    bool writeQueuedMessages()
+    {
+        SharedLock lock( mutex_ );
+
+        bool hasWritten = false;
+        QByteArray message;
+        while ( queue_.pop( message ) ) {
+            writeMessage( message );
+            hasWritten = true;
+        }
+
+        if ( const auto dropped = droppedMessages_.exchange( 0, std::memory_order_relaxed ) ) {
+            writeMessage( QByteArray::number( static_cast<qulonglong>( dropped ) )
+                          + " log messages dropped" );
+            hasWritten = true;
+        }
+
+        if ( hasWritten ) {
+            flushSinks();
+        }
+
+        return hasWritten;
+    }
+
+    void writeMessage( const QByteArray& message )
+    {
+        if ( logFile_ ) {
+            logFile_->write( message );
+            logFile_->write( "\n", 1 );
+        }
+
+        if ( isConsoleLogEnabled_ ) {
+            std::cout.write( message.constData(), message.size() );
+            std::cout.put( '\n' );
+        }
+    }
+
+    void flushSinks()
+    {
+        if ( logFile_ ) {
+            logFile_->flush();
+        }
+
+        if ( isConsoleLogEnabled_ ) {
+            std::cout.flush();
         }
     }
 
@@ -170,8 +333,13 @@ class Logger {
     }
 
   private:
+    static constexpr size_t QueueCapacity = 16384;
+    static constexpr std::chrono::milliseconds WriterPollInterval{ 10 };
+
+    // Protects sinks configuration, shared by the writer
     mutable std::shared_mutex mutex_;
     using ScopedLock = std::unique_lock<std::shared_mutex>;
+    using SharedLock = std::shared_lock<std::shared_mutex>;
 
     std::atomic_bool isConsoleLogEnabled_ = false;
     std::atomic_bool isFileLogEnabled_ = false;
@@ -179,6 +347,16 @@ class Logger {
     std::atomic_int logLevel_ = 0;
 
     std::unique_ptr<QFile> logFile_;
+
+    MessageQueue queue_;
+    std::atomic<uint64_t> droppedMessages_{ 0 };
+
+    // Guards starting and stopping of the writer thread
+    std::mutex writerMutex_;
+    std::mutex wakeupMutex_;
+    std::condition_variable writerWakeup_;
+    std::atomic_bool stopRequested_{ false };
+    std::thread writer_;
 };
 
 void enableLogging( bool isEnabled, LogLevel logLevel )
@@ -191,21 +369,35 @@ void enableFileLogging( bool isEnabled, LogLevel logLevel )
     Logger::instance().enableFileLogging( isEnabled, static_cast<uint8_t>( logLevel ) );
 }
 
-void kloggFileMessageHandler( QtMsgType type, const QMessageLogContext& context,
-                              const QString& msg )
+void kloggMessageHandler( QtMsgType type, const QMessageLogContext& context, const QString& msg )
 {
-    Logger::instance().fileMessageHandler( type, context, msg );
+    Logger::instance().messageHandler( type, context, msg );
 }
 
-void kloggConsoleMessageHandler( QtMsgType type, const QMessageLogContext& context,
-                                 const QString& msg )
+bool needLogging( QtMsgType type )
 {
-    Logger::instance().consoleMessageHandler( type, context, msg );
+    return Logger::instance().needLogging( type );
 }
 
-bool needLogging( QtMsgType type )
+RateLimiter::RateLimiter( uint32_t messagesPerSecond )
+    : messagesPerSecond_( messagesPerSecond )
 {
-    return Logger::instance().needLogging( type );
 }
 
-} // namespace logging
\ No newline at end of file
+bool RateLimiter::allow()
+{
+    using namespace std::chrono;
+    const auto now
+        = duration_cast<milliseconds>( steady_clock::now().time_since_epoch() ).count();
+
+    auto windowStart = windowStart_.load( std::memory_order_relaxed );
+    if ( now - windowStart >= 1000
+         && windowStart_.compare_exchange_strong( windowStart, now,
+                                                  std::memory_order_relaxed ) ) {
+        messagesInWindow_.store( 0, std::memory_order_relaxed );
+    }
+
+    return messagesInWindow_.fetch_add( 1, std::memory_order_relaxed ) < messagesPerSecond_;
+}
+
+} // namespace logging
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracing.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QSaveFile>
+#include <QThread>
+
+#include "log.h"
+
+namespace tracing {
+
+namespace detail {
+std::atomic<bool> isEnabled{ false };
+} // namespace detail
+
+namespace {
+
+struct Event {
+    const char* name;
+    int64_t start;
+    int64_t end;
+};
+
+constexpr size_t EventsPerBlock = 16 * 1024;
+constexpr size_t MaxBlocks = 256;
+
+// Events of one thread. Only the owning thread appends, export reads
+// events published before the size was stored.
+class ThreadBuffer {
+  public:
+    ThreadBuffer( uint32_t id, QString name )
+        : id_( id )
+        , name_( std::move( name ) )
+    {
+    }
+
+    ~ThreadBuffer()
+    {
+        for ( auto& block : blocks_ ) {
+            delete[] block.load( std::memory_order_relaxed );
+        }
+    }
+
+    ThreadBuffer( const ThreadBuffer& ) = delete;
+    ThreadBuffer& operator=( const ThreadBuffer& ) = delete;
+
+    void record( const Event& event )
+    {
+        const auto size = size_.load( std::memory_order_relaxed );
+        const auto blockIndex = size / EventsPerBlock;
+        if ( blockIndex >= MaxBlocks ) {
+            dropped_.fetch_add( 1, std::memory_order_relaxed );
+            return;
+        }
+
+        auto* block = blocks_[ blockIndex ].load( std::memory_order_relaxed );
+        if ( block == nullptr ) {
+            block = new Event[ EventsPerBlock ];
+            blocks_[ blockIndex ].store( block, std::memory_order_release );
+        }
+
+        block[ size % EventsPerBlock ] = event;
+        size_.store( size + 1, std::memory_order_release );
+    }
+
+    template <typename Function>
+    void forEach( Function&& function ) const
+    {
+        const auto size = size_.load( std::memory_order_acquire );
+        for ( auto i = 0u; i < size; ++i ) {
+            const auto* block = blocks_[ i / EventsPerBlock ].load( std::memory_order_acquire );
+            function( block[ i % EventsPerBlock ] );
+        }
+    }
+
+    void clear()
+    {
+        size_.store( 0, std::memory_order_release );
+        dropped_.store( 0, std::memory_order_relaxed );
+    }
+
+    uint32_t id() const
+    {
+        return id_;
+    }
+
+    const QString& name() const
+    {
+        return name_;
+    }
+
+    uint64_t dropped() const
+    {
+        return dropped_.load( std::memory_order_relaxed );
+    }
+
+  private:
+    const uint32_t id_;
+    const QString name_;
+
+    std::array<std::atomic<Event*>, MaxBlocks> blocks_{};
+    std::atomic<size_t> size_{ 0 };
+    std::atomic<uint64_t> dropped_{ 0 };
+};
+
+class Registry {
+  public:
+    ThreadBuffer* registerThread()
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        const auto id = static_cast<uint32_t>( buffers_.size() + 1 );
+
+        auto* thread = QThread::currentThread();
+        auto name = thread != nullptr ? thread->objectName() : QString{};
+        if ( QCoreApplication::instance() != nullptr
+             && QCoreApplication::instance()->thread() == thread ) {
+            name = "main";
+        }
+        else if ( name.isEmpty() ) {
+            name = QString( "thread %1" ).arg( id );
+        }
+
+        buffers_.push_back( std::make_unique<ThreadBuffer>( id, std::move( name ) ) );
+        return buffers_.back().get();
+    }
+
+    template <typename Function>
+    void forEach( Function&& function ) const
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        for ( const auto& buffer : buffers_ ) {
+            function( *buffer );
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        for ( auto& buffer : buffers_ ) {
+            buffer->clear();
+        }
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+};
+
+// Never destroyed, threads can still record while static objects are destroyed
+Registry& registry()
+{
+    static auto* registry = new Registry;
+    return *registry;
+}
+
+const auto traceEpoch = std::chrono::steady_clock::now();
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+} // namespace
+
+namespace detail {
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - traceEpoch )
+        .count();
+}
+
+void record( const char* name, int64_t start, int64_t end )
+{
+    if ( threadBuffer == nullptr ) {
+        threadBuffer = registry().registerThread();
+    }
+
+    threadBuffer->record( { name, start, end } );
+}
+} // namespace detail
+
+void setEnabled( bool enabled )
+{
+    LOG_INFO << "Performance tracing " << ( enabled ? "enabled" : "disabled" );
+    detail::isEnabled.store( enabled, std::memory_order_relaxed );
+}
+
+void clear()
+{
+    registry().clear();
+}
+
+bool writeChromeTrace( const QString& fileName )
+{
+    QSaveFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        LOG_ERROR << "Failed to open trace file " << fileName << ": " << file.errorString();
+        return false;
+    }
+
+    constexpr int FlushSize = 1024 * 1024;
+
+    QByteArray buffer;
+    buffer.reserve( FlushSize + 1024 );
+    buffer.append( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" );
+
+    auto isFirstEvent = true;
+    auto appendEvent = [ &buffer, &isFirstEvent ]( const char* event ) {
+        if ( !isFirstEvent ) {
+            buffer.append( ",\n" );
+        }
+        isFirstEvent = false;
+        buffer.append( event );
+    };
+
+    size_t eventsCount = 0;
+    uint64_t droppedCount = 0;
+
+    registry().forEach( [ & ]( const ThreadBuffer& threadBuffer ) {
+        droppedCount += threadBuffer.dropped();
+
+        std::array<char, 512> event;
+        std::snprintf( event.data(), event.size(),
+                       "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+                       "\"args\":{\"name\":\"%s\"}}",
+                       threadBuffer.id(),
+                       threadBuffer.name().toUtf8().replace( '"', '\'' ).constData() );
+        appendEvent( event.data() );
+
+        threadBuffer.forEach( [ & ]( const Event& span ) {
+            // Timestamps are in microseconds
+            std::snprintf( event.data(), event.size(),
+                           "{\"name\":\"%s\",\"cat\":\"klogg\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                           "\"ts\":%.3f,\"dur\":%.3f}",
+                           span.name, threadBuffer.id(), static_cast<double>( span.start ) / 1000,
+                           static_cast<double>( span.end - span.start ) / 1000 );
+            appendEvent( event.data() );
+            ++eventsCount;
+
+            if ( buffer.size() > FlushSize ) {
+                file.write( buffer );
+                buffer.clear();
+            }
+        } );
+    } );
+
+    buffer.append( "]}\n" );
+    file.write( buffer );
+
+    if ( !file.commit() ) {
+        LOG_ERROR << "Failed to write trace file " << fileName << ": " << file.errorString();
+        return false;
+    }
+
+    LOG_INFO << "Written " << eventsCount << " trace events to " << fileName;
+    if ( droppedCount > 0 ) {
+        LOG_WARNING << droppedCount << " trace events were dropped";
+    }
+
+    return true;
+}
+
+} // namespace tracing
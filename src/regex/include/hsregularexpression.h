@@ -36,13 +36,13 @@
 #ifdef KLOGG_HAS_HS
 #include <hs.h>
 
+#include "memorygovernor.h"
 #include "resourcewrapper.h"
 #endif
 
+#include "literalmatcher.h"
 #include "regularexpressionpattern.h"
 
-using MatchedPatterns = std::string;
-
 class DefaultRegularExpressionMatcher {
   public:
     explicit DefaultRegularExpressionMatcher(
@@ -105,6 +105,9 @@ class HsMatcher {
     HsScratch scratch_;
 
     mutable HsMatcherContext context_;
+
+  private:
+    MemoryReservation scratchMemory_;
 };
 
 class HsSingleMatcher : public HsMatcher {
@@ -128,8 +131,8 @@ class HsNoopMatcher {
     MatchedPatterns match( const std::string_view& utf8Data ) const;
 };
 
-using MatcherVariant
-    = std::variant<DefaultRegularExpressionMatcher, HsNoopMatcher, HsSingleMatcher, HsMultiMatcher>;
+using MatcherVariant = std::variant<DefaultRegularExpressionMatcher, HsNoopMatcher, HsSingleMatcher,
+                                    HsMultiMatcher, LiteralMatcher>;
 
 class HsRegularExpression {
   public:
@@ -154,6 +157,7 @@ class HsRegularExpression {
   private:
     HsDatabase database_;
     HsScratch scratch_;
+    MemoryReservation memory_;
 
     klogg::vector<RegularExpressionPattern> patterns_;
 
@@ -162,7 +166,7 @@ class HsRegularExpression {
 };
 #else
 
-using MatcherVariant = std::variant<DefaultRegularExpressionMatcher>;
+using MatcherVariant = std::variant<DefaultRegularExpressionMatcher, LiteralMatcher>;
 
 class HsRegularExpression {
   public:
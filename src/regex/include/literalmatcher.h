@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LITERAL_MATCHER_H
+#define KLOGG_LITERAL_MATCHER_H
+
+#include <string>
+#include <string_view>
+
+#include "containers.h"
+
+#include "regularexpressionpattern.h"
+
+using MatchedPatterns = std::string;
+
+// Substring search for patterns without regular expression syntax,
+// plain text or regular expressions made of literal characters only.
+// Case insensitive search folds ASCII letters only, so patterns with
+// other letters are left to regular expression engines.
+class LiteralMatcher {
+  public:
+    explicit LiteralMatcher( const klogg::vector<RegularExpressionPattern>& patterns );
+
+    // True if the pattern matches the same lines as a substring search
+    static bool isLiteral( const RegularExpressionPattern& pattern );
+    static bool areLiterals( const klogg::vector<RegularExpressionPattern>& patterns );
+
+    MatchedPatterns match( const std::string_view& utf8Data ) const;
+
+  private:
+    struct Literal {
+        // Lower case for case insensitive search
+        std::string text;
+        bool isCaseSensitive = true;
+    };
+
+    klogg::vector<Literal> literals_;
+};
+
+#endif
@@ -59,6 +59,31 @@ int matchMultiCallback( unsigned int id, unsigned long long from, unsigned long
     return 0;
 }
 
+const MemoryRegistration& hsMemory()
+{
+    static const auto registration = MemoryGovernor::instance().registerConsumer(
+        "Hyperscan scratch", MemoryShedPriority::RegexScratch );
+    return registration;
+}
+
+uint64_t scratchSize( const hs_scratch_t* scratch )
+{
+    size_t size = 0;
+    if ( scratch == nullptr || hs_scratch_size( scratch, &size ) != HS_SUCCESS ) {
+        return 0;
+    }
+    return size;
+}
+
+uint64_t databaseSize( const hs_database_t* database )
+{
+    size_t size = 0;
+    if ( database == nullptr || hs_database_size( database, &size ) != HS_SUCCESS ) {
+        return 0;
+    }
+    return size;
+}
+
 } // namespace
 
 HsMatcherContext::HsMatcherContext( std::size_t numberOfPatterns )
@@ -76,6 +101,7 @@ HsMatcher::HsMatcher( HsDatabase db, HsScratch scratch, std::size_t numberOfPatt
     : database_{ std::move( db ) }
     , scratch_{ std::move( scratch ) }
     , context_( numberOfPatterns )
+    , scratchMemory_( hsMemory().reserve( scratchSize( scratch_.get() ) ) )
 {
 }
 
@@ -196,6 +222,8 @@ HsRegularExpression::HsRegularExpression( const klogg::vector<RegularExpressionP
             database_.get() );
     }
 
+    memory_ = hsMemory().reserve( databaseSize( database_.get() ) + scratchSize( scratch_.get() ) );
+
     if ( !isHsValid() ) {
         for ( const auto& pattern : patterns_ ) {
             const auto regex = static_cast<QRegularExpression>( pattern );
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "literalmatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define KLOGG_LITERAL_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#include <QString>
+
+namespace {
+
+#ifdef KLOGG_LITERAL_SSE2
+unsigned countTrailingZeros( unsigned mask )
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward( &index, mask );
+    return static_cast<unsigned>( index );
+#else
+    return static_cast<unsigned>( __builtin_ctz( mask ) );
+#endif
+}
+#endif
+
+char toLowerAscii( char c )
+{
+    return ( c >= 'A' && c <= 'Z' ) ? static_cast<char>( c - 'A' + 'a' ) : c;
+}
+
+char toUpperAscii( char c )
+{
+    return ( c >= 'a' && c <= 'z' ) ? static_cast<char>( c - 'a' + 'A' ) : c;
+}
+
+bool isAscii( const QString& text )
+{
+    return std::all_of( text.cbegin(), text.cend(),
+                        []( const QChar& c ) { return c.unicode() < 0x80; } );
+}
+
+// Text matched by the pattern, nothing if it has regular expression syntax
+std::optional<QString> literalText( const RegularExpressionPattern& pattern )
+{
+    if ( pattern.isPlainText ) {
+        return pattern.pattern;
+    }
+
+    static const auto MetaCharacters = QStringLiteral( "\\^$.|?*+()[]{}" );
+
+    const auto& expression = pattern.pattern;
+
+    QString text;
+    text.reserve( expression.size() );
+    for ( auto i = 0; i < expression.size(); ++i ) {
+        const auto c = expression[ i ];
+        if ( c == QChar( '\\' ) ) {
+            // Escaped punctuation is literal, escaped letters are classes or anchors
+            if ( i + 1 == expression.size() ) {
+                return {};
+            }
+
+            const auto escaped = expression[ ++i ];
+            if ( escaped.unicode() >= 0x80 || escaped.isLetterOrNumber() ) {
+                return {};
+            }
+            text.append( escaped );
+        }
+        else if ( MetaCharacters.contains( c ) ) {
+            return {};
+        }
+        else {
+            text.append( c );
+        }
+    }
+
+    return text;
+}
+
+template <bool IsCaseSensitive> bool bytesEqual( const char* data, const char* literal, size_t size )
+{
+    if constexpr ( IsCaseSensitive ) {
+        return std::memcmp( data, literal, size ) == 0;
+    }
+    else {
+        for ( size_t i = 0; i < size; ++i ) {
+            if ( toLowerAscii( data[ i ] ) != literal[ i ] ) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+// Candidates are filtered by the first and the last byte of the literal
+// for 16 positions at once, then the bytes between them are compared
+template <bool IsCaseSensitive>
+bool containsLiteral( std::string_view data, std::string_view literal )
+{
+    const auto size = literal.size();
+    if ( size == 0 ) {
+        return true;
+    }
+    if ( data.size() < size ) {
+        return false;
+    }
+
+    const auto* middle = literal.data() + 1;
+    const auto middleSize = size > 2 ? size - 2 : 0;
+
+    size_t position = 0;
+
+#ifdef KLOGG_LITERAL_SSE2
+    // Same bytes twice for case sensitive search
+    const auto first = _mm_set1_epi8( literal.front() );
+    const auto last = _mm_set1_epi8( literal.back() );
+    const auto firstOtherCase
+        = _mm_set1_epi8( IsCaseSensitive ? literal.front() : toUpperAscii( literal.front() ) );
+    const auto lastOtherCase
+        = _mm_set1_epi8( IsCaseSensitive ? literal.back() : toUpperAscii( literal.back() ) );
+
+    const auto* lastBytes = data.data() + size - 1;
+
+    constexpr size_t bytesPerBlock = sizeof( __m128i );
+    for ( ; position + size - 1 + bytesPerBlock <= data.size(); position += bytesPerBlock ) {
+        const auto firstBlock
+            = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data.data() + position ) );
+        const auto lastBlock
+            = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lastBytes + position ) );
+
+        const auto firstMatches = _mm_or_si128( _mm_cmpeq_epi8( firstBlock, first ),
+                                                _mm_cmpeq_epi8( firstBlock, firstOtherCase ) );
+        const auto lastMatches = _mm_or_si128( _mm_cmpeq_epi8( lastBlock, last ),
+                                               _mm_cmpeq_epi8( lastBlock, lastOtherCase ) );
+
+        auto mask
+            = static_cast<unsigned>( _mm_movemask_epi8( _mm_and_si128( firstMatches, lastMatches ) ) );
+        while ( mask != 0 ) {
+            const auto candidate = position + countTrailingZeros( mask );
+            if ( bytesEqual<IsCaseSensitive>( data.data() + candidate + 1, middle, middleSize ) ) {
+                return true;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    if constexpr ( IsCaseSensitive ) {
+        return data.find( literal, position ) != std::string_view::npos;
+    }
+    else {
+        for ( ; position + size <= data.size(); ++position ) {
+            if ( bytesEqual<false>( data.data() + position, literal.data(), size ) ) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+} // namespace
+
+LiteralMatcher::LiteralMatcher( const klogg::vector<RegularExpressionPattern>& patterns )
+{
+    literals_.reserve( patterns.size() );
+    for ( const auto& pattern : patterns ) {
+        Literal literal;
+        literal.isCaseSensitive = pattern.isCaseSensitive;
+        literal.text = literalText( pattern ).value_or( QString{} ).toStdString();
+        if ( !literal.isCaseSensitive ) {
+            std::transform( literal.text.begin(), literal.text.end(), literal.text.begin(),
+                            toLowerAscii );
+        }
+        literals_.push_back( std::move( literal ) );
+    }
+}
+
+bool LiteralMatcher::isLiteral( const RegularExpressionPattern& pattern )
+{
+    const auto text = literalText( pattern );
+    return text.has_value() && ( pattern.isCaseSensitive || isAscii( *text ) );
+}
+
+bool LiteralMatcher::areLiterals( const klogg::vector<RegularExpressionPattern>& patterns )
+{
+    return !patterns.empty() && std::all_of( patterns.cbegin(), patterns.cend(), isLiteral );
+}
+
+MatchedPatterns LiteralMatcher::match( const std::string_view& utf8Data ) const
+{
+    MatchedPatterns matchedPatterns( literals_.size(), 0 );
+    std::transform( literals_.cbegin(), literals_.cend(), matchedPatterns.begin(),
+                    [ utf8Data ]( const auto& literal ) {
+                        return literal.isCaseSensitive
+                                   ? containsLiteral<true>( utf8Data, literal.text )
+                                   : containsLiteral<false>( utf8Data, literal.text );
+                    } );
+
+    return matchedPatterns;
+}
@@ -188,11 +188,16 @@ PatternMatcher::PatternMatcher( const RegularExpression& expression )
     : isInverse_( expression.isInverse_ )
     , isBooleanCombination_( expression.isBooleanCombination_ )
     , mainPatternId_( expression.subPatterns_.front().id() )
-    , matcher_( expression.hsExpression_.createMatcher() )
+    , matcher_( LiteralMatcher::areLiterals( expression.subPatterns_ )
+                    ? MatcherVariant{ LiteralMatcher( expression.subPatterns_ ) }
+                    : expression.hsExpression_.createMatcher() )
 {
+    // Substring search is faster than both engines for literal patterns
+    const auto isLiteral = std::holds_alternative<LiteralMatcher>( matcher_ );
+
     const auto& config = Configuration::get();
     const auto useHyperscanEngine = config.regexpEngine() == RegexpEngine::Hyperscan;
-    if ( !useHyperscanEngine ) {
+    if ( !useHyperscanEngine && !isLiteral ) {
         matcher_ = DefaultRegularExpressionMatcher( expression.subPatterns_ );
     }
 
@@ -57,6 +57,9 @@ enum class SearchRegexpType {
 };
 
 enum class RegexpEngine { Hyperscan, QRegularExpression };
+
+// What indexing and search leave in page cache after reading a file
+enum class PageCachePolicy { Auto, KeepCached, DropAfterScan };
 static constexpr int MAX_RECENT_FILES = 25;
 
 // Configuration class containing everything in the "Settings" dialog
@@ -207,6 +210,30 @@ class Configuration final : public Persistable<Configuration> {
     {
         indexReadBufferSizeMb_ = bufferSizeMb;
     }
+    int ioQueueDepth() const
+    {
+        return ioQueueDepth_;
+    }
+    void setIoQueueDepth( int queueDepth )
+    {
+        ioQueueDepth_ = queueDepth;
+    }
+    PageCachePolicy pageCachePolicy() const
+    {
+        return pageCachePolicy_;
+    }
+    void setPageCachePolicy( PageCachePolicy policy )
+    {
+        pageCachePolicy_ = policy;
+    }
+    bool directIndexReads() const
+    {
+        return directIndexReads_;
+    }
+    void setDirectIndexReads( bool directIndexReads )
+    {
+        directIndexReads_ = directIndexReads;
+    }
     int searchReadBufferSizeLines() const
     {
         return searchReadBufferSizeLines_;
@@ -239,6 +266,94 @@ class Configuration final : public Persistable<Configuration> {
     {
         useCompressedIndex_ = useCompressedIndex;
     }
+    bool indexLineHashes() const
+    {
+        return indexLineHashes_;
+    }
+    void setIndexLineHashes( bool indexLineHashes )
+    {
+        indexLineHashes_ = indexLineHashes;
+    }
+    bool indexLogLevels() const
+    {
+        return indexLogLevels_;
+    }
+    void setIndexLogLevels( bool indexLogLevels )
+    {
+        indexLogLevels_ = indexLogLevels;
+    }
+    // Number of bytes from the line start searched for the level keyword
+    int logLevelSearchDepth() const
+    {
+        return logLevelSearchDepth_;
+    }
+    void setLogLevelSearchDepth( int logLevelSearchDepth )
+    {
+        logLevelSearchDepth_ = logLevelSearchDepth;
+    }
+    // Regular expression locating the level keyword in the log format,
+    // empty pattern searches for any keyword within the search depth
+    QString logLevelPattern() const
+    {
+        return logLevelPattern_;
+    }
+    void setLogLevelPattern( const QString& logLevelPattern )
+    {
+        logLevelPattern_ = logLevelPattern;
+    }
+    // Lines longer than the split size are indexed as several lines
+    bool splitLongLines() const
+    {
+        return splitLongLines_;
+    }
+    void setSplitLongLines( bool splitLongLines )
+    {
+        splitLongLines_ = splitLongLines;
+    }
+    int longLineSplitSizeKb() const
+    {
+        return longLineSplitSizeKb_;
+    }
+    void setLongLineSplitSizeKb( int longLineSplitSizeKb )
+    {
+        longLineSplitSizeKb_ = longLineSplitSizeKb;
+    }
+    bool detectBinaryContent() const
+    {
+        return detectBinaryContent_;
+    }
+    void setDetectBinaryContent( bool detectBinaryContent )
+    {
+        detectBinaryContent_ = detectBinaryContent;
+    }
+    // Regular expression matching the first line of a multi-line record,
+    // empty pattern disables record indexing
+    QString recordStartPattern() const
+    {
+        return recordStartPattern_;
+    }
+    void setRecordStartPattern( const QString& recordStartPattern )
+    {
+        recordStartPattern_ = recordStartPattern;
+    }
+    // Empty pattern disables the token index
+    QString tokenIndexPattern() const
+    {
+        return tokenIndexPattern_;
+    }
+    void setTokenIndexPattern( const QString& tokenIndexPattern )
+    {
+        tokenIndexPattern_ = tokenIndexPattern;
+    }
+    // 0 means no limit
+    int memoryBudgetMb() const
+    {
+        return memoryBudgetMb_;
+    }
+    void setMemoryBudgetMb( int budgetMb )
+    {
+        memoryBudgetMb_ = budgetMb;
+    }
 
     RegexpEngine regexpEngine() const
     {
@@ -558,9 +673,22 @@ class Configuration final : public Persistable<Configuration> {
     bool useParallelSearch_ = true;
     int indexReadBufferSizeMb_ = 16;
     int searchReadBufferSizeLines_ = 10000;
+    int ioQueueDepth_ = 4;
+    PageCachePolicy pageCachePolicy_ = PageCachePolicy::Auto;
+    bool directIndexReads_ = false;
     int searchThreadPoolSize_ = 0;
     bool keepFileClosed_ = false;
     bool useCompressedIndex_ = true;
+    bool indexLineHashes_ = false;
+    QString tokenIndexPattern_;
+    bool indexLogLevels_ = false;
+    int logLevelSearchDepth_ = 64;
+    QString logLevelPattern_;
+    QString recordStartPattern_;
+    bool splitLongLines_ = false;
+    int longLineSplitSizeKb_ = 1024;
+    bool detectBinaryContent_ = true;
+    int memoryBudgetMb_ = 0;
 
     bool enableLogging_ = false;
     int loggingLevel_ = 4;
@@ -235,6 +235,16 @@ void Configuration::retrieveFromStorage( QSettings& settings )
         = settings
               .value( "perf.indexReadBufferSizeMb", DefaultConfiguration.indexReadBufferSizeMb_ )
               .toInt();
+    ioQueueDepth_
+        = settings.value( "perf.ioQueueDepth", DefaultConfiguration.ioQueueDepth_ ).toInt();
+    pageCachePolicy_ = static_cast<PageCachePolicy>(
+        settings
+            .value( "perf.pageCachePolicy",
+                    static_cast<int>( DefaultConfiguration.pageCachePolicy_ ) )
+            .toInt() );
+    directIndexReads_
+        = settings.value( "perf.directIndexReads", DefaultConfiguration.directIndexReads_ )
+              .toBool();
     searchReadBufferSizeLines_ = settings
                                      .value( "perf.searchReadBufferSizeLines",
                                              DefaultConfiguration.searchReadBufferSizeLines_ )
@@ -253,6 +263,32 @@ void Configuration::retrieveFromStorage( QSettings& settings )
     useCompressedIndex_
         = settings.value( "perf.useCompressedIndex", DefaultConfiguration.useCompressedIndex_ )
               .toBool();
+    indexLineHashes_
+        = settings.value( "perf.indexLineHashes", DefaultConfiguration.indexLineHashes_ ).toBool();
+    indexLogLevels_
+        = settings.value( "perf.indexLogLevels", DefaultConfiguration.indexLogLevels_ ).toBool();
+    logLevelSearchDepth_
+        = settings.value( "perf.logLevelSearchDepth", DefaultConfiguration.logLevelSearchDepth_ )
+              .toInt();
+    logLevelPattern_
+        = settings.value( "perf.logLevelPattern", DefaultConfiguration.logLevelPattern_ )
+              .toString();
+    splitLongLines_
+        = settings.value( "perf.splitLongLines", DefaultConfiguration.splitLongLines_ ).toBool();
+    longLineSplitSizeKb_
+        = settings.value( "perf.longLineSplitSizeKb", DefaultConfiguration.longLineSplitSizeKb_ )
+              .toInt();
+    detectBinaryContent_
+        = settings.value( "perf.detectBinaryContent", DefaultConfiguration.detectBinaryContent_ )
+              .toBool();
+    recordStartPattern_
+        = settings.value( "perf.recordStartPattern", DefaultConfiguration.recordStartPattern_ )
+              .toString();
+    tokenIndexPattern_
+        = settings.value( "perf.tokenIndexPattern", DefaultConfiguration.tokenIndexPattern_ )
+              .toString();
+    memoryBudgetMb_
+        = settings.value( "perf.memoryBudgetMb", DefaultConfiguration.memoryBudgetMb_ ).toInt();
 
     verifySslPeers_
         = settings.value( "net.verifySslPeers", DefaultConfiguration.verifySslPeers_ ).toBool();
@@ -391,9 +427,22 @@ void Configuration::saveToStorage( QSettings& settings ) const
     settings.setValue( "perf.searchResultsCacheLines", searchResultsCacheLines_ );
     settings.setValue( "perf.indexReadBufferSizeMb", indexReadBufferSizeMb_ );
     settings.setValue( "perf.searchReadBufferSizeLines", searchReadBufferSizeLines_ );
+    settings.setValue( "perf.ioQueueDepth", ioQueueDepth_ );
+    settings.setValue( "perf.pageCachePolicy", static_cast<int>( pageCachePolicy_ ) );
+    settings.setValue( "perf.directIndexReads", directIndexReads_ );
     settings.setValue( "perf.searchThreadPoolSize", searchThreadPoolSize_ );
     settings.setValue( "perf.keepFileClosed", keepFileClosed_ );
     settings.setValue( "perf.useCompressedIndex", useCompressedIndex_ );
+    settings.setValue( "perf.indexLineHashes", indexLineHashes_ );
+    settings.setValue( "perf.indexLogLevels", indexLogLevels_ );
+    settings.setValue( "perf.logLevelSearchDepth", logLevelSearchDepth_ );
+    settings.setValue( "perf.logLevelPattern", logLevelPattern_ );
+    settings.setValue( "perf.splitLongLines", splitLongLines_ );
+    settings.setValue( "perf.longLineSplitSizeKb", longLineSplitSizeKb_ );
+    settings.setValue( "perf.detectBinaryContent", detectBinaryContent_ );
+    settings.setValue( "perf.recordStartPattern", recordStartPattern_ );
+    settings.setValue( "perf.tokenIndexPattern", tokenIndexPattern_ );
+    settings.setValue( "perf.memoryBudgetMb", memoryBudgetMb_ );
     settings.setValue( "perf.optimizeForNotLatinEncodings", optimizeForNotLatinEncodings_ );
 
     settings.setValue( "net.verifySslPeers", verifySslPeers_ );
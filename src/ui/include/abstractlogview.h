@@ -60,6 +60,7 @@
 
 #include "abstractlogdata.h"
 #include "linetypes.h"
+#include "memorygovernor.h"
 #include "overviewwidget.h"
 #include "quickfind.h"
 #include "quickfindmux.h"
@@ -216,6 +217,8 @@ class AbstractLogView : public QAbstractScrollArea, public SearchableWidgetInter
     // Sent up when the user wants to replace the search with the selection
     void replaceSearch( const QString& selection );
     void excludeFromSearch( const QString& selection );
+    // Sent up when the user wants lines with the selected token from the token index
+    void showTokenLines( const QString& token );
     // Sent up when the mouse is hovered over a line's margin
     void mouseHoveredOverLine( LineNumber line );
     // Sent up when the mouse leaves a line's margin
@@ -291,6 +294,7 @@ class AbstractLogView : public QAbstractScrollArea, public SearchableWidgetInter
     void addToSearch();
     void replaceSearch();
     void excludeFromSearch();
+    void showTokenLines();
     void findNextSelected();
     void findPreviousSelected();
     void copy();
@@ -399,6 +403,7 @@ class AbstractLogView : public QAbstractScrollArea, public SearchableWidgetInter
     QAction* addToSearchAction_;
     QAction* replaceSearchAction_;
     QAction* excludeFromSearchAction_;
+    QAction* showTokenLinesAction_;
     QAction* setSearchStartAction_;
     QAction* setSearchEndAction_;
     QAction* clearSearchLimitAction_;
@@ -437,6 +442,7 @@ class AbstractLogView : public QAbstractScrollArea, public SearchableWidgetInter
     };
     TextAreaCache textAreaCache_ = { {}, true, 0_lnum, 0_lnum, 0_lcol };
     PullToFollowCache pullToFollowCache_ = { {}, 0_length };
+    MemoryRegistration pixmapCacheMemory_;
     QFontMetrics pixmapFontMetrics_;
 
     LinesCount getNbVisibleLines() const;
@@ -482,6 +488,10 @@ class AbstractLogView : public QAbstractScrollArea, public SearchableWidgetInter
     void drawTextArea( QPaintDevice* paintDevice );
     QPixmap drawPullToFollowBar( int width, qreal pixelRatio );
 
+    void updatePixmapCacheUsage();
+    // Called by memory governor when over the budget
+    void shedPixmapCache();
+
     void disableFollow();
 
     // Utils functions
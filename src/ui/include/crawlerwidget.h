@@ -45,6 +45,8 @@
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QHBoxLayout>
 #include <QLabel>
 #include <QMenu>
@@ -53,6 +55,7 @@
 #include <QToolButton>
 #include <QVBoxLayout>
 
+#include "atomicflag.h"
 #include "colorlabelsmanager.h"
 #include "filteredview.h"
 #include "iconloader.h"
@@ -84,6 +87,7 @@ class CrawlerWidget : public QSplitter,
 
   public:
     CrawlerWidget( QWidget* parent = nullptr );
+    ~CrawlerWidget() override;
 
     // Get the line number of the first line displayed.
     LineNumber getTopLine() const;
@@ -110,6 +114,8 @@ class CrawlerWidget : public QSplitter,
 
     bool isTextWrapEnabled() const;
 
+    bool isRecordModeEnabled() const;
+
     void registerShortcuts();
 
   public Q_SLOTS:
@@ -124,6 +130,23 @@ class CrawlerWidget : public QSplitter,
     void focusSearchEdit();
     void goToLine();
 
+    // Count values of a field over the search results or the whole file
+    void showFieldAggregation();
+    // Group lines of the search results or the whole file into templates
+    void showTemplateMining();
+    // Filter duplicates out of the search results or the whole file
+    void filterDuplicateLines( DuplicateLinesFilter filter );
+    // Show lines of the levels detected while indexing,
+    // the filter is kept up to date when the file grows
+    void filterLogLevels( LogLevels levels );
+    // Make matches select whole multi-line records and redo the search,
+    // returns false if records were not indexed
+    bool setRecordModeEnabled( bool isEnabled );
+    // Compare the file with one of other files, differences are shown
+    // in filtered views of both widgets
+    void showLogDiff( const QStringList& otherFileNames,
+                      const std::vector<CrawlerWidget*>& otherCrawlers );
+
     // Instructs the widget to reconfigure itself because Config() has changed.
     void applyConfiguration();
 
@@ -243,6 +266,11 @@ class CrawlerWidget : public QSplitter,
     // works only in boolean combination mode
     void excludeFromSearch( const QString& string );
 
+    // Called when the user asks for lines with the selected token
+    void showTokenLines( const QString& token );
+    // Called when lines of the token are checked in the background
+    void tokenLinesFound();
+
     void clearSearchHistory();
     void editSearchHistory();
 
@@ -301,6 +329,8 @@ class CrawlerWidget : public QSplitter,
         void stopSearch();
         // The search has been started (enable auto-refresh)
         void startSearch();
+        // Results were computed from an index (no auto-refresh)
+        void showIndexedResults();
 
         // Get the state in order to display the proper message
         State getState() const
@@ -329,6 +359,9 @@ class CrawlerWidget : public QSplitter,
     void updateSearchCombo();
     AbstractLogView* activeView() const;
     void printSearchInfoMessage( LinesCount nbMatches = 0_lcount );
+    // Shows lines computed without searching in the filtered view
+    void showIndexedLines( SearchResultArray lines );
+    void interruptTokenLines();
     void changeDataStatus( DataStatus status );
     void updateEncoding();
     void changeTopViewSize( int32_t delta );
@@ -419,6 +452,14 @@ class CrawlerWidget : public QSplitter,
     LineNumber searchStartLine_;
     LineNumber searchEndLine_;
 
+    // Levels shown in the filtered view instead of search results
+    std::optional<LogLevels> levelFilter_;
+
+    // Lines of the token index are checked off the GUI thread
+    AtomicFlag tokenLinesInterrupt_;
+    QFuture<std::optional<SearchResultArray>> tokenLinesFuture_;
+    QFutureWatcher<std::optional<SearchResultArray>> tokenLinesWatcher_;
+
     // Until we have received confirmation loading is finished, we
     // should consider we are loading something.
     bool loadingInProgress_ = true;
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_EXPORTCOMPRESSION_H
+#define KLOGG_EXPORTCOMPRESSION_H
+
+#include <optional>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+enum class ExportCompression { None, Gzip, Zstd };
+
+// Compression formats this build was linked with, None is always available
+std::vector<ExportCompression> availableExportCompressions();
+
+// File dialog filter for the format, e.g. "Gzip compressed (*.gz)"
+QString exportNameFilter( ExportCompression compression );
+
+// Format of a file name selected in the file dialog
+ExportCompression exportCompressionForFile( const QString& fileName,
+                                            const QString& selectedFilter );
+
+int minCompressionLevel( ExportCompression compression );
+int maxCompressionLevel( ExportCompression compression );
+int defaultCompressionLevel( ExportCompression compression );
+
+// Compresses data into a complete gzip member or zstd frame.
+// Members and frames can be concatenated, so chunks of a file are
+// compressed independently and written one after another.
+std::optional<QByteArray> compressChunk( ExportCompression compression, const QByteArray& data, int level );
+
+#endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_FIELDAGGREGATIONDIALOG_H
+#define KLOGG_FIELDAGGREGATIONDIALOG_H
+
+#include <memory>
+#include <optional>
+
+#include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
+
+#include "atomicflag.h"
+#include "fieldaggregation.h"
+
+class QComboBox;
+class QCheckBox;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+
+// Counts values of a field over the file or the current search results
+// and shows the most frequent ones.
+class FieldAggregationDialog : public QDialog {
+    Q_OBJECT
+
+  public:
+    FieldAggregationDialog( std::shared_ptr<const LogData> logData,
+                            std::optional<SearchResultArray> matchingLines, LineNumber startLine,
+                            LineNumber endLine, QWidget* parent = nullptr );
+    ~FieldAggregationDialog() override;
+
+  Q_SIGNALS:
+    // Sent when the user wants to search for the value
+    void searchRequested( const QString& value );
+
+  private Q_SLOTS:
+    void startAggregation();
+    void aggregationFinished();
+    void requestSearch();
+
+  private:
+    void interruptAggregation();
+
+  private:
+    std::shared_ptr<const LogData> logData_;
+    std::optional<SearchResultArray> matchingLines_;
+    LineNumber startLine_;
+    LineNumber endLine_;
+
+    QComboBox* extractorType_;
+    QLineEdit* expression_;
+    QCheckBox* caseSensitive_;
+    QCheckBox* onlyMatches_;
+    QSpinBox* maxValues_;
+    QPushButton* runButton_;
+    QPushButton* searchButton_;
+    QProgressBar* progressBar_;
+    QLabel* summary_;
+    QTableWidget* valuesTable_;
+
+    AtomicFlag interruptRequested_;
+    QFuture<FieldAggregationResult> future_;
+    QFutureWatcher<FieldAggregationResult> watcher_;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_LOGDIFFDIALOG_H
+#define KLOGG_LOGDIFFDIALOG_H
+
+#include <memory>
+
+#include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QStringList>
+
+#include "atomicflag.h"
+#include "containers.h"
+#include "logdiff.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QProgressBar;
+class QPushButton;
+
+// Compares the file with one of other opened files and reports lines
+// present only in one of them.
+class LogDiffDialog : public QDialog {
+    Q_OBJECT
+
+  public:
+    LogDiffDialog( std::shared_ptr<const LogData> logData, const QStringList& otherFileNames,
+                   klogg::vector<std::shared_ptr<const LogData>> otherLogData,
+                   QWidget* parent = nullptr );
+    ~LogDiffDialog() override;
+
+  Q_SIGNALS:
+    // Sent when comparison with the file at otherIndex is finished
+    void differencesFound( int otherIndex, const SearchResultArray& onlyInThis,
+                           const SearchResultArray& onlyInOther );
+
+  private Q_SLOTS:
+    void startComparison();
+    void comparisonFinished();
+
+  private:
+    void interruptComparison();
+
+  private:
+    std::shared_ptr<const LogData> logData_;
+    klogg::vector<std::shared_ptr<const LogData>> otherLogData_;
+
+    QComboBox* otherFile_;
+    QComboBox* mode_;
+    QLineEdit* maskPattern_;
+    QPushButton* runButton_;
+    QProgressBar* progressBar_;
+    QLabel* summary_;
+
+    int comparedIndex_ = -1;
+    AtomicFlag interruptRequested_;
+    QFuture<LogDiffResult> future_;
+    QFutureWatcher<LogDiffResult> watcher_;
+};
+
+#endif
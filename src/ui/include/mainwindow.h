@@ -58,11 +58,13 @@
 #include "quickfindwidget.h"
 #include "session.h"
 #include "signalmux.h"
+#include "streamspooler.h"
 #include "tabbedcrawlerwidget.h"
 #include "tabbedscratchpad.h"
 
 class QAction;
 class QActionGroup;
+class QDockWidget;
 class Session;
 class RecentFiles;
 class HighlightersMenu;
@@ -135,6 +137,9 @@ class MainWindow : public QMainWindow {
     void removeFromFavorites();
     void selectOpenedFile();
     void generateDump();
+    void aboutMemory();
+    void recordTrace( bool isEnabled );
+    void compareFiles();
 
     // Change the view settings
     void toggleOverviewVisibility( bool isVisible );
@@ -205,6 +210,7 @@ class MainWindow : public QMainWindow {
     void writeSettings();
     bool loadFile( const QString& fileName, bool followFile = false );
     bool extractAndLoadFile( const QString& fileName );
+    bool spoolAndLoadStream( const QString& streamName );
     void openRemoteFile( const QUrl& url );
     void updateTitleBar( const QString& fileName );
     void addRecentFile( const QString& fileName );
@@ -236,6 +242,8 @@ class MainWindow : public QMainWindow {
     QMenu* editMenu;
     QMenu* viewMenu;
     QMenu* toolsMenu;
+    QMenu* duplicateLinesMenu;
+    QMenu* logLevelsMenu;
     QMenu* favoritesMenu;
     HighlightersMenu* highlightersMenu;
     QMenu* openedFilesMenu;
@@ -279,10 +287,23 @@ class MainWindow : public QMainWindow {
     QAction* aboutAction;
     QAction* aboutQtAction;
     QAction* predefinedFiltersDialogAction;
+    QAction* aggregateFieldAction;
+    QAction* mineTemplatesAction;
+    QAction* compareFilesAction;
+    QAction* collapseRepeatedLinesAction;
+    QAction* firstOccurrencesAction;
+    QAction* newLinesSinceAction;
+    QAction* errorsOnlyAction;
+    QAction* warningsAndErrorsAction;
+    QAction* infoAndAboveAction;
+    QAction* recordModeAction;
     QAction* reportIssueAction;
     QAction* joinDiscordAction;
     QAction* joinTelegramAction;
     QAction* generateDumpAction;
+    QAction* aboutMemoryAction;
+    QAction* recordTraceAction;
+    QDockWidget* performanceDock_;
     QActionGroup* encodingGroup;
     QAction* addToFavoritesAction;
     QAction* addToFavoritesMenuAction;
@@ -320,6 +341,9 @@ class MainWindow : public QMainWindow {
 
     QTemporaryDir tempDir_;
 
+    // Spool files of stdin and FIFOs are followed as growing files
+    std::vector<std::unique_ptr<StreamSpooler>> streamSpoolers_;
+
     bool isMaximized_ = false;
     bool isCloseFromTray_ = false;
 
@@ -12,6 +12,9 @@ extern const char* viewTitle;
 // openedFilesTitle is the submenu of view menu
 extern const char* openedFilesTitle;
 extern const char* toolsTitle;
+// duplicateLinesTitle is the submenu of tools menu
+extern const char* duplicateLinesTitle;
+extern const char* logLevelsTitle;
 extern const char* highlightersTitle;
 extern const char* favoritesTitle;
 extern const char* helpTitle;
@@ -83,6 +86,11 @@ extern const char* joinTelegramText;
 extern const char* joinTelegramStatusTip;
 extern const char* generateDumpText;
 extern const char* generateDumpStatusTip;
+extern const char* aboutMemoryText;
+extern const char* aboutMemoryStatusTip;
+extern const char* recordTraceText;
+extern const char* recordTraceStatusTip;
+extern const char* performanceDashboardText;
 extern const char* showScratchPadText;
 extern const char* showScratchPadStatusTip;
 extern const char* addToFavoritesText;
@@ -90,6 +98,26 @@ extern const char* removeFromFavoritesText;
 extern const char* selectOpenFileText;
 extern const char* predefinedFiltersDialogText;
 extern const char* predefinedFiltersDialogStatusTip;
+extern const char* aggregateFieldText;
+extern const char* aggregateFieldStatusTip;
+extern const char* mineTemplatesText;
+extern const char* mineTemplatesStatusTip;
+extern const char* compareFilesText;
+extern const char* compareFilesStatusTip;
+extern const char* collapseRepeatedLinesText;
+extern const char* collapseRepeatedLinesStatusTip;
+extern const char* firstOccurrencesText;
+extern const char* firstOccurrencesStatusTip;
+extern const char* newLinesSinceText;
+extern const char* newLinesSinceStatusTip;
+extern const char* errorsOnlyText;
+extern const char* errorsOnlyStatusTip;
+extern const char* warningsAndErrorsText;
+extern const char* warningsAndErrorsStatusTip;
+extern const char* infoAndAboveText;
+extern const char* infoAndAboveStatusTip;
+extern const char* recordModeText;
+extern const char* recordModeStatusTip;
 extern const char* autoEncodingText;
 extern const char* autoEncodingStatusTip;
 } // namespace action
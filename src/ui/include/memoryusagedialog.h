@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_MEMORYUSAGEDIALOG_H
+#define KLOGG_MEMORYUSAGEDIALOG_H
+
+#include <QDialog>
+#include <QTimer>
+
+class QLabel;
+class QTableWidget;
+
+// Shows live and peak memory usage of klogg subsystems.
+class MemoryUsageDialog : public QDialog {
+    Q_OBJECT
+
+  public:
+    explicit MemoryUsageDialog( QWidget* parent = nullptr );
+
+  private Q_SLOTS:
+    void updateUsage();
+
+  private:
+    QTableWidget* usageTable_;
+    QLabel* processUsageLabel_;
+    QLabel* budgetLabel_;
+
+    QTimer updateTimer_;
+};
+
+#endif
@@ -99,11 +99,13 @@ class OptionsDialog : public QDialog, public Ui::OptionsDialog {
     void setupRegexp();
     void setupPolling();
     void setupSearchResultsCache();
+    void setupLongLineSplit();
     void setupLogging();
     void setupArchives();
     void setupStyles();
     void setupEncodings();
     void setupLanguageList();
+    void setupPageCache();
 
     int updateTranslate();
 
@@ -21,6 +21,7 @@
 #define OVERVIEW_H
 
 #include "linetypes.h"
+#include "loglevelindex.h"
 #include <QList>
 #include <QVector>
 
@@ -106,6 +107,10 @@ class Overview {
     // Returns a list of lines (between 0 and 'height') representing marks.
     // (pointer returned is valid until next call to update*()
     const klogg::vector<WeightedLine>* getMarkLines() const;
+    // Returns a list of lines (between 0 and 'height') having lines of the level,
+    // empty if log levels are not indexed.
+    // (pointer returned is valid until next call to update*()
+    const klogg::vector<WeightedLine>* getLevelLines( LogLevel level ) const;
     // Return a pair of lines (between 0 and 'height') representing the current view.
     std::pair<int, int> getViewLines() const;
 
@@ -132,8 +137,11 @@ class Overview {
     // List of lines representing matches and marks (are shared with the client)
     klogg::vector<WeightedLine> matchLines_;
     klogg::vector<WeightedLine> markLines_;
+    klogg::vector<WeightedLine> errorLines_;
+    klogg::vector<WeightedLine> warningLines_;
 
     void recalculatesLines();
+    void recalculateLevelLines( LogLevel level, klogg::vector<WeightedLine>& levelLines );
 };
 
 #endif
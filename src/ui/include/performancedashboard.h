@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_PERFORMANCEDASHBOARD_H
+#define KLOGG_PERFORMANCEDASHBOARD_H
+
+#include <chrono>
+
+#include <QTimer>
+#include <QWidget>
+
+#include "performancecounters.h"
+
+class QLabel;
+class QTableWidget;
+
+// Shows live indexing and search throughput, cache hit rates,
+// follow lag and memory usage. Counters are sampled only while visible.
+class PerformanceDashboard : public QWidget {
+    Q_OBJECT
+
+  public:
+    explicit PerformanceDashboard( QWidget* parent = nullptr );
+
+  protected:
+    void showEvent( QShowEvent* event ) override;
+    void hideEvent( QHideEvent* event ) override;
+
+  private Q_SLOTS:
+    void updateCounters();
+
+  private:
+    void updateSearches( const PerformanceCounters::Snapshot& snapshot, double seconds );
+    void updateMemory();
+
+  private:
+    QLabel* indexingLabel_;
+    QLabel* searchCacheLabel_;
+    QLabel* textAreaCacheLabel_;
+    QLabel* followLagLabel_;
+    QLabel* fileReadingLabel_;
+    QTableWidget* searchesTable_;
+    QTableWidget* memoryTable_;
+
+    QTimer updateTimer_;
+
+    PerformanceCounters::Snapshot lastSnapshot_;
+    std::chrono::steady_clock::time_point lastSnapshotTime_;
+};
+
+#endif
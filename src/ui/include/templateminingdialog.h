@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_TEMPLATEMININGDIALOG_H
+#define KLOGG_TEMPLATEMININGDIALOG_H
+
+#include <memory>
+#include <optional>
+
+#include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
+
+#include "atomicflag.h"
+#include "templatemining.h"
+
+class QCheckBox;
+class QDoubleSpinBox;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTableWidget;
+
+// Groups lines of the file or of the current search results into
+// message templates and shows how often each template occurs.
+class TemplateMiningDialog : public QDialog {
+    Q_OBJECT
+
+  public:
+    TemplateMiningDialog( std::shared_ptr<const LogData> logData,
+                          std::optional<SearchResultArray> matchingLines, LineNumber startLine,
+                          LineNumber endLine, QWidget* parent = nullptr );
+    ~TemplateMiningDialog() override;
+
+  Q_SIGNALS:
+    // Sent when the user wants to filter lines of the template,
+    // pattern is a regular expression
+    void searchRequested( const QString& pattern );
+
+  private Q_SLOTS:
+    void startMining();
+    void miningFinished();
+    void requestSearch();
+
+  private:
+    void interruptMining();
+
+  private:
+    std::shared_ptr<const LogData> logData_;
+    std::optional<SearchResultArray> matchingLines_;
+    LineNumber startLine_;
+    LineNumber endLine_;
+
+    QDoubleSpinBox* similarity_;
+    QCheckBox* onlyMatches_;
+    QPushButton* runButton_;
+    QPushButton* searchButton_;
+    QProgressBar* progressBar_;
+    QLabel* summary_;
+    QTableWidget* templatesTable_;
+
+    AtomicFlag interruptRequested_;
+    QFuture<TemplateMiningResult> future_;
+    QFutureWatcher<TemplateMiningResult> watcher_;
+};
+
+#endif
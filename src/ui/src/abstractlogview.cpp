@@ -85,14 +85,18 @@
 #include "active_screen.h"
 #include "clipboard.h"
 #include "configuration.h"
+#include "exportcompression.h"
 #include "highlighterset.h"
 #include "highlightersmenu.h"
 #include "log.h"
+#include "logfiltereddataworker.h"
 #include "overview.h"
+#include "performancecounters.h"
 #include "quickfind.h"
 #include "quickfindpattern.h"
 #include "regularexpressionpattern.h"
 #include "shortcuts.h"
+#include "tracing.h"
 
 #ifdef Q_OS_WIN
 
@@ -425,6 +429,10 @@ AbstractLogView::AbstractLogView( const AbstractLogData* newLogData,
             disableFollow();
         }
     } );
+
+    pixmapCacheMemory_ = MemoryGovernor::instance().registerConsumer(
+        "Text area pixmaps", MemoryShedPriority::PixmapCache, this,
+        [ this ] { shedPixmapCache(); } );
 }
 
 AbstractLogView::~AbstractLogView()
@@ -543,12 +551,14 @@ void AbstractLogView::mousePressEvent( QMouseEvent* mouseEvent )
             findPreviousAction_->setEnabled( true );
             addToSearchAction_->setEnabled( true );
             replaceSearchAction_->setEnabled( true );
+            showTokenLinesAction_->setEnabled( true );
         }
         else {
             findNextAction_->setEnabled( false );
             findPreviousAction_->setEnabled( false );
             addToSearchAction_->setEnabled( false );
             replaceSearchAction_->setEnabled( false );
+            showTokenLinesAction_->setEnabled( false );
         }
 
         highlightersMenu_->createHighlightersMenu();
@@ -1051,6 +1061,8 @@ void AbstractLogView::scrollContentsBy( int dx, int dy )
 
 void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
 {
+    KLOGG_TRACE_SCOPE( "paint" );
+
     const QRect invalidRect = paintEvent->rect();
     if ( ( invalidRect.isEmpty() ) || ( logData_ == nullptr ) )
         return;
@@ -1080,6 +1092,8 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
         deltaY = std::numeric_limits<decltype( deltaY )>::max();
     }
 
+    PerformanceCounters::instance().addTextAreaCacheLookup( deltaY == 0 );
+
     if ( deltaY != 0 ) {
         // Full or partial redraw
         drawTextArea( &textAreaCache_.pixmap_ );
@@ -1113,6 +1127,8 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
         pullToFollowCache_.nb_columns_ = getNbVisibleCols();
     }
 
+    updatePixmapCacheUsage();
+
     QPainter devicePainter( viewport() );
     int drawingTopPosition = -pullToFollowHeight;
     int drawingPullToFollowTopPosition = drawingTopPosition + wholeHeight;
@@ -1344,6 +1360,17 @@ void AbstractLogView::excludeFromSearch()
     }
 }
 
+void AbstractLogView::showTokenLines()
+{
+    if ( selection_.isPortion() ) {
+        LOG_DEBUG << "AbstractLogView::showTokenLines()";
+        Q_EMIT showTokenLines( selection_.getSelectedText( logData_ ) );
+    }
+    else {
+        LOG_ERROR << "AbstractLogView::showTokenLines called for a wrong type of selection";
+    }
+}
+
 // Find next occurrence of the selected text (*)
 void AbstractLogView::findNextSelected()
 {
@@ -1420,11 +1447,31 @@ void AbstractLogView::saveSelectedToFile()
 
 void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
 {
-    auto filename = QFileDialog::getSaveFileName( this, "Save content" );
+    QStringList nameFilters;
+    for ( const auto availableCompression : availableExportCompressions() ) {
+        nameFilters.append( exportNameFilter( availableCompression ) );
+    }
+
+    QString selectedFilter;
+    auto filename = QFileDialog::getSaveFileName( this, "Save content", {},
+                                                  nameFilters.join( ";;" ), &selectedFilter );
     if ( filename.isEmpty() ) {
         return;
     }
 
+    const auto compression = exportCompressionForFile( filename, selectedFilter );
+    auto compressionLevel = defaultCompressionLevel( compression );
+    if ( compression != ExportCompression::None ) {
+        bool isLevelSelected = false;
+        compressionLevel = QInputDialog::getInt(
+            this, tr( "Compression level" ), tr( "Compression level:" ), compressionLevel,
+            minCompressionLevel( compression ), maxCompressionLevel( compression ), 1,
+            &isLevelSelected );
+        if ( !isLevelSelected ) {
+            return;
+        }
+    }
+
     QSaveFile saveFile{ filename };
     saveFile.open( QIODevice::WriteOnly | QIODevice::Truncate );
     if ( !saveFile.isOpen() ) {
@@ -1434,6 +1481,37 @@ void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
 
     QProgressDialog progressDialog( this );
     progressDialog.setLabelText( tr( "Saving content to %1" ).arg( filename ) );
+
+    if ( compression == ExportCompression::None && logData_->canExportRawLines() ) {
+        // Lines are written in the same encoding they are displayed in,
+        // so bytes can be copied from the file without decoding
+        progressDialog.setRange( 0, 1000 );
+        progressDialog.setWindowModality( Qt::ApplicationModal );
+        progressDialog.show();
+
+        const auto isExported = logData_->exportRawLines(
+            begin, LinesCount( ( end - begin ).get() ), saveFile,
+            [ &progressDialog ]( uint64_t copiedBytes, uint64_t totalBytes ) {
+                if ( totalBytes > 0 ) {
+                    progressDialog.setValue( static_cast<int>(
+                        static_cast<double>( copiedBytes ) / static_cast<double>( totalBytes )
+                        * 1000. ) );
+                }
+                return !progressDialog.wasCanceled();
+            } );
+
+        if ( isExported ) {
+            saveFile.commit();
+        }
+        else {
+            LOG_WARNING << "Saving content to " << filename << " failed or was canceled";
+            saveFile.cancelWriting();
+        }
+
+        progressDialog.finished( 0 );
+        return;
+    }
+
     klogg::vector<std::pair<LineNumber, LinesCount>> offsets;
     auto lineOffset = begin;
     const auto chunkSize = 5000_lcount;
@@ -1442,13 +1520,19 @@ void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
     for ( ; lineOffset + chunkSize < end; lineOffset += LinesCount( chunkSize.get() ) ) {
         offsets.emplace_back( lineOffset, chunkSize );
     }
-    offsets.emplace_back( lineOffset, LinesCount( ( end - lineOffset ).get() % chunkSize.get() ) );
+    offsets.emplace_back( lineOffset, LinesCount( ( end - lineOffset ).get() ) );
 
     const QTextCodec* codec = logData_->getDisplayEncoding();
     if ( !codec ) {
         codec = QTextCodec::codecForName( "utf-8" );
     }
 
+#if !defined( Q_OS_WIN )
+    const auto lineSeparator = QStringLiteral( "\r\n" );
+#else
+    const auto lineSeparator = QStringLiteral( "\n" );
+#endif
+
     AtomicFlag interruptRequest;
 
     progressDialog.setRange( 0, 1000 );
@@ -1456,20 +1540,31 @@ void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
              [ &interruptRequest ]() { interruptRequest.set(); } );
 
     tbb::flow::graph saveFileGraph;
-    using LinesData = std::pair<klogg::vector<QString>, bool>;
+    // Each chunk of lines is decoded into one buffer and encoded back with one call.
+    // Chunks are encoded and compressed in parallel and put back in order before writing.
+    struct LinesData {
+        size_t index = 0;
+        QString lines;
+        bool isFinal = false;
+    };
+    struct EncodedLines {
+        size_t index = 0;
+        QByteArray data;
+        bool isFinal = false;
+        bool isValid = true;
+    };
+
     auto lineReader = tbb::flow::input_node<LinesData>(
         saveFileGraph,
-        [ this, &offsets, &interruptRequest, &progressDialog, offsetIndex = 0u,
+        [ this, &offsets, &interruptRequest, &progressDialog, end, &lineSeparator, offsetIndex = 0u,
           finalLine = false ]( tbb::flow_control& fc ) mutable -> LinesData {
             if ( !interruptRequest && offsetIndex < offsets.size() ) {
                 const auto& offset = offsets.at( offsetIndex );
-                LinesData lines{ logData_->getLines( offset.first, offset.second ), true };
-                for ( auto& l : lines.first ) {
-#if !defined( Q_OS_WIN )
-                    l.append( QChar::CarriageReturn );
-#endif
-                    l.append( QChar::LineFeed );
-                }
+
+                LinesData lines;
+                lines.index = offsetIndex;
+                lines.lines
+                    = logData_->getLinesText( offset.first, offset.second, end, lineSeparator );
 
                 offsetIndex++;
                 progressDialog.setValue( static_cast<int>(
@@ -1484,14 +1579,44 @@ void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
                 fc.stop();
             }
 
-            return {};
+            LinesData finalMarker;
+            finalMarker.index = offsetIndex;
+            finalMarker.isFinal = true;
+            return finalMarker;
         } );
 
-    auto lineWriter = tbb::flow::function_node<LinesData, tbb::flow::continue_msg>(
+    // Reader stops while encoded chunks wait to be written
+    auto chunksLimiter = tbb::flow::limiter_node<LinesData>(
+        saveFileGraph, static_cast<size_t>( searchThreadsCount() ) * 3 );
+
+    auto lineEncoder = tbb::flow::function_node<LinesData, EncodedLines>(
+        saveFileGraph, tbb::flow::unlimited,
+        [ &codec, compression, compressionLevel ]( const LinesData& lines ) {
+            EncodedLines encodedLines;
+            encodedLines.index = lines.index;
+            encodedLines.isFinal = lines.isFinal;
+            if ( lines.isFinal ) {
+                return encodedLines;
+            }
+
+            auto compressed
+                = compressChunk( compression, codec->fromUnicode( lines.lines ), compressionLevel );
+            if ( compressed ) {
+                encodedLines.data = std::move( *compressed );
+            }
+            else {
+                encodedLines.isValid = false;
+            }
+            return encodedLines;
+        } );
+
+    auto chunkSequencer = tbb::flow::sequencer_node<EncodedLines>(
+        saveFileGraph, []( const EncodedLines& lines ) { return lines.index; } );
+
+    auto lineWriter = tbb::flow::function_node<EncodedLines, tbb::flow::continue_msg>(
         saveFileGraph, 1,
-        [ &interruptRequest, &codec, &saveFile,
-          &progressDialog ]( const LinesData& lines ) mutable {
-            if ( !lines.second ) {
+        [ &interruptRequest, &saveFile, &progressDialog ]( const EncodedLines& lines ) mutable {
+            if ( lines.isFinal ) {
                 if ( !interruptRequest ) {
                     saveFile.commit();
                 }
@@ -1500,21 +1625,29 @@ void AbstractLogView::saveLinesToFile( LineNumber begin, LineNumber end )
                 return tbb::flow::continue_msg{};
             }
 
-            for ( const auto& l : lines.first ) {
+            if ( interruptRequest ) {
+                return tbb::flow::continue_msg{};
+            }
 
-                const auto encodedLine = codec->fromUnicode( l );
-                const auto written = saveFile.write( encodedLine );
+            if ( !lines.isValid ) {
+                LOG_ERROR << "Saving file compression failed";
+                interruptRequest.set();
+                return tbb::flow::continue_msg{};
+            }
 
-                if ( written != encodedLine.size() ) {
-                    LOG_ERROR << "Saving file write failed";
-                    interruptRequest.set();
-                    return tbb::flow::continue_msg{};
-                }
+            const auto written = saveFile.write( lines.data );
+            if ( written != lines.data.size() ) {
+                LOG_ERROR << "Saving file write failed";
+                interruptRequest.set();
             }
             return tbb::flow::continue_msg{};
         } );
 
-    tbb::flow::make_edge( lineReader, lineWriter );
+    tbb::flow::make_edge( lineReader, chunksLimiter );
+    tbb::flow::make_edge( chunksLimiter, lineEncoder );
+    tbb::flow::make_edge( lineEncoder, chunkSequencer );
+    tbb::flow::make_edge( chunkSequencer, lineWriter );
+    tbb::flow::make_edge( lineWriter, chunksLimiter.decrementer() );
 
     progressDialog.setWindowModality( Qt::ApplicationModal );
     progressDialog.open();
@@ -2042,6 +2175,12 @@ void AbstractLogView::createMenu()
     connect( excludeFromSearchAction_, &QAction::triggered, this,
              [ this ]( auto ) { this->excludeFromSearch(); } );
 
+    showTokenLinesAction_ = new QAction( tr( "Show lines with this token" ), this );
+    showTokenLinesAction_->setStatusTip(
+        tr( "Show lines with the selected token using the token index" ) );
+    connect( showTokenLinesAction_, &QAction::triggered, this,
+             [ this ]( auto ) { this->showTokenLines(); } );
+
     setSearchStartAction_ = new QAction( tr( "Set search start" ), this );
     connect( setSearchStartAction_, &QAction::triggered, this,
              [ this ]( auto ) { this->setSearchStart(); } );
@@ -2093,6 +2232,7 @@ void AbstractLogView::createMenu()
     popupMenu_->addAction( replaceSearchAction_ );
     popupMenu_->addAction( addToSearchAction_ );
     popupMenu_->addAction( excludeFromSearchAction_ );
+    popupMenu_->addAction( showTokenLinesAction_ );
     popupMenu_->addSeparator();
     popupMenu_->addAction( setSearchStartAction_ );
     popupMenu_->addAction( setSearchEndAction_ );
@@ -2187,6 +2327,8 @@ void AbstractLogView::updateScrollBars()
 
 void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
 {
+    KLOGG_TRACE_SCOPE( "draw text area" );
+
     // LOG_DEBUG << "devicePixelRatio: " << viewport()->devicePixelRatio();
     // LOG_DEBUG << "viewport size: " << viewport()->size().width();
     // LOG_DEBUG << "pixmap size: " << textPixmap.width();
@@ -2292,8 +2434,8 @@ void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
         return index;
     }();
 
-    // Lines to write
-    const auto expandedLines = logData_->getExpandedLines( firstLine_, nbLines );
+    // Lines to write, decoded in one go
+    const auto linesToDraw = logData_->getLinesView( firstLine_, nbLines );
 
     const auto highlightPatternMatches = Configuration::get().mainSearchHighlight();
     const auto variateHighlightPatternMatches = Configuration::get().variateMainSearchHighlight();
@@ -2338,7 +2480,9 @@ void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
     wrappedLinesInfo_.clear();
     for ( auto currentLine = 0_lcount; currentLine < nbLines; ++currentLine ) {
         const auto lineNumber = firstLine_ + currentLine;
-        const QString logLine = logData_->getLineString( lineNumber );
+        const auto lineView = linesToDraw[ currentLine.get() ];
+        const QString logLine
+            = QString::fromRawData( lineView.data(), static_cast<int>( lineView.size() ) );
 
         const int xPos = contentStartPosX + ContentMarginWidth;
 
@@ -2390,13 +2534,13 @@ void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
             const auto prefix = QStringView{ logLine }.left( match.startColumn().get() );
             const auto matchPart
                 = QStringView{ logLine }.mid( match.startColumn().get(), match.size().get() );
-            const auto expandedPrefixLength = untabify( prefix.toString() ).size();
+            const auto expandedPrefixLength = untabify( prefix ).size();
             const LineLength startDelta
                 = LineLength{ type_safe::narrow_cast<LineLength::UnderlyingType>(
                     expandedPrefixLength - prefix.size() ) };
 
             const LineLength expandedMatchLength = LineLength{
-                untabify( matchPart.toString(),
+                untabify( matchPart,
                           LineColumn{ type_safe::narrow_cast<LineColumn::UnderlyingType>(
                               expandedPrefixLength ) } )
                     .size()
@@ -2417,7 +2561,8 @@ void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
                         std::back_inserter( allHighlights ), untabifyHighlight );
 
         // string to print, cut to fit the length and position of the view
-        const QString& expandedLine = expandedLines[ currentLine.get() ];
+        // Lines without tabs are drawn from the arena without copying
+        const QString expandedLine = untabify( lineView );
 
         // Has the line got elements to be highlighted
         klogg::vector<HighlightedMatch> quickFindMatches;
@@ -2584,6 +2729,33 @@ void AbstractLogView::drawTextArea( QPaintDevice* paintDevice )
     } // For each line
 }
 
+void AbstractLogView::updatePixmapCacheUsage()
+{
+    const auto pixmapBytes = []( const QPixmap& pixmap ) {
+        return static_cast<uint64_t>( pixmap.width() ) * static_cast<uint64_t>( pixmap.height() )
+               * static_cast<uint64_t>( pixmap.depth() ) / 8;
+    };
+
+    pixmapCacheMemory_.setUsage( pixmapBytes( textAreaCache_.pixmap_ )
+                                 + pixmapBytes( pullToFollowCache_.pixmap_ ) );
+}
+
+void AbstractLogView::shedPixmapCache()
+{
+    // Visible view will redraw its cache right away, no point in dropping it
+    if ( isVisible() ) {
+        return;
+    }
+
+    LOG_INFO << "Dropping text area pixmap cache";
+
+    textAreaCache_.pixmap_ = QPixmap{};
+    textAreaCache_.invalid_ = true;
+    pullToFollowCache_ = { {}, 0_length };
+
+    updatePixmapCacheUsage();
+}
+
 // Draw the "pull to follow" bar and return a pixmap.
 // The width is passed in "logic" pixels.
 QPixmap AbstractLogView::drawPullToFollowBar( int width, qreal pixelRatio )
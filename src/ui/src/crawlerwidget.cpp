@@ -58,9 +58,12 @@
 #include <QKeySequence>
 #include <QLineEdit>
 #include <QListView>
+#include <QMessageBox>
+#include <QPointer>
 #include <QShortcut>
 #include <QStandardItemModel>
 #include <QStringListModel>
+#include <QtConcurrent>
 #include <qglobal.h>
 #include <qobject.h>
 #include <string>
@@ -71,11 +74,14 @@
 
 #include "configuration.h"
 #include "dispatch_to.h"
+#include "fieldaggregationdialog.h"
 #include "fontutils.h"
 #include "infoline.h"
+#include "logdiffdialog.h"
 #include "quickfindpattern.h"
 #include "savedsearches.h"
 #include "shortcuts.h"
+#include "templateminingdialog.h"
 
 static constexpr char AnsiColorSequenceRegex[] = "\\x1B\\[([0-9]{1,4}((;|:)[0-9]{1,3})*)?[mK]";
 
@@ -167,6 +173,11 @@ CrawlerWidget::CrawlerWidget( QWidget* parent )
 {
 }
 
+CrawlerWidget::~CrawlerWidget()
+{
+    interruptTokenLines();
+}
+
 // The top line is first one on the main display
 LineNumber CrawlerWidget::getTopLine() const
 {
@@ -204,6 +215,11 @@ bool CrawlerWidget::isFollowEnabled() const
     return logMainView_->isFollowEnabled();
 }
 
+bool CrawlerWidget::isRecordModeEnabled() const
+{
+    return logFilteredData_->isRecordMode();
+}
+
 bool CrawlerWidget::isTextWrapEnabled() const
 {
     return logMainView_->isTextWrapEnabled();
@@ -310,6 +326,168 @@ void CrawlerWidget::goToLine()
     }
 }
 
+void CrawlerWidget::showFieldAggregation()
+{
+    std::optional<SearchResultArray> matchingLines;
+    if ( logFilteredData_->getNbMatches() > 0_lcount ) {
+        matchingLines = logFilteredData_->getMatchingLines();
+    }
+
+    auto* dialog = new FieldAggregationDialog( logData_, std::move( matchingLines ),
+                                               searchStartLine_, searchEndLine_, this );
+    dialog->setAttribute( Qt::WA_DeleteOnClose );
+
+    connect( dialog, &FieldAggregationDialog::searchRequested, this,
+             [ this ]( const QString& value ) {
+                 replaceSearch( value );
+                 if ( !Configuration::get().autoRunSearchOnPatternChange() ) {
+                     startNewSearch();
+                 }
+             } );
+
+    dialog->show();
+}
+
+void CrawlerWidget::showTemplateMining()
+{
+    std::optional<SearchResultArray> matchingLines;
+    if ( logFilteredData_->getNbMatches() > 0_lcount ) {
+        matchingLines = logFilteredData_->getMatchingLines();
+    }
+
+    auto* dialog = new TemplateMiningDialog( logData_, std::move( matchingLines ),
+                                             searchStartLine_, searchEndLine_, this );
+    dialog->setAttribute( Qt::WA_DeleteOnClose );
+
+    connect( dialog, &TemplateMiningDialog::searchRequested, this,
+             [ this ]( const QString& pattern ) {
+                 useRegexpButton_->setChecked( true );
+                 setSearchPattern( escapeSearchPattern( pattern, true ) );
+                 if ( !Configuration::get().autoRunSearchOnPatternChange() ) {
+                     startNewSearch();
+                 }
+             } );
+
+    dialog->show();
+}
+
+void CrawlerWidget::filterDuplicateLines( DuplicateLinesFilter filter )
+{
+    std::optional<SearchResultArray> matchingLines;
+    if ( logFilteredData_->getNbMatches() > 0_lcount ) {
+        matchingLines = logFilteredData_->getMatchingLines();
+    }
+
+    auto lines = logData_->filterDuplicateLines( filter, currentLineNumber_, matchingLines );
+    if ( !lines ) {
+        QMessageBox::information(
+            this, "klogg",
+            tr( "Line hashes are not indexed for this file. Enable indexing of line hashes "
+                "in the options and reload the file." ) );
+        return;
+    }
+
+    showIndexedLines( std::move( *lines ) );
+}
+
+void CrawlerWidget::filterLogLevels( LogLevels levels )
+{
+    auto lines = logData_->linesOfLogLevels( levels );
+    if ( !lines ) {
+        QMessageBox::information(
+            this, "klogg",
+            tr( "Log levels are not indexed for this file. Enable indexing of log levels "
+                "in the options and reload the file." ) );
+        return;
+    }
+
+    showIndexedLines( std::move( *lines ) );
+    levelFilter_ = levels;
+}
+
+void CrawlerWidget::showTokenLines( const QString& token )
+{
+    interruptTokenLines();
+    tokenLinesInterrupt_.clear();
+
+    tokenLinesFuture_ = QtConcurrent::run( [ this, logData = logData_, token = token.trimmed() ] {
+        return logData->findTokenLines( token, tokenLinesInterrupt_ );
+    } );
+    tokenLinesWatcher_.setFuture( tokenLinesFuture_ );
+}
+
+void CrawlerWidget::tokenLinesFound()
+{
+    if ( tokenLinesInterrupt_ ) {
+        return;
+    }
+
+    auto lines = tokenLinesFuture_.result();
+    if ( !lines ) {
+        QMessageBox::information(
+            this, "klogg",
+            tr( "The selection is not a token of the token index, or the index is not "
+                "complete yet. Set the token pattern in the options to index tokens." ) );
+        return;
+    }
+
+    LOG_INFO << "Found " << lines->cardinality() << " lines in token index";
+    showIndexedLines( std::move( *lines ) );
+}
+
+bool CrawlerWidget::setRecordModeEnabled( bool isEnabled )
+{
+    if ( isEnabled && !logData_->hasRecords() ) {
+        QMessageBox::information(
+            this, "klogg",
+            tr( "Records are not indexed for this file. Set the record start pattern "
+                "in the options and reload the file." ) );
+        return false;
+    }
+
+    if ( isEnabled == logFilteredData_->isRecordMode() ) {
+        return true;
+    }
+
+    logFilteredData_->setRecordMode( isEnabled );
+
+    if ( levelFilter_ ) {
+        filterLogLevels( *levelFilter_ );
+    }
+    else if ( !searchLineEdit_->currentText().isEmpty() ) {
+        replaceCurrentSearch( searchLineEdit_->currentText() );
+    }
+
+    return true;
+}
+
+void CrawlerWidget::showLogDiff( const QStringList& otherFileNames,
+                                 const std::vector<CrawlerWidget*>& otherCrawlers )
+{
+    klogg::vector<std::shared_ptr<const LogData>> otherLogData;
+    QList<QPointer<CrawlerWidget>> others;
+    for ( auto* crawler : otherCrawlers ) {
+        otherLogData.push_back( crawler->logData_ );
+        others.append( crawler );
+    }
+
+    auto* dialog
+        = new LogDiffDialog( logData_, otherFileNames, std::move( otherLogData ), this );
+    dialog->setAttribute( Qt::WA_DeleteOnClose );
+
+    connect( dialog, &LogDiffDialog::differencesFound, this,
+             [ this, others ]( int otherIndex, const SearchResultArray& onlyInThis,
+                               const SearchResultArray& onlyInOther ) {
+                 showIndexedLines( onlyInThis );
+                 // The other tab could have been closed while files were compared
+                 if ( otherIndex < others.size() && others[ otherIndex ] ) {
+                     others[ otherIndex ]->showIndexedLines( onlyInOther );
+                 }
+             } );
+
+    dialog->show();
+}
+
 //
 // Protected functions
 //
@@ -374,11 +552,15 @@ std::shared_ptr<const ViewContextInterface> CrawlerWidget::doGetViewContext() co
 
 void CrawlerWidget::startNewSearch()
 {
+    interruptTokenLines();
+
     if ( keepSearchResultsButton_->isChecked() ) {
         keepSearchResultsButton_->setChecked( false );
 
         logFilteredData_->interruptSearch();
+        const auto isRecordMode = logFilteredData_->isRecordMode();
         logFilteredData_ = logData_->getNewFilteredData();
+        logFilteredData_->setRecordMode( isRecordMode );
 
         filteredView_ = new FilteredView( logFilteredData_.get(), quickFindPattern_.get() );
         filteredViewsData_[ filteredView_ ] = logFilteredData_;
@@ -712,6 +894,14 @@ void CrawlerWidget::loadingFinishedHandler( LoadingStatus status )
             logFilteredData_->updateSearch( searchStartLine_, searchEndLine_ );
     }
 
+    // Level bitmaps are extended while indexing, so the filter only needs a refresh
+    if ( levelFilter_ && status == LoadingStatus::Successful ) {
+        if ( auto lines = logData_->linesOfLogLevels( *levelFilter_ ) ) {
+            nbMatches_ = 0_lcount;
+            logFilteredData_->setMatchingLines( std::move( *lines ) );
+        }
+    }
+
     // Set the encoding for the views
     updateEncoding();
 
@@ -1216,6 +1406,11 @@ void CrawlerWidget::setup()
     connect( logMainView_, QOverload<const QString&>::of( &LogMainView::excludeFromSearch ), this,
              &CrawlerWidget::excludeFromSearch );
 
+    connect( logMainView_, QOverload<const QString&>::of( &LogMainView::showTokenLines ), this,
+             &CrawlerWidget::showTokenLines );
+    connect( &tokenLinesWatcher_, &QFutureWatcher<std::optional<SearchResultArray>>::finished,
+             this, &CrawlerWidget::tokenLinesFound );
+
     connect( logMainView_, QOverload<const QString&>::of( &LogMainView::replaceSearch ), this,
              &CrawlerWidget::replaceSearch );
 
@@ -1374,6 +1569,9 @@ void CrawlerWidget::connectAllFilteredViewSlots( FilteredView* view )
     connect( view, QOverload<const QString&>::of( &FilteredView::excludeFromSearch ), this,
              &CrawlerWidget::excludeFromSearch );
 
+    connect( view, QOverload<const QString&>::of( &FilteredView::showTokenLines ), this,
+             &CrawlerWidget::showTokenLines );
+
     connect( view, QOverload<const QString&>::of( &FilteredView::replaceSearch ), this,
              &CrawlerWidget::replaceSearch );
 
@@ -1533,6 +1731,7 @@ void CrawlerWidget::loadIcons()
 void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
 {
     LOG_INFO << "replacing current search with " << searchText;
+    levelFilter_.reset();
     // Interrupt the search if it's ongoing
     logFilteredData_->interruptSearch();
 
@@ -1656,6 +1855,28 @@ void CrawlerWidget::printSearchInfoMessage( LinesCount nbMatches )
     searchInfoLine_->setVisible( !text.isEmpty() );
 }
 
+void CrawlerWidget::interruptTokenLines()
+{
+    if ( tokenLinesFuture_.isRunning() ) {
+        tokenLinesInterrupt_.set();
+        tokenLinesFuture_.waitForFinished();
+    }
+}
+
+void CrawlerWidget::showIndexedLines( SearchResultArray lines )
+{
+    using VisibilityFlags = LogFilteredData::VisibilityFlags;
+    if ( !filteredView_->visibility().testFlag( VisibilityFlags::Matches ) ) {
+        visibilityBox_->setCurrentIndex( 0 );
+    }
+
+    levelFilter_.reset();
+    searchState_.showIndexedResults();
+    // Make sure views are updated even if the number of lines is the same
+    nbMatches_ = 0_lcount;
+    logFilteredData_->setMatchingLines( std::move( lines ) );
+}
+
 // Change the data status and, if needed, advise upstream.
 void CrawlerWidget::changeDataStatus( DataStatus status )
 {
@@ -1782,6 +2003,11 @@ void CrawlerWidget::SearchState::startSearch()
         state_ = Static;
 }
 
+void CrawlerWidget::SearchState::showIndexedResults()
+{
+    state_ = Static;
+}
+
 /*
  * CrawlerWidgetContext
  */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exportcompression.h"
+
+#include <QCoreApplication>
+
+#ifdef KLOGG_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef KLOGG_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include "log.h"
+
+namespace {
+
+#ifdef KLOGG_HAS_ZLIB
+std::optional<QByteArray> compressGzip( const QByteArray& data, int level )
+{
+    z_stream stream{};
+    // 16 added to window bits makes zlib write gzip header and trailer
+    if ( deflateInit2( &stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) != Z_OK ) {
+        LOG_ERROR << "Failed to init gzip compression";
+        return std::nullopt;
+    }
+
+    QByteArray compressed(
+        static_cast<int>( deflateBound( &stream, static_cast<uLong>( data.size() ) ) ),
+        Qt::Uninitialized );
+
+    stream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data.constData() ) );
+    stream.avail_in = static_cast<uInt>( data.size() );
+    stream.next_out = reinterpret_cast<Bytef*>( compressed.data() );
+    stream.avail_out = static_cast<uInt>( compressed.size() );
+
+    const auto result = deflate( &stream, Z_FINISH );
+    deflateEnd( &stream );
+
+    if ( result != Z_STREAM_END ) {
+        LOG_ERROR << "Gzip compression failed: " << result;
+        return std::nullopt;
+    }
+
+    compressed.resize( static_cast<int>( stream.total_out ) );
+    return compressed;
+}
+#endif
+
+#ifdef KLOGG_HAS_ZSTD
+std::optional<QByteArray> compressZstd( const QByteArray& data, int level )
+{
+    QByteArray compressed( static_cast<int>( ZSTD_compressBound( static_cast<size_t>( data.size() ) ) ),
+                           Qt::Uninitialized );
+
+    const auto compressedSize
+        = ZSTD_compress( compressed.data(), static_cast<size_t>( compressed.size() ),
+                         data.constData(), static_cast<size_t>( data.size() ), level );
+
+    if ( ZSTD_isError( compressedSize ) ) {
+        LOG_ERROR << "Zstd compression failed: " << ZSTD_getErrorName( compressedSize );
+        return std::nullopt;
+    }
+
+    compressed.resize( static_cast<int>( compressedSize ) );
+    return compressed;
+}
+#endif
+
+QString fileSuffix( ExportCompression compression )
+{
+    switch ( compression ) {
+    case ExportCompression::Gzip:
+        return ".gz";
+    case ExportCompression::Zstd:
+        return ".zst";
+    case ExportCompression::None:
+        break;
+    }
+    return {};
+}
+
+} // namespace
+
+std::vector<ExportCompression> availableExportCompressions()
+{
+    std::vector<ExportCompression> compressions{ ExportCompression::None };
+#ifdef KLOGG_HAS_ZLIB
+    compressions.push_back( ExportCompression::Gzip );
+#endif
+#ifdef KLOGG_HAS_ZSTD
+    compressions.push_back( ExportCompression::Zstd );
+#endif
+    return compressions;
+}
+
+QString exportNameFilter( ExportCompression compression )
+{
+    switch ( compression ) {
+    case ExportCompression::Gzip:
+        return QCoreApplication::translate( "ExportCompression", "Gzip compressed (*.gz)" );
+    case ExportCompression::Zstd:
+        return QCoreApplication::translate( "ExportCompression", "Zstandard compressed (*.zst)" );
+    case ExportCompression::None:
+        break;
+    }
+    return QCoreApplication::translate( "ExportCompression", "All files (*)" );
+}
+
+ExportCompression exportCompressionForFile( const QString& fileName,
+                                            const QString& selectedFilter )
+{
+    for ( const auto compression : availableExportCompressions() ) {
+        if ( compression != ExportCompression::None
+             && ( selectedFilter == exportNameFilter( compression )
+                  || fileName.endsWith( fileSuffix( compression ), Qt::CaseInsensitive ) ) ) {
+            return compression;
+        }
+    }
+    return ExportCompression::None;
+}
+
+int minCompressionLevel( ExportCompression compression )
+{
+    return compression == ExportCompression::None ? 0 : 1;
+}
+
+int maxCompressionLevel( ExportCompression compression )
+{
+    switch ( compression ) {
+    case ExportCompression::Gzip:
+        return 9;
+    case ExportCompression::Zstd:
+        return 19;
+    case ExportCompression::None:
+        break;
+    }
+    return 0;
+}
+
+int defaultCompressionLevel( ExportCompression compression )
+{
+    switch ( compression ) {
+    case ExportCompression::Gzip:
+        return 6;
+    case ExportCompression::Zstd:
+        return 3;
+    case ExportCompression::None:
+        break;
+    }
+    return 0;
+}
+
+std::optional<QByteArray> compressChunk( ExportCompression compression, const QByteArray& data, int level )
+{
+    switch ( compression ) {
+#ifdef KLOGG_HAS_ZLIB
+    case ExportCompression::Gzip:
+        return compressGzip( data, level );
+#endif
+#ifdef KLOGG_HAS_ZSTD
+    case ExportCompression::Zstd:
+        return compressZstd( data, level );
+#endif
+    default:
+        Q_UNUSED( level );
+        return data;
+    }
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fieldaggregationdialog.h"
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include "log.h"
+#include "logdata.h"
+
+FieldAggregationDialog::FieldAggregationDialog( std::shared_ptr<const LogData> logData,
+                                                std::optional<SearchResultArray> matchingLines,
+                                                LineNumber startLine, LineNumber endLine,
+                                                QWidget* parent )
+    : QDialog( parent )
+    , logData_( std::move( logData ) )
+    , matchingLines_( std::move( matchingLines ) )
+    , startLine_( startLine )
+    , endLine_( endLine )
+    , extractorType_( new QComboBox( this ) )
+    , expression_( new QLineEdit( this ) )
+    , caseSensitive_( new QCheckBox( tr( "Match case" ), this ) )
+    , onlyMatches_( new QCheckBox( tr( "Only lines matching current search" ), this ) )
+    , maxValues_( new QSpinBox( this ) )
+    , runButton_( new QPushButton( tr( "Count" ), this ) )
+    , searchButton_( new QPushButton( tr( "Search for value" ), this ) )
+    , progressBar_( new QProgressBar( this ) )
+    , summary_( new QLabel( this ) )
+    , valuesTable_( new QTableWidget( this ) )
+{
+    setWindowTitle( tr( "Aggregate field values" ) );
+
+    extractorType_->addItem( tr( "Regular expression capture" ) );
+    extractorType_->addItem( tr( "JSON field" ) );
+
+    expression_->setPlaceholderText( tr( "e.g. status=(\\d+) or request.host" ) );
+    caseSensitive_->setChecked( true );
+
+    onlyMatches_->setEnabled( matchingLines_.has_value() );
+    onlyMatches_->setChecked( matchingLines_.has_value() );
+
+    maxValues_->setRange( 1, 100000 );
+    maxValues_->setValue( 20 );
+
+    valuesTable_->setColumnCount( 3 );
+    valuesTable_->setHorizontalHeaderLabels( { tr( "Value" ), tr( "Count" ), tr( "Share" ) } );
+    valuesTable_->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    valuesTable_->setSelectionBehavior( QAbstractItemView::SelectRows );
+    valuesTable_->setSelectionMode( QAbstractItemView::SingleSelection );
+    valuesTable_->verticalHeader()->setVisible( false );
+    valuesTable_->horizontalHeader()->setSectionResizeMode( 0, QHeaderView::Stretch );
+    valuesTable_->setSortingEnabled( true );
+
+    progressBar_->setRange( 0, 100 );
+    progressBar_->hide();
+
+    searchButton_->setEnabled( false );
+
+    auto* formLayout = new QFormLayout;
+    formLayout->addRow( tr( "Extract:" ), extractorType_ );
+    formLayout->addRow( tr( "Expression:" ), expression_ );
+    formLayout->addRow( tr( "Top values:" ), maxValues_ );
+    formLayout->addRow( caseSensitive_ );
+    formLayout->addRow( onlyMatches_ );
+
+    auto* buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addWidget( runButton_ );
+    buttonsLayout->addWidget( searchButton_ );
+    buttonsLayout->addStretch();
+
+    auto* buttonBox = new QDialogButtonBox( QDialogButtonBox::Close, this );
+    connect( buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject );
+
+    auto* layout = new QVBoxLayout( this );
+    layout->addLayout( formLayout );
+    layout->addLayout( buttonsLayout );
+    layout->addWidget( progressBar_ );
+    layout->addWidget( summary_ );
+    layout->addWidget( valuesTable_ );
+    layout->addWidget( buttonBox );
+
+    connect( extractorType_, QOverload<int>::of( &QComboBox::currentIndexChanged ), this,
+             [ this ]( int index ) { caseSensitive_->setEnabled( index == 0 ); } );
+    connect( expression_, &QLineEdit::returnPressed, this,
+             &FieldAggregationDialog::startAggregation );
+    connect( runButton_, &QPushButton::clicked, this, &FieldAggregationDialog::startAggregation );
+    connect( searchButton_, &QPushButton::clicked, this, &FieldAggregationDialog::requestSearch );
+    connect( valuesTable_, &QTableWidget::itemDoubleClicked, this,
+             &FieldAggregationDialog::requestSearch );
+    connect( valuesTable_, &QTableWidget::itemSelectionChanged, this, [ this ] {
+        searchButton_->setEnabled( !valuesTable_->selectedItems().isEmpty() );
+    } );
+    connect( &watcher_, &QFutureWatcher<FieldAggregationResult>::finished, this,
+             &FieldAggregationDialog::aggregationFinished );
+
+    resize( 560, 480 );
+}
+
+FieldAggregationDialog::~FieldAggregationDialog()
+{
+    interruptAggregation();
+}
+
+void FieldAggregationDialog::interruptAggregation()
+{
+    if ( future_.isRunning() ) {
+        interruptRequested_.set();
+        future_.waitForFinished();
+    }
+}
+
+void FieldAggregationDialog::startAggregation()
+{
+    interruptAggregation();
+    interruptRequested_.clear();
+
+    FieldExtractor extractor;
+    extractor.type = extractorType_->currentIndex() == 0 ? FieldExtractor::Type::RegexCapture
+                                                         : FieldExtractor::Type::JsonField;
+    extractor.expression = expression_->text();
+    extractor.isCaseSensitive = caseSensitive_->isChecked();
+
+    LinesSelection range{ startLine_, endLine_, {} };
+    if ( onlyMatches_->isChecked() ) {
+        range.lines = matchingLines_;
+    }
+
+    const auto maxValues = static_cast<size_t>( maxValues_->value() );
+
+    runButton_->setEnabled( false );
+    progressBar_->setValue( 0 );
+    progressBar_->show();
+    summary_->clear();
+
+    future_ = QtConcurrent::run( [ this, logData = logData_, extractor, range = std::move( range ),
+                                   maxValues ] {
+        return aggregateField( *logData, extractor, range, maxValues, interruptRequested_,
+                               [ this ]( int progress ) {
+                                   QMetaObject::invokeMethod(
+                                       progressBar_,
+                                       [ this, progress ] { progressBar_->setValue( progress ); },
+                                       Qt::QueuedConnection );
+                               } );
+    } );
+    watcher_.setFuture( future_ );
+}
+
+void FieldAggregationDialog::aggregationFinished()
+{
+    runButton_->setEnabled( true );
+    progressBar_->hide();
+
+    const auto result = future_.result();
+    if ( result.isInterrupted ) {
+        return;
+    }
+
+    if ( !result.error.isEmpty() ) {
+        summary_->setText( tr( "Invalid expression: %1" ).arg( result.error ) );
+        return;
+    }
+
+    summary_->setText( tr( "%1 of %2 lines have a value, %3 distinct values" )
+                           .arg( result.linesWithValue )
+                           .arg( result.processedLines )
+                           .arg( result.distinctValues ) );
+
+    valuesTable_->setSortingEnabled( false );
+    valuesTable_->setRowCount( static_cast<int>( result.values.size() ) );
+
+    int row = 0;
+    for ( const auto& value : result.values ) {
+        auto* countItem = new QTableWidgetItem;
+        countItem->setData( Qt::DisplayRole, static_cast<qulonglong>( value.count ) );
+
+        auto* shareItem = new QTableWidgetItem;
+        shareItem->setData( Qt::DisplayRole,
+                            result.linesWithValue > 0
+                                ? 100.0 * static_cast<double>( value.count )
+                                      / static_cast<double>( result.linesWithValue )
+                                : 0.0 );
+
+        valuesTable_->setItem( row, 0, new QTableWidgetItem( value.value ) );
+        valuesTable_->setItem( row, 1, countItem );
+        valuesTable_->setItem( row, 2, shareItem );
+        ++row;
+    }
+
+    valuesTable_->setSortingEnabled( true );
+    valuesTable_->sortByColumn( 1, Qt::DescendingOrder );
+}
+
+void FieldAggregationDialog::requestSearch()
+{
+    const auto selectedRow = valuesTable_->currentRow();
+    if ( selectedRow < 0 ) {
+        return;
+    }
+
+    const auto* valueItem = valuesTable_->item( selectedRow, 0 );
+    if ( valueItem != nullptr ) {
+        LOG_INFO << "Search for aggregated value " << valueItem->text();
+        Q_EMIT searchRequested( valueItem->text() );
+    }
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logdiffdialog.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include "log.h"
+#include "logdata.h"
+
+LogDiffDialog::LogDiffDialog( std::shared_ptr<const LogData> logData,
+                              const QStringList& otherFileNames,
+                              klogg::vector<std::shared_ptr<const LogData>> otherLogData,
+                              QWidget* parent )
+    : QDialog( parent )
+    , logData_( std::move( logData ) )
+    , otherLogData_( std::move( otherLogData ) )
+    , otherFile_( new QComboBox( this ) )
+    , mode_( new QComboBox( this ) )
+    , maskPattern_( new QLineEdit( this ) )
+    , runButton_( new QPushButton( tr( "Compare" ), this ) )
+    , progressBar_( new QProgressBar( this ) )
+    , summary_( new QLabel( this ) )
+{
+    setWindowTitle( tr( "Compare files" ) );
+
+    otherFile_->addItems( otherFileNames );
+
+    mode_->addItem( tr( "Align lines" ), static_cast<int>( LogDiffMode::Aligned ) );
+    mode_->addItem( tr( "Ignore line order" ), static_cast<int>( LogDiffMode::Lines ) );
+    mode_->setToolTip( tr( "Aligned comparison reports lines inserted or removed at their "
+                           "position, otherwise a line differs only if its content is "
+                           "absent from the other file" ) );
+
+    maskPattern_->setPlaceholderText( tr( "e.g. ^\\S+ \\S+ to ignore timestamps" ) );
+    maskPattern_->setToolTip(
+        tr( "Text matching this regular expression is ignored when lines are compared" ) );
+
+    progressBar_->setRange( 0, 100 );
+    progressBar_->hide();
+
+    runButton_->setEnabled( !otherLogData_.empty() );
+
+    auto* formLayout = new QFormLayout;
+    formLayout->addRow( tr( "Compare with:" ), otherFile_ );
+    formLayout->addRow( tr( "Mode:" ), mode_ );
+    formLayout->addRow( tr( "Ignore pattern:" ), maskPattern_ );
+
+    auto* buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addWidget( runButton_ );
+    buttonsLayout->addStretch();
+
+    auto* buttonBox = new QDialogButtonBox( QDialogButtonBox::Close, this );
+    connect( buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject );
+
+    auto* layout = new QVBoxLayout( this );
+    layout->addLayout( formLayout );
+    layout->addLayout( buttonsLayout );
+    layout->addWidget( progressBar_ );
+    layout->addWidget( summary_ );
+    layout->addStretch();
+    layout->addWidget( buttonBox );
+
+    connect( runButton_, &QPushButton::clicked, this, &LogDiffDialog::startComparison );
+    connect( &watcher_, &QFutureWatcher<LogDiffResult>::finished, this,
+             &LogDiffDialog::comparisonFinished );
+
+    resize( 560, 220 );
+}
+
+LogDiffDialog::~LogDiffDialog()
+{
+    interruptComparison();
+}
+
+void LogDiffDialog::interruptComparison()
+{
+    if ( future_.isRunning() ) {
+        interruptRequested_.set();
+        future_.waitForFinished();
+    }
+}
+
+void LogDiffDialog::startComparison()
+{
+    const auto otherIndex = otherFile_->currentIndex();
+    if ( otherIndex < 0 || static_cast<size_t>( otherIndex ) >= otherLogData_.size() ) {
+        return;
+    }
+
+    LogDiffParameters parameters;
+    parameters.mode = static_cast<LogDiffMode>( mode_->currentData().toInt() );
+    parameters.maskPattern = maskPattern_->text();
+
+    if ( !parameters.maskPattern.isEmpty() ) {
+        const QRegularExpression mask( parameters.maskPattern );
+        if ( !mask.isValid() ) {
+            summary_->setText( tr( "Invalid ignore pattern: %1" ).arg( mask.errorString() ) );
+            return;
+        }
+    }
+
+    interruptComparison();
+    interruptRequested_.clear();
+    comparedIndex_ = otherIndex;
+
+    runButton_->setEnabled( false );
+    progressBar_->setValue( 0 );
+    progressBar_->show();
+    summary_->clear();
+
+    future_ = QtConcurrent::run( [ this, logData = logData_,
+                                   otherLogData = otherLogData_[ static_cast<size_t>( otherIndex ) ],
+                                   parameters ] {
+        return diffLogs( *logData, *otherLogData, parameters, interruptRequested_,
+                         [ this ]( int progress ) {
+                             QMetaObject::invokeMethod(
+                                 progressBar_,
+                                 [ this, progress ] { progressBar_->setValue( progress ); },
+                                 Qt::QueuedConnection );
+                         } );
+    } );
+    watcher_.setFuture( future_ );
+}
+
+void LogDiffDialog::comparisonFinished()
+{
+    runButton_->setEnabled( true );
+    progressBar_->hide();
+
+    const auto result = future_.result();
+    if ( result.isInterrupted ) {
+        return;
+    }
+
+    summary_->setText( tr( "%1 lines only in this file, %2 lines only in the other file" )
+                           .arg( result.onlyInFirst.cardinality() )
+                           .arg( result.onlyInSecond.cardinality() ) );
+
+    LOG_INFO << "Files differ in " << result.onlyInFirst.cardinality() << " and "
+             << result.onlyInSecond.cardinality() << " lines";
+
+    Q_EMIT differencesFound( comparedIndex_, result.onlyInFirst, result.onlyInSecond );
+}
@@ -59,6 +59,7 @@
 #include <QClipboard>
 #include <QCloseEvent>
 #include <QDialogButtonBox>
+#include <QDockWidget>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QInputDialog>
@@ -82,6 +83,7 @@
 
 #include "mainwindow.h"
 
+#include "binarycontent.h"
 #include "clipboard.h"
 #include "crawlerwidget.h"
 #include "decompressor.h"
@@ -95,8 +97,11 @@
 #include "klogg_version.h"
 #include "logger.h"
 #include "mainwindowtext.h"
+#include "memorygovernor.h"
+#include "memoryusagedialog.h"
 #include "openfilehelper.h"
 #include "optionsdialog.h"
+#include "performancedashboard.h"
 #include "predefinedfiltersdialog.h"
 #include "progress.h"
 #include "readablesize.h"
@@ -105,6 +110,7 @@
 #include "shortcuts.h"
 #include "styles.h"
 #include "tabbedcrawlerwidget.h"
+#include "tracing.h"
 
 namespace {
 
@@ -305,6 +311,8 @@ void MainWindow::reTranslateUI()
     viewMenu->setTitle( transMenu( menu::viewTitle ) );
     openedFilesMenu->setTitle( transMenu( menu::openedFilesTitle ) );
     toolsMenu->setTitle( transMenu( menu::toolsTitle ) );
+    duplicateLinesMenu->setTitle( transMenu( menu::duplicateLinesTitle ) );
+    logLevelsMenu->setTitle( transMenu( menu::logLevelsTitle ) );
     highlightersMenu->setTitle( transMenu( menu::highlightersTitle ) );
     favoritesMenu->setTitle( transMenu( menu::favoritesTitle ) );
     helpMenu->setTitle( transMenu( menu::helpTitle ) );
@@ -403,6 +411,14 @@ void MainWindow::reTranslateUI()
     generateDumpAction->setText( transAction( action::generateDumpText ) );
     generateDumpAction->setStatusTip( transAction( action::generateDumpStatusTip ) );
 
+    aboutMemoryAction->setText( transAction( action::aboutMemoryText ) );
+    aboutMemoryAction->setStatusTip( transAction( action::aboutMemoryStatusTip ) );
+
+    performanceDock_->setWindowTitle( transAction( action::performanceDashboardText ) );
+
+    recordTraceAction->setText( transAction( action::recordTraceText ) );
+    recordTraceAction->setStatusTip( transAction( action::recordTraceStatusTip ) );
+
     showScratchPadAction->setText( transAction( action::showScratchPadText ) );
     showScratchPadAction->setStatusTip( transAction( action::showScratchPadStatusTip ) );
 
@@ -420,6 +436,28 @@ void MainWindow::reTranslateUI()
     predefinedFiltersDialogAction->setStatusTip(
         transAction( action::predefinedFiltersDialogStatusTip ) );
 
+    aggregateFieldAction->setText( transAction( action::aggregateFieldText ) );
+    aggregateFieldAction->setStatusTip( transAction( action::aggregateFieldStatusTip ) );
+    mineTemplatesAction->setText( transAction( action::mineTemplatesText ) );
+    mineTemplatesAction->setStatusTip( transAction( action::mineTemplatesStatusTip ) );
+    compareFilesAction->setText( transAction( action::compareFilesText ) );
+    compareFilesAction->setStatusTip( transAction( action::compareFilesStatusTip ) );
+    collapseRepeatedLinesAction->setText( transAction( action::collapseRepeatedLinesText ) );
+    collapseRepeatedLinesAction->setStatusTip(
+        transAction( action::collapseRepeatedLinesStatusTip ) );
+    firstOccurrencesAction->setText( transAction( action::firstOccurrencesText ) );
+    firstOccurrencesAction->setStatusTip( transAction( action::firstOccurrencesStatusTip ) );
+    newLinesSinceAction->setText( transAction( action::newLinesSinceText ) );
+    newLinesSinceAction->setStatusTip( transAction( action::newLinesSinceStatusTip ) );
+    errorsOnlyAction->setText( transAction( action::errorsOnlyText ) );
+    errorsOnlyAction->setStatusTip( transAction( action::errorsOnlyStatusTip ) );
+    warningsAndErrorsAction->setText( transAction( action::warningsAndErrorsText ) );
+    warningsAndErrorsAction->setStatusTip( transAction( action::warningsAndErrorsStatusTip ) );
+    infoAndAboveAction->setText( transAction( action::infoAndAboveText ) );
+    infoAndAboveAction->setStatusTip( transAction( action::infoAndAboveStatusTip ) );
+    recordModeAction->setText( transAction( action::recordModeText ) );
+    recordModeAction->setStatusTip( transAction( action::recordModeStatusTip ) );
+
     // trayIcon
     trayIcon_->setToolTip( QApplication::translate( "klogg::mainwindow::trayicon",
                                                     klogg::mainwindow::trayicon::trayiconTip ) );
@@ -634,6 +672,25 @@ void MainWindow::createActions()
     connect( generateDumpAction, &QAction::triggered, this,
              [ this ]( auto ) { this->generateDump(); } );
 
+    aboutMemoryAction = new QAction( tr( action::aboutMemoryText ), this );
+    aboutMemoryAction->setStatusTip( tr( action::aboutMemoryStatusTip ) );
+    connect( aboutMemoryAction, &QAction::triggered, this,
+             [ this ]( auto ) { this->aboutMemory(); } );
+
+    // Dashboard samples counters only while the dock is visible
+    performanceDock_ = new QDockWidget( tr( action::performanceDashboardText ), this );
+    performanceDock_->setObjectName( "performanceDashboard" );
+    performanceDock_->setWidget( new PerformanceDashboard( performanceDock_ ) );
+    addDockWidget( Qt::RightDockWidgetArea, performanceDock_ );
+    performanceDock_->hide();
+
+    recordTraceAction = new QAction( tr( action::recordTraceText ), this );
+    recordTraceAction->setStatusTip( tr( action::recordTraceStatusTip ) );
+    recordTraceAction->setCheckable( true );
+    recordTraceAction->setChecked( tracing::isEnabled() );
+    connect( recordTraceAction, &QAction::toggled, this,
+             [ this ]( bool isChecked ) { this->recordTrace( isChecked ); } );
+
     showScratchPadAction = new QAction( tr( action::showScratchPadText ), this );
     showScratchPadAction->setStatusTip( tr( action::showScratchPadStatusTip ) );
     connect( showScratchPadAction, &QAction::triggered, this,
@@ -670,6 +727,85 @@ void MainWindow::createActions()
     connect( predefinedFiltersDialogAction, &QAction::triggered, this,
              [ this ]( auto ) { this->editPredefinedFilters(); } );
 
+    aggregateFieldAction = new QAction( tr( action::aggregateFieldText ), this );
+    aggregateFieldAction->setStatusTip( tr( action::aggregateFieldStatusTip ) );
+    aggregateFieldAction->setEnabled( false );
+    connect( aggregateFieldAction, &QAction::triggered, this, [ this ]( auto ) {
+        if ( auto crawler = currentCrawlerWidget() ) {
+            crawler->showFieldAggregation();
+        }
+    } );
+
+    mineTemplatesAction = new QAction( tr( action::mineTemplatesText ), this );
+    mineTemplatesAction->setStatusTip( tr( action::mineTemplatesStatusTip ) );
+    mineTemplatesAction->setEnabled( false );
+    connect( mineTemplatesAction, &QAction::triggered, this, [ this ]( auto ) {
+        if ( auto crawler = currentCrawlerWidget() ) {
+            crawler->showTemplateMining();
+        }
+    } );
+
+    compareFilesAction = new QAction( tr( action::compareFilesText ), this );
+    compareFilesAction->setStatusTip( tr( action::compareFilesStatusTip ) );
+    compareFilesAction->setEnabled( false );
+    connect( compareFilesAction, &QAction::triggered, this, [ this ]( auto ) { compareFiles(); } );
+
+    auto createDuplicatesFilterAction = [ this ]( const char* text, const char* statusTip,
+                                                  DuplicateLinesFilter filter ) {
+        auto* action = new QAction( tr( text ), this );
+        action->setStatusTip( tr( statusTip ) );
+        connect( action, &QAction::triggered, this, [ this, filter ]( auto ) {
+            if ( auto crawler = currentCrawlerWidget() ) {
+                crawler->filterDuplicateLines( filter );
+            }
+        } );
+        return action;
+    };
+
+    collapseRepeatedLinesAction = createDuplicatesFilterAction(
+        action::collapseRepeatedLinesText, action::collapseRepeatedLinesStatusTip,
+        DuplicateLinesFilter::CollapseRepeated );
+    firstOccurrencesAction = createDuplicatesFilterAction( action::firstOccurrencesText,
+                                                           action::firstOccurrencesStatusTip,
+                                                           DuplicateLinesFilter::FirstOccurrence );
+    newLinesSinceAction = createDuplicatesFilterAction(
+        action::newLinesSinceText, action::newLinesSinceStatusTip,
+        DuplicateLinesFilter::NewSinceLine );
+
+    auto createLogLevelsFilterAction
+        = [ this ]( const char* text, const char* statusTip, LogLevels levels ) {
+              auto* action = new QAction( tr( text ), this );
+              action->setStatusTip( tr( statusTip ) );
+              connect( action, &QAction::triggered, this, [ this, levels ]( auto ) {
+                  if ( auto crawler = currentCrawlerWidget() ) {
+                      crawler->filterLogLevels( levels );
+                  }
+              } );
+              return action;
+          };
+
+    errorsOnlyAction = createLogLevelsFilterAction(
+        action::errorsOnlyText, action::errorsOnlyStatusTip, LogLevel::Error );
+    warningsAndErrorsAction
+        = createLogLevelsFilterAction( action::warningsAndErrorsText,
+                                       action::warningsAndErrorsStatusTip,
+                                       LogLevel::Warning | LogLevel::Error );
+    infoAndAboveAction = createLogLevelsFilterAction(
+        action::infoAndAboveText, action::infoAndAboveStatusTip,
+        LogLevel::Info | LogLevel::Warning | LogLevel::Error );
+
+    recordModeAction = new QAction( tr( action::recordModeText ), this );
+    recordModeAction->setStatusTip( tr( action::recordModeStatusTip ) );
+    recordModeAction->setCheckable( true );
+    recordModeAction->setEnabled( false );
+    connect( recordModeAction, &QAction::triggered, this, [ this ]( bool isChecked ) {
+        if ( auto crawler = currentCrawlerWidget() ) {
+            if ( !crawler->setRecordModeEnabled( isChecked ) ) {
+                recordModeAction->setChecked( false );
+            }
+        }
+    } );
+
     updateShortcuts();
 }
 
@@ -782,6 +918,7 @@ void MainWindow::createMenus()
     openedFilesMenu = viewMenu->addMenu( tr( menu::openedFilesTitle ) );
     viewMenu->addSeparator();
     viewMenu->addAction( overviewVisibleAction );
+    viewMenu->addAction( performanceDock_->toggleViewAction() );
     viewMenu->addSeparator();
     viewMenu->addAction( lineNumbersVisibleInMainAction );
     viewMenu->addAction( lineNumbersVisibleInFilteredAction );
@@ -804,6 +941,23 @@ void MainWindow::createMenus()
     } );
 
     toolsMenu->addAction( predefinedFiltersDialogAction );
+    toolsMenu->addAction( aggregateFieldAction );
+    toolsMenu->addAction( mineTemplatesAction );
+    toolsMenu->addAction( compareFilesAction );
+
+    duplicateLinesMenu = toolsMenu->addMenu( tr( menu::duplicateLinesTitle ) );
+    duplicateLinesMenu->setEnabled( false );
+    duplicateLinesMenu->addAction( collapseRepeatedLinesAction );
+    duplicateLinesMenu->addAction( firstOccurrencesAction );
+    duplicateLinesMenu->addAction( newLinesSinceAction );
+
+    logLevelsMenu = toolsMenu->addMenu( tr( menu::logLevelsTitle ) );
+    logLevelsMenu->setEnabled( false );
+    logLevelsMenu->addAction( errorsOnlyAction );
+    logLevelsMenu->addAction( warningsAndErrorsAction );
+    logLevelsMenu->addAction( infoAndAboveAction );
+
+    toolsMenu->addAction( recordModeAction );
 
     toolsMenu->addSeparator();
     toolsMenu->addAction( showScratchPadAction );
@@ -822,6 +976,8 @@ void MainWindow::createMenus()
     helpMenu->addAction( joinTelegramAction );
     helpMenu->addSeparator();
     helpMenu->addAction( generateDumpAction );
+    helpMenu->addAction( aboutMemoryAction );
+    helpMenu->addAction( recordTraceAction );
     helpMenu->addSeparator();
     helpMenu->addAction( aboutQtAction );
     helpMenu->addAction( aboutAction );
@@ -1193,6 +1349,8 @@ void MainWindow::options()
         const auto& config = Configuration::get();
         logging::enableFileLogging( config.enableLogging(),
                                     static_cast<logging::LogLevel>( config.loggingLevel() ) );
+        MemoryGovernor::instance().setBudget( static_cast<uint64_t>( config.memoryBudgetMb() )
+                                              * 1024 * 1024 );
 
         newWindowAction->setVisible( config.allowMultipleWindows() );
         followAction->setEnabled( config.anyFileWatchEnabled() );
@@ -1452,8 +1610,21 @@ void MainWindow::closeTab( int index, ActionInitiator initiator )
     widget->stopLoading();
     mainTabWidget_.removeCrawler( index );
 
-    if ( initiator == ActionInitiator::User ) {
-        addRecentFile( session_.getFilename( widget ) );
+    const auto fileName = session_.getFilename( widget );
+
+    // Spool file of a stream is not reopened, its stream is not read anymore
+    const auto spooler = std::find_if(
+        streamSpoolers_.begin(), streamSpoolers_.end(),
+        [ &fileName ]( const auto& streamSpooler ) {
+            return streamSpooler->spoolFileName() == fileName;
+        } );
+
+    if ( spooler != streamSpoolers_.end() ) {
+        streamSpoolers_.erase( spooler );
+        QFile::remove( fileName );
+    }
+    else if ( initiator == ActionInitiator::User ) {
+        addRecentFile( fileName );
     }
 
     session_.close( widget );
@@ -1480,6 +1651,12 @@ void MainWindow::currentTabChanged( int index )
         updateFavoritesMenu();
 
         editMenu->setEnabled( true );
+        aggregateFieldAction->setEnabled( true );
+        mineTemplatesAction->setEnabled( true );
+        compareFilesAction->setEnabled( true );
+        duplicateLinesMenu->setEnabled( true );
+        logLevelsMenu->setEnabled( true );
+        recordModeAction->setEnabled( true );
     }
     else {
         // No tab left
@@ -1493,6 +1670,13 @@ void MainWindow::currentTabChanged( int index )
         updateTitleBar( QString() );
 
         editMenu->setEnabled( false );
+        aggregateFieldAction->setEnabled( false );
+        mineTemplatesAction->setEnabled( false );
+        compareFilesAction->setEnabled( false );
+        duplicateLinesMenu->setEnabled( false );
+        logLevelsMenu->setEnabled( false );
+        recordModeAction->setEnabled( false );
+        recordModeAction->setChecked( false );
         addToFavoritesAction->setEnabled( false );
         addToFavoritesMenuAction->setEnabled( false );
     }
@@ -1725,6 +1909,30 @@ bool MainWindow::extractAndLoadFile( const QString& fileName )
     return false;
 }
 
+// Copy the stream to a spool file in the temporary directory
+// and load the file in follow mode while it grows.
+bool MainWindow::spoolAndLoadStream( const QString& streamName )
+{
+    const auto spoolName = streamName == StreamSpooler::StdinName
+                               ? QString( "klogg_stdin" )
+                               : QString( "klogg_%1" ).arg( QFileInfo( streamName ).fileName() );
+
+    auto spooler = std::make_unique<StreamSpooler>(
+        streamName,
+        tempDir_.filePath( QString( "%1_%2.log" ).arg( spoolName ).arg( streamSpoolers_.size() ) ) );
+
+    if ( !spooler->start() ) {
+        QMessageBox::critical( this, tr( "klogg - stream" ),
+                               tr( "Could not create a spool file to read %1" ).arg( streamName ) );
+        return false;
+    }
+
+    const auto spoolFileName = spooler->spoolFileName();
+    streamSpoolers_.push_back( std::move( spooler ) );
+
+    return loadFile( spoolFileName, true );
+}
+
 // Create a CrawlerWidget for the passed file, start its loading
 // and update the title bar.
 // The loading is done asynchronously.
@@ -1732,6 +1940,11 @@ bool MainWindow::loadFile( const QString& fileName, bool followFile )
 {
     LOG_DEBUG << "loadFile ( " << fileName.toStdString() << " )";
 
+    // Pipes can't be seeked, they are copied to a file indexed as it grows
+    if ( StreamSpooler::isStream( fileName ) ) {
+        return spoolAndLoadStream( fileName );
+    }
+
     // First check if the file is already open...
     auto* existing_crawler = static_cast<CrawlerWidget*>( session_.getViewIfOpen( fileName ) );
 
@@ -1766,6 +1979,20 @@ bool MainWindow::loadFile( const QString& fileName, bool followFile )
                 return QString{};
             }();
 
+            // Indexing binary data takes long and shows little, files from
+            // the previous session were confirmed already
+            if ( previousViewContext.isEmpty() && Configuration::get().detectBinaryContent()
+                 && isBinaryFile( fileName ) ) {
+                const auto userAction = QMessageBox::question(
+                    this, tr( "klogg - binary file" ),
+                    tr( "File %1 looks like binary data. Open it anyway?" ).arg( fileName ),
+                    QMessageBox::Yes | QMessageBox::No, QMessageBox::No );
+
+                if ( userAction != QMessageBox::Yes ) {
+                    return false;
+                }
+            }
+
             CrawlerWidget* crawler_widget = static_cast<CrawlerWidget*>(
                 session_.open( fileName, []() { return new CrawlerWidget(); } ) );
 
@@ -1913,6 +2140,7 @@ void MainWindow::updateMenuBarFromDocument( const CrawlerWidget* crawler )
 
     followAction->setChecked( crawler->isFollowEnabled() );
     textWrapAction->setChecked( crawler->isTextWrapEnabled() );
+    recordModeAction->setChecked( crawler->isRecordModeEnabled() );
 }
 
 // Update the top info line from the session
@@ -2259,6 +2487,63 @@ void MainWindow::logScreenInfo( QScreen* screen )
     LOG_INFO << "screen physical dpi " << screen->physicalDotsPerInch();
 }
 
+void MainWindow::aboutMemory()
+{
+    MemoryUsageDialog dialog( this );
+    dialog.exec();
+}
+
+void MainWindow::recordTrace( bool isEnabled )
+{
+    if ( isEnabled ) {
+        tracing::clear();
+        tracing::setEnabled( true );
+        return;
+    }
+
+    tracing::setEnabled( false );
+
+    const auto fileName = QFileDialog::getSaveFileName(
+        this, tr( "Save performance trace" ),
+        QDir::home().filePath( QStringLiteral( "klogg_trace.json" ) ),
+        tr( "Chrome trace (*.json)" ) );
+
+    if ( fileName.isEmpty() ) {
+        return;
+    }
+
+    if ( !tracing::writeChromeTrace( fileName ) ) {
+        QMessageBox::critical( this, tr( "klogg - save performance trace" ),
+                               tr( "Failed to write %1" ).arg( fileName ) );
+    }
+}
+
+void MainWindow::compareFiles()
+{
+    auto* current = currentCrawlerWidget();
+    if ( current == nullptr ) {
+        return;
+    }
+
+    QStringList otherFileNames;
+    std::vector<CrawlerWidget*> otherCrawlers;
+    for ( int i = 0; i < mainTabWidget_.count(); ++i ) {
+        auto* crawler = qobject_cast<CrawlerWidget*>( mainTabWidget_.widget( i ) );
+        if ( crawler != nullptr && crawler != current ) {
+            otherFileNames.append( session_.getFilename( crawler ) );
+            otherCrawlers.push_back( crawler );
+        }
+    }
+
+    if ( otherCrawlers.empty() ) {
+        QMessageBox::information( this, tr( "klogg - compare files" ),
+                                  tr( "Open another file to compare with." ) );
+        return;
+    }
+
+    current->showLogDiff( otherFileNames, otherCrawlers );
+}
+
 void MainWindow::generateDump()
 {
     const auto userAction = QMessageBox::warning(
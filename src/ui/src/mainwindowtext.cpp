@@ -14,6 +14,8 @@ const char* menu::editTitle = QT_TR_NOOP( "&Edit" );
 const char* menu::viewTitle = QT_TR_NOOP( "&View" );
 const char* menu::openedFilesTitle = QT_TR_NOOP( "Opened files" );
 const char* menu::toolsTitle = QT_TR_NOOP( "&Tools" );
+const char* menu::duplicateLinesTitle = QT_TR_NOOP( "Duplicate lines" );
+const char* menu::logLevelsTitle = QT_TR_NOOP( "Log levels" );
 const char* menu::highlightersTitle = QT_TR_NOOP( "Highlighters" );
 const char* menu::favoritesTitle = QT_TR_NOOP( "F&avorites" );
 const char* menu::helpTitle = QT_TR_NOOP( "&Help" );
@@ -88,6 +90,12 @@ const char* action::joinTelegramStatusTip
     = QT_TR_NOOP( "Join Klogg development community at Telegram" );
 const char* action::generateDumpText = QT_TR_NOOP( "Generate crash dump" );
 const char* action::generateDumpStatusTip = QT_TR_NOOP( "Generate diagnostic crash dump" );
+const char* action::aboutMemoryText = QT_TR_NOOP( "About memory..." );
+const char* action::aboutMemoryStatusTip = QT_TR_NOOP( "Show memory used by klogg subsystems" );
+const char* action::performanceDashboardText = QT_TR_NOOP( "Performance dashboard" );
+const char* action::recordTraceText = QT_TR_NOOP( "Record performance trace" );
+const char* action::recordTraceStatusTip
+    = QT_TR_NOOP( "Record indexing, search and painting timings to a Chrome trace file" );
 const char* action::showScratchPadText = QT_TR_NOOP( "Scratchpad" );
 const char* action::showScratchPadStatusTip = QT_TR_NOOP( "Show the scratchpad" );
 const char* action::addToFavoritesText = QT_TR_NOOP( "Add to favorites" );
@@ -96,6 +104,35 @@ const char* action::selectOpenFileText = QT_TR_NOOP( "Switch to opened file..."
 const char* action::predefinedFiltersDialogText = QT_TR_NOOP( "Predefined filters..." );
 const char* action::predefinedFiltersDialogStatusTip
     = QT_TR_NOOP( "Show dialog to configure filters" );
+const char* action::aggregateFieldText = QT_TR_NOOP( "Aggregate field values..." );
+const char* action::aggregateFieldStatusTip
+    = QT_TR_NOOP( "Count the most frequent values of a field in the search results" );
+const char* action::mineTemplatesText = QT_TR_NOOP( "Find message templates..." );
+const char* action::mineTemplatesStatusTip
+    = QT_TR_NOOP( "Group similar lines into message templates and count them" );
+const char* action::compareFilesText = QT_TR_NOOP( "Compare with opened file..." );
+const char* action::compareFilesStatusTip
+    = QT_TR_NOOP( "Show lines present only in one of two opened files" );
+const char* action::collapseRepeatedLinesText = QT_TR_NOOP( "Collapse repeated lines" );
+const char* action::collapseRepeatedLinesStatusTip
+    = QT_TR_NOOP( "Hide lines repeating the previous line" );
+const char* action::firstOccurrencesText = QT_TR_NOOP( "Show first occurrences only" );
+const char* action::firstOccurrencesStatusTip
+    = QT_TR_NOOP( "Show only the first line with each content" );
+const char* action::newLinesSinceText = QT_TR_NOOP( "Show lines new since current line" );
+const char* action::newLinesSinceStatusTip
+    = QT_TR_NOOP( "Show lines with content not seen before the current line" );
+const char* action::errorsOnlyText = QT_TR_NOOP( "Errors only" );
+const char* action::errorsOnlyStatusTip = QT_TR_NOOP( "Show only lines with error level" );
+const char* action::warningsAndErrorsText = QT_TR_NOOP( "Warnings and errors" );
+const char* action::warningsAndErrorsStatusTip
+    = QT_TR_NOOP( "Show only lines with warning or error level" );
+const char* action::infoAndAboveText = QT_TR_NOOP( "Info and above" );
+const char* action::infoAndAboveStatusTip
+    = QT_TR_NOOP( "Hide lines with debug or trace level and lines without level" );
+const char* action::recordModeText = QT_TR_NOOP( "Match whole records" );
+const char* action::recordModeStatusTip
+    = QT_TR_NOOP( "Show all lines of multi-line records containing a match" );
 const char* action::autoEncodingText = QT_TR_NOOP( "Auto" );
 const char* action::autoEncodingStatusTip
     = QT_TR_NOOP( "Automatically detect the file's encoding" );
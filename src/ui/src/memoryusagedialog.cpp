@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memoryusagedialog.h"
+
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include "memory_info.h"
+#include "memorygovernor.h"
+#include "readablesize.h"
+
+MemoryUsageDialog::MemoryUsageDialog( QWidget* parent )
+    : QDialog( parent )
+    , usageTable_( new QTableWidget( this ) )
+    , processUsageLabel_( new QLabel( this ) )
+    , budgetLabel_( new QLabel( this ) )
+{
+    setWindowTitle( tr( "About memory" ) );
+
+    usageTable_->setColumnCount( 3 );
+    usageTable_->setHorizontalHeaderLabels( { tr( "Subsystem" ), tr( "Live" ), tr( "Peak" ) } );
+    usageTable_->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    usageTable_->setSelectionMode( QAbstractItemView::NoSelection );
+    usageTable_->verticalHeader()->setVisible( false );
+    usageTable_->horizontalHeader()->setSectionResizeMode( 0, QHeaderView::Stretch );
+
+    auto* buttonBox = new QDialogButtonBox( QDialogButtonBox::Close, this );
+    connect( buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject );
+
+    auto* layout = new QVBoxLayout( this );
+    layout->addWidget( processUsageLabel_ );
+    layout->addWidget( budgetLabel_ );
+    layout->addWidget( usageTable_ );
+    layout->addWidget( buttonBox );
+
+    connect( &updateTimer_, &QTimer::timeout, this, &MemoryUsageDialog::updateUsage );
+    updateTimer_.start( 1000 );
+
+    updateUsage();
+    resize( 480, 320 );
+}
+
+void MemoryUsageDialog::updateUsage()
+{
+    const auto& governor = MemoryGovernor::instance();
+
+    processUsageLabel_->setText( tr( "Process: %1 used, %2 physical memory" )
+                                     .arg( readableSize( usedMemory() ),
+                                           readableSize( physicalMemory() ) ) );
+
+    const auto budget = governor.budget();
+    budgetLabel_->setText( tr( "Tracked: %1, budget: %2" )
+                               .arg( readableSize( governor.trackedUsage() ),
+                                     budget > 0 ? readableSize( budget ) : tr( "no limit" ) ) );
+
+    const auto usage = governor.usageBySubsystem();
+    usageTable_->setRowCount( static_cast<int>( usage.size() ) );
+
+    int row = 0;
+    for ( const auto& subsystem : usage ) {
+        usageTable_->setItem( row, 0, new QTableWidgetItem( subsystem.name ) );
+        usageTable_->setItem( row, 1, new QTableWidgetItem( readableSize( subsystem.live ) ) );
+        usageTable_->setItem( row, 2, new QTableWidgetItem( readableSize( subsystem.peak ) ) );
+        ++row;
+    }
+}
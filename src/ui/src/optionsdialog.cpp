@@ -69,6 +69,7 @@ OptionsDialog::OptionsDialog( QWidget* parent )
     setupStyles();
     setupEncodings();
     setupLanguageList();
+    setupPageCache();
 
     // Validators
     QValidator* pollingIntervalValidator = new QIntValidator( PollIntervalMin, PollIntervalMax );
@@ -79,6 +80,8 @@ OptionsDialog::OptionsDialog( QWidget* parent )
     connect( pollingCheckBox, &QCheckBox::toggled, [ this ]( auto ) { this->setupPolling(); } );
     connect( searchResultsCacheCheckBox, &QCheckBox::toggled,
              [ this ]( auto ) { this->setupSearchResultsCache(); } );
+    connect( splitLongLinesCheckBox, &QCheckBox::toggled,
+             [ this ]( auto ) { this->setupLongLineSplit(); } );
     connect( loggingCheckBox, &QCheckBox::toggled, [ this ]( auto ) { this->setupLogging(); } );
 
     connect( extractArchivesCheckBox, &QCheckBox::toggled,
@@ -99,6 +102,7 @@ OptionsDialog::OptionsDialog( QWidget* parent )
 
     setupPolling();
     setupSearchResultsCache();
+    setupLongLineSplit();
     setupLogging();
     setupArchives();
 }
@@ -148,6 +152,22 @@ void OptionsDialog::setupRegexp()
     regexpEngineComboBox->addItems( regexpEngines );
 }
 
+void OptionsDialog::setupPageCache()
+{
+    // Same order as PageCachePolicy
+    QStringList policies;
+    policies << tr( "Auto (drop files larger than a quarter of RAM)" ) << tr( "Keep cached" )
+             << tr( "Drop after reading" );
+
+    pageCachePolicyComboBox->addItems( policies );
+
+#ifndef Q_OS_LINUX
+    pageCachePolicyLabel->setVisible( false );
+    pageCachePolicyComboBox->setVisible( false );
+    directIndexReadsCheckBox->setVisible( false );
+#endif
+}
+
 void OptionsDialog::setupStyles()
 {
     styleComboBox->addItems( StyleManager::availableStyles() );
@@ -205,6 +225,11 @@ void OptionsDialog::setupSearchResultsCache()
     searchCacheSpinBox->setEnabled( searchResultsCacheCheckBox->isChecked() );
 }
 
+void OptionsDialog::setupLongLineSplit()
+{
+    longLineSplitSizeSpinBox->setEnabled( splitLongLinesCheckBox->isChecked() );
+}
+
 void OptionsDialog::setupLogging()
 {
     verbositySpinBox->setEnabled( loggingCheckBox->isChecked() );
@@ -358,10 +383,23 @@ void OptionsDialog::updateDialogFromConfig()
     parallelSearchCheckBox->setChecked( config.useParallelSearch() );
     searchResultsCacheCheckBox->setChecked( config.useSearchResultsCache() );
     searchCacheSpinBox->setValue( static_cast<int>( config.searchResultsCacheLines() ) );
+    memoryBudgetSpinBox->setValue( config.memoryBudgetMb() );
     indexReadBufferSpinBox->setValue( config.indexReadBufferSizeMb() );
     searchReadBufferSpinBox->setValue( config.searchReadBufferSizeLines() );
+    ioQueueDepthSpinBox->setValue( config.ioQueueDepth() );
+    pageCachePolicyComboBox->setCurrentIndex( static_cast<int>( config.pageCachePolicy() ) );
+    directIndexReadsCheckBox->setChecked( config.directIndexReads() );
     keepFileClosedCheckBox->setChecked( config.keepFileClosed() );
     compressedIndexCheckBox->setChecked( config.useCompressedIndex() );
+    lineHashesCheckBox->setChecked( config.indexLineHashes() );
+    logLevelsCheckBox->setChecked( config.indexLogLevels() );
+    logLevelSearchDepthSpinBox->setValue( config.logLevelSearchDepth() );
+    logLevelPatternLineEdit->setText( config.logLevelPattern() );
+    splitLongLinesCheckBox->setChecked( config.splitLongLines() );
+    longLineSplitSizeSpinBox->setValue( config.longLineSplitSizeKb() );
+    detectBinaryContentCheckBox->setChecked( config.detectBinaryContent() );
+    recordStartPatternLineEdit->setText( config.recordStartPattern() );
+    tokenIndexPatternLineEdit->setText( config.tokenIndexPattern() );
     optimizeForNotLatinEncodingsCheckBox->setChecked( config.optimizeForNotLatinEncodings() );
 
     // version checking
@@ -526,10 +564,24 @@ void OptionsDialog::updateConfigFromDialog()
     config.setUseParallelSearch( parallelSearchCheckBox->isChecked() );
     config.setUseSearchResultsCache( searchResultsCacheCheckBox->isChecked() );
     config.setSearchResultsCacheLines( static_cast<unsigned>( searchCacheSpinBox->value() ) );
+    config.setMemoryBudgetMb( memoryBudgetSpinBox->value() );
     config.setIndexReadBufferSizeMb( indexReadBufferSpinBox->value() );
     config.setSearchReadBufferSizeLines( searchReadBufferSpinBox->value() );
+    config.setIoQueueDepth( ioQueueDepthSpinBox->value() );
+    config.setPageCachePolicy(
+        static_cast<PageCachePolicy>( pageCachePolicyComboBox->currentIndex() ) );
+    config.setDirectIndexReads( directIndexReadsCheckBox->isChecked() );
     config.setKeepFileClosed( keepFileClosedCheckBox->isChecked() );
     config.setUseCompressedIndex( compressedIndexCheckBox->isChecked() );
+    config.setIndexLineHashes( lineHashesCheckBox->isChecked() );
+    config.setIndexLogLevels( logLevelsCheckBox->isChecked() );
+    config.setLogLevelSearchDepth( logLevelSearchDepthSpinBox->value() );
+    config.setLogLevelPattern( logLevelPatternLineEdit->text() );
+    config.setSplitLongLines( splitLongLinesCheckBox->isChecked() );
+    config.setLongLineSplitSizeKb( longLineSplitSizeSpinBox->value() );
+    config.setDetectBinaryContent( detectBinaryContentCheckBox->isChecked() );
+    config.setRecordStartPattern( recordStartPatternLineEdit->text() );
+    config.setTokenIndexPattern( tokenIndexPatternLineEdit->text() );
     config.setOptimizeForNotLatinEncodings( optimizeForNotLatinEncodingsCheckBox->isChecked() );
 
     // version checking
@@ -21,6 +21,8 @@
 // It provides support for drawing the match overview sidebar but
 // the actual drawing is done in AbstractLogView which uses this class.
 
+#include <algorithm>
+
 #include "linetypes.h"
 #include "log.h"
 
@@ -74,6 +76,11 @@ const klogg::vector<Overview::WeightedLine>* Overview::getMarkLines() const
     return &markLines_;
 }
 
+const klogg::vector<Overview::WeightedLine>* Overview::getLevelLines( LogLevel level ) const
+{
+    return level == LogLevel::Error ? &errorLines_ : &warningLines_;
+}
+
 std::pair<int, int> Overview::getViewLines() const
 {
     int top = 0;
@@ -142,9 +149,50 @@ void Overview::recalculatesLines()
                 }
             } );
         }
+
+        recalculateLevelLines( LogLevel::Error, errorLines_ );
+        recalculateLevelLines( LogLevel::Warning, warningLines_ );
     }
     else
         LOG_INFO << "Overview::recalculatesLines: logFilteredData_ == NULL";
 
     dirty_ = false;
 }
+
+// Counts level lines under every pixel with bitmap ranks instead of iterating lines
+void Overview::recalculateLevelLines( LogLevel level, klogg::vector<WeightedLine>& levelLines )
+{
+    levelLines.clear();
+
+    if ( linesInFile_.get() == 0 || height_ == 0 ) {
+        return;
+    }
+
+    klogg::vector<LineNumber> boundaries;
+    boundaries.reserve( height_ + 1 );
+    for ( auto y = 0u; y < height_; ++y ) {
+        boundaries.push_back( fileLineFromY( static_cast<int>( y ) ) );
+    }
+    boundaries.push_back( LineNumber( linesInFile_.get() ) );
+
+    const auto counts = logFilteredData_->countLogLevelLines( level, boundaries );
+    if ( !counts ) {
+        return;
+    }
+
+    const auto linesPerPixel = std::max( uint64_t{ 1 }, linesInFile_.get() / height_ );
+    for ( auto y = 0u; y < counts->size(); ++y ) {
+        const auto count = ( *counts )[ y ];
+        if ( count == 0 ) {
+            continue;
+        }
+
+        levelLines.emplace_back( static_cast<int>( y ) );
+        if ( count > 1 ) {
+            levelLines.back().load();
+        }
+        if ( count * 2 >= linesPerPixel ) {
+            levelLines.back().load();
+        }
+    }
+}
@@ -143,6 +143,8 @@ void OverviewWidget::paintEvent( QPaintEvent* /* paintEvent */ )
 {
     static const QColor match_color( "red" );
     static const QColor mark_color( "dodgerblue" );
+    static const QColor error_color( "orangered" );
+    static const QColor warning_color( "orange" );
 
     static const QPixmap highlight_pixmap[] = {
         QPixmap( highlight_xpm[ 0 ] ), QPixmap( highlight_xpm[ 1 ] ), QPixmap( highlight_xpm[ 2 ] ),
@@ -185,6 +187,19 @@ void OverviewWidget::paintEvent( QPaintEvent* /* paintEvent */ )
                               line.position() );
         }
 
+        // The log level bands in the left margin
+        const auto drawLevelLines = [ & ]( LogLevel level, const QColor& color ) {
+            painter.setPen( color );
+            const auto levelLines = *( overview_->getLevelLines( level ) );
+            for ( const auto& line : levelLines ) {
+                painter.setOpacity( ( 1.0 / Overview::WeightedLine::WEIGHT_STEPS )
+                                    * ( line.weight() + 1 ) );
+                painter.drawLine( 1, line.position(), LINE_MARGIN, line.position() );
+            }
+        };
+        drawLevelLines( LogLevel::Warning, warning_color );
+        drawLevelLines( LogLevel::Error, error_color );
+
         // The 'view' lines
         painter.setOpacity( 1 );
         painter.setPen( palette().color( QPalette::Text ) );
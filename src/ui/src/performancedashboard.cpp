@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performancedashboard.h"
+
+#include <algorithm>
+
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+#include "memorygovernor.h"
+#include "readablesize.h"
+
+namespace {
+
+QTableWidget* makeTable( const QStringList& headers, QWidget* parent )
+{
+    auto* table = new QTableWidget( parent );
+    table->setColumnCount( headers.size() );
+    table->setHorizontalHeaderLabels( headers );
+    table->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    table->setSelectionMode( QAbstractItemView::NoSelection );
+    table->verticalHeader()->setVisible( false );
+    table->horizontalHeader()->setSectionResizeMode( 0, QHeaderView::Stretch );
+    return table;
+}
+
+QString hitRate( uint64_t hits, uint64_t misses )
+{
+    const auto lookups = hits + misses;
+    if ( lookups == 0 ) {
+        return QObject::tr( "no lookups" );
+    }
+
+    return QObject::tr( "%1% of %2 lookups" )
+        .arg( 100.0 * static_cast<double>( hits ) / static_cast<double>( lookups ), 0, 'f', 1 )
+        .arg( lookups );
+}
+
+QString megabytesPerSecond( uint64_t bytes, double seconds )
+{
+    return QObject::tr( "%1 MiB/s" ).arg(
+        static_cast<double>( bytes ) / ( 1024 * 1024 ) / seconds, 0, 'f', 1 );
+}
+
+} // namespace
+
+PerformanceDashboard::PerformanceDashboard( QWidget* parent )
+    : QWidget( parent )
+    , indexingLabel_( new QLabel( this ) )
+    , searchCacheLabel_( new QLabel( this ) )
+    , textAreaCacheLabel_( new QLabel( this ) )
+    , followLagLabel_( new QLabel( this ) )
+    , fileReadingLabel_( new QLabel( this ) )
+    , searchesTable_( makeTable(
+          { tr( "Search" ), tr( "Lines/s" ), tr( "MiB/s" ), tr( "Matchers busy" ) }, this ) )
+    , memoryTable_( makeTable( { tr( "Subsystem" ), tr( "Live" ), tr( "Peak" ) }, this ) )
+{
+    auto* countersLayout = new QFormLayout;
+    countersLayout->addRow( tr( "Indexing:" ), indexingLabel_ );
+    countersLayout->addRow( tr( "Search results cache:" ), searchCacheLabel_ );
+    countersLayout->addRow( tr( "Text area cache:" ), textAreaCacheLabel_ );
+    countersLayout->addRow( tr( "Follow lag:" ), followLagLabel_ );
+    countersLayout->addRow( tr( "Last file reading:" ), fileReadingLabel_ );
+
+    auto* layout = new QVBoxLayout( this );
+    layout->addLayout( countersLayout );
+    layout->addWidget( searchesTable_ );
+    layout->addWidget( memoryTable_ );
+
+    connect( &updateTimer_, &QTimer::timeout, this, &PerformanceDashboard::updateCounters );
+}
+
+void PerformanceDashboard::showEvent( QShowEvent* event )
+{
+    QWidget::showEvent( event );
+
+    lastSnapshot_ = PerformanceCounters::instance().snapshot();
+    lastSnapshotTime_ = std::chrono::steady_clock::now();
+    updateTimer_.start( 1000 );
+}
+
+void PerformanceDashboard::hideEvent( QHideEvent* event )
+{
+    updateTimer_.stop();
+    QWidget::hideEvent( event );
+}
+
+void PerformanceDashboard::updateCounters()
+{
+    using namespace std::chrono;
+
+    auto snapshot = PerformanceCounters::instance().snapshot();
+    const auto now = steady_clock::now();
+    const auto seconds
+        = std::max( 0.001, duration_cast<duration<double>>( now - lastSnapshotTime_ ).count() );
+
+    indexingLabel_->setText(
+        megabytesPerSecond( snapshot.indexedBytes - lastSnapshot_.indexedBytes, seconds ) );
+
+    searchCacheLabel_->setText( hitRate( snapshot.searchCacheHits, snapshot.searchCacheMisses ) );
+    textAreaCacheLabel_->setText(
+        hitRate( snapshot.textAreaCacheHits, snapshot.textAreaCacheMisses ) );
+
+    followLagLabel_->setText( snapshot.followLagMs < 0
+                                  ? tr( "no updates yet" )
+                                  : tr( "%1 ms" ).arg( snapshot.followLagMs ) );
+
+    fileReadingLabel_->setText(
+        snapshot.readMegabytesPerSecond <= 0
+            ? tr( "nothing read yet" )
+            : tr( "%1 MiB/s, %2 reads in flight" )
+                  .arg( snapshot.readMegabytesPerSecond, 0, 'f', 1 )
+                  .arg( snapshot.readQueueDepth, 0, 'f', 1 ) );
+
+    updateSearches( snapshot, seconds );
+    updateMemory();
+
+    lastSnapshot_ = std::move( snapshot );
+    lastSnapshotTime_ = now;
+}
+
+void PerformanceDashboard::updateSearches( const PerformanceCounters::Snapshot& snapshot,
+                                           double seconds )
+{
+    searchesTable_->setRowCount( static_cast<int>( snapshot.searches.size() ) );
+
+    int row = 0;
+    for ( const auto& search : snapshot.searches ) {
+        // Searches started since the last update are measured from zero
+        const auto previous = std::find_if(
+            lastSnapshot_.searches.cbegin(), lastSnapshot_.searches.cend(),
+            [ &search ]( const auto& lastSearch ) { return lastSearch.id == search.id; } );
+        const auto hasPrevious = previous != lastSnapshot_.searches.cend();
+
+        const auto lines = search.lines - ( hasPrevious ? previous->lines : 0 );
+        const auto bytes = search.bytes - ( hasPrevious ? previous->bytes : 0 );
+        const auto matchingMicroseconds
+            = search.matchingMicroseconds - ( hasPrevious ? previous->matchingMicroseconds : 0 );
+
+        const auto busy = static_cast<double>( matchingMicroseconds )
+                          / ( seconds * 1e6 * std::max( 1u, search.matcherThreads ) );
+
+        searchesTable_->setItem( row, 0, new QTableWidgetItem( search.pattern ) );
+        searchesTable_->setItem( row, 1,
+                                 new QTableWidgetItem( QString::number(
+                                     static_cast<double>( lines ) / seconds, 'f', 0 ) ) );
+        searchesTable_->setItem( row, 2,
+                                 new QTableWidgetItem( megabytesPerSecond( bytes, seconds ) ) );
+        searchesTable_->setItem(
+            row, 3,
+            new QTableWidgetItem( tr( "%1% of %2" )
+                                      .arg( std::min( 100.0, 100.0 * busy ), 0, 'f', 0 )
+                                      .arg( search.matcherThreads ) ) );
+        ++row;
+    }
+}
+
+void PerformanceDashboard::updateMemory()
+{
+    const auto usage = MemoryGovernor::instance().usageBySubsystem();
+    memoryTable_->setRowCount( static_cast<int>( usage.size() ) );
+
+    int row = 0;
+    for ( const auto& subsystem : usage ) {
+        memoryTable_->setItem( row, 0, new QTableWidgetItem( subsystem.name ) );
+        memoryTable_->setItem( row, 1, new QTableWidgetItem( readableSize( subsystem.live ) ) );
+        memoryTable_->setItem( row, 2, new QTableWidgetItem( readableSize( subsystem.peak ) ) );
+        ++row;
+    }
+}
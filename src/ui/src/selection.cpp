@@ -170,20 +170,32 @@ QString Selection::getSelectedText( const AbstractLogData* logData, bool lineNum
 
     text.reserve( selectionSizeEstimate );
 
+    // Lines cut while indexing are joined back
+    auto index = selectedRange_.startLine.value_or( 0_lnum );
+    std::optional<LineNumber> continuedLine;
+
     for ( const auto& [ lineNumber, line ] : selectionData ) {
-        if ( !text.isEmpty() ) {
+        const auto isContinuation = continuedLine && *continuedLine + 1_lcount == lineNumber;
+
+        if ( !text.isEmpty() && !isContinuation ) {
 #if defined( Q_OS_WIN )
             text.append( QChar::CarriageReturn );
 #endif
             text.append( QChar::LineFeed );
         }
 
-        if ( lineNumbers ) {
+        if ( lineNumbers && !isContinuation ) {
             text.append( QStringLiteral( "%1: %2" ).arg( lineNumber.get() ).arg( line ) );
         }
         else {
             text.append( line );
         }
+
+        continuedLine.reset();
+        if ( selectedRange_.startLine.has_value() && logData->isLineContinued( index ) ) {
+            continuedLine = lineNumber;
+        }
+        ++index;
     }
 
     return text;
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "templateminingdialog.h"
+
+#include <QCheckBox>
+#include <QDialogButtonBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+#include "log.h"
+#include "logdata.h"
+
+TemplateMiningDialog::TemplateMiningDialog( std::shared_ptr<const LogData> logData,
+                                            std::optional<SearchResultArray> matchingLines,
+                                            LineNumber startLine, LineNumber endLine,
+                                            QWidget* parent )
+    : QDialog( parent )
+    , logData_( std::move( logData ) )
+    , matchingLines_( std::move( matchingLines ) )
+    , startLine_( startLine )
+    , endLine_( endLine )
+    , similarity_( new QDoubleSpinBox( this ) )
+    , onlyMatches_( new QCheckBox( tr( "Only lines matching current search" ), this ) )
+    , runButton_( new QPushButton( tr( "Find templates" ), this ) )
+    , searchButton_( new QPushButton( tr( "Filter by template" ), this ) )
+    , progressBar_( new QProgressBar( this ) )
+    , summary_( new QLabel( this ) )
+    , templatesTable_( new QTableWidget( this ) )
+{
+    setWindowTitle( tr( "Message templates" ) );
+
+    similarity_->setRange( 0.1, 1.0 );
+    similarity_->setSingleStep( 0.05 );
+    similarity_->setValue( TemplateMiningParameters{}.similarityThreshold );
+    similarity_->setToolTip(
+        tr( "Share of equal words needed for a line to match an existing template" ) );
+
+    onlyMatches_->setEnabled( matchingLines_.has_value() );
+    onlyMatches_->setChecked( matchingLines_.has_value() );
+
+    templatesTable_->setColumnCount( 4 );
+    templatesTable_->setHorizontalHeaderLabels(
+        { tr( "Template" ), tr( "Count" ), tr( "First line" ), tr( "Last line" ) } );
+    templatesTable_->setEditTriggers( QAbstractItemView::NoEditTriggers );
+    templatesTable_->setSelectionBehavior( QAbstractItemView::SelectRows );
+    templatesTable_->setSelectionMode( QAbstractItemView::SingleSelection );
+    templatesTable_->verticalHeader()->setVisible( false );
+    templatesTable_->horizontalHeader()->setSectionResizeMode( 0, QHeaderView::Stretch );
+    templatesTable_->setSortingEnabled( true );
+
+    progressBar_->setRange( 0, 100 );
+    progressBar_->hide();
+
+    searchButton_->setEnabled( false );
+
+    auto* formLayout = new QFormLayout;
+    formLayout->addRow( tr( "Similarity:" ), similarity_ );
+    formLayout->addRow( onlyMatches_ );
+
+    auto* buttonsLayout = new QHBoxLayout;
+    buttonsLayout->addWidget( runButton_ );
+    buttonsLayout->addWidget( searchButton_ );
+    buttonsLayout->addStretch();
+
+    auto* buttonBox = new QDialogButtonBox( QDialogButtonBox::Close, this );
+    connect( buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject );
+
+    auto* layout = new QVBoxLayout( this );
+    layout->addLayout( formLayout );
+    layout->addLayout( buttonsLayout );
+    layout->addWidget( progressBar_ );
+    layout->addWidget( summary_ );
+    layout->addWidget( templatesTable_ );
+    layout->addWidget( buttonBox );
+
+    connect( runButton_, &QPushButton::clicked, this, &TemplateMiningDialog::startMining );
+    connect( searchButton_, &QPushButton::clicked, this, &TemplateMiningDialog::requestSearch );
+    connect( templatesTable_, &QTableWidget::itemDoubleClicked, this,
+             &TemplateMiningDialog::requestSearch );
+    connect( templatesTable_, &QTableWidget::itemSelectionChanged, this, [ this ] {
+        searchButton_->setEnabled( !templatesTable_->selectedItems().isEmpty() );
+    } );
+    connect( &watcher_, &QFutureWatcher<TemplateMiningResult>::finished, this,
+             &TemplateMiningDialog::miningFinished );
+
+    resize( 720, 480 );
+}
+
+TemplateMiningDialog::~TemplateMiningDialog()
+{
+    interruptMining();
+}
+
+void TemplateMiningDialog::interruptMining()
+{
+    if ( future_.isRunning() ) {
+        interruptRequested_.set();
+        future_.waitForFinished();
+    }
+}
+
+void TemplateMiningDialog::startMining()
+{
+    interruptMining();
+    interruptRequested_.clear();
+
+    TemplateMiningParameters parameters;
+    parameters.similarityThreshold = similarity_->value();
+
+    LinesSelection selection{ startLine_, endLine_, {} };
+    if ( onlyMatches_->isChecked() ) {
+        selection.lines = matchingLines_;
+    }
+
+    runButton_->setEnabled( false );
+    progressBar_->setValue( 0 );
+    progressBar_->show();
+    summary_->clear();
+
+    future_ = QtConcurrent::run( [ this, logData = logData_, parameters,
+                                   selection = std::move( selection ) ] {
+        return mineTemplates( *logData, selection, parameters, interruptRequested_,
+                              [ this ]( int progress ) {
+                                  QMetaObject::invokeMethod(
+                                      progressBar_,
+                                      [ this, progress ] { progressBar_->setValue( progress ); },
+                                      Qt::QueuedConnection );
+                              } );
+    } );
+    watcher_.setFuture( future_ );
+}
+
+void TemplateMiningDialog::miningFinished()
+{
+    runButton_->setEnabled( true );
+    progressBar_->hide();
+
+    const auto result = future_.result();
+    if ( result.isInterrupted ) {
+        return;
+    }
+
+    summary_->setText( tr( "%1 templates in %2 lines" )
+                           .arg( result.templates.size() )
+                           .arg( result.processedLines ) );
+
+    const auto lineItem = []( LineNumber line ) {
+        auto* item = new QTableWidgetItem;
+        // Line numbers are shown starting from 1
+        item->setData( Qt::DisplayRole, static_cast<qulonglong>( line.get() + 1 ) );
+        return item;
+    };
+
+    templatesTable_->setSortingEnabled( false );
+    templatesTable_->setRowCount( static_cast<int>( result.templates.size() ) );
+
+    int row = 0;
+    for ( const auto& logTemplate : result.templates ) {
+        auto* templateItem = new QTableWidgetItem( logTemplate.text );
+        templateItem->setData( Qt::UserRole, logTemplate.pattern );
+
+        auto* countItem = new QTableWidgetItem;
+        countItem->setData( Qt::DisplayRole, static_cast<qulonglong>( logTemplate.count ) );
+
+        templatesTable_->setItem( row, 0, templateItem );
+        templatesTable_->setItem( row, 1, countItem );
+        templatesTable_->setItem( row, 2, lineItem( logTemplate.firstLine ) );
+        templatesTable_->setItem( row, 3, lineItem( logTemplate.lastLine ) );
+        ++row;
+    }
+
+    templatesTable_->setSortingEnabled( true );
+    templatesTable_->sortByColumn( 1, Qt::DescendingOrder );
+}
+
+void TemplateMiningDialog::requestSearch()
+{
+    const auto selectedRow = templatesTable_->currentRow();
+    if ( selectedRow < 0 ) {
+        return;
+    }
+
+    const auto* templateItem = templatesTable_->item( selectedRow, 0 );
+    if ( templateItem != nullptr ) {
+        LOG_INFO << "Filter by template " << templateItem->text();
+        Q_EMIT searchRequested( templateItem->data( Qt::UserRole ).toString() );
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_MEMORYGOVERNOR_H
+#define KLOGG_MEMORYGOVERNOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+#include "synchronization.h"
+
+// Subsystems known to the governor. When usage goes over the budget
+// caches are shed starting from the lowest value.
+enum class MemoryShedPriority {
+    PixmapCache = 0,
+    SearchResultsCache = 1,
+    // Consumers below are only accounted, they have nothing to shed.
+    DecodeBuffers = 2,
+    SearchResults = 3,
+    RegexScratch = 4,
+    LineIndex = 5,
+};
+
+// Live and peak usage summed over all consumers of a subsystem.
+struct MemorySubsystemStats {
+    std::atomic<uint64_t> live{ 0 };
+    std::atomic<uint64_t> peak{ 0 };
+
+    void add( uint64_t bytes );
+    void sub( uint64_t bytes );
+};
+
+struct MemoryConsumer {
+    QString name;
+    MemoryShedPriority priority;
+    MemorySubsystemStats* subsystem = nullptr;
+
+    // Shedder is invoked in the thread of the context object.
+    QPointer<QObject> context;
+    std::function<void()> shedder;
+
+    // Total usage including transient reservations
+    std::atomic<uint64_t> usage{ 0 };
+    // Part of usage reported by the owner itself
+    std::atomic<uint64_t> ownedUsage{ 0 };
+    std::atomic<bool> shedPending{ false };
+
+    void add( uint64_t bytes );
+    void sub( uint64_t bytes );
+    void set( uint64_t bytes );
+};
+
+// Keeps a reserved amount of bytes accounted for a consumer
+// until destroyed or released.
+class MemoryReservation {
+  public:
+    MemoryReservation() = default;
+    MemoryReservation( std::shared_ptr<MemoryConsumer> consumer, uint64_t bytes );
+    ~MemoryReservation();
+
+    MemoryReservation( const MemoryReservation& ) = delete;
+    MemoryReservation& operator=( const MemoryReservation& ) = delete;
+
+    MemoryReservation( MemoryReservation&& other ) noexcept;
+    MemoryReservation& operator=( MemoryReservation&& other ) noexcept;
+
+    void grow( uint64_t bytes );
+    void release();
+
+  private:
+    std::shared_ptr<MemoryConsumer> consumer_;
+    uint64_t bytes_ = 0;
+};
+
+// Handle returned by the governor to a consumer.
+// Consumer is unregistered when the handle is destroyed.
+class MemoryRegistration {
+  public:
+    MemoryRegistration() = default;
+    explicit MemoryRegistration( std::shared_ptr<MemoryConsumer> consumer );
+    ~MemoryRegistration();
+
+    MemoryRegistration( const MemoryRegistration& ) = delete;
+    MemoryRegistration& operator=( const MemoryRegistration& ) = delete;
+
+    MemoryRegistration( MemoryRegistration&& other ) noexcept = default;
+    MemoryRegistration& operator=( MemoryRegistration&& other ) noexcept;
+
+    void setUsage( uint64_t bytes );
+    uint64_t usage() const;
+
+    // Accounts transient buffer, reservation may outlive the registration.
+    MemoryReservation reserve( uint64_t bytes ) const;
+
+  private:
+    std::shared_ptr<MemoryConsumer> consumer_;
+};
+
+// Tracks memory used by indexes, caches and decode buffers and
+// makes owners drop their caches when configured budget is exceeded.
+class MemoryGovernor {
+  public:
+    static MemoryGovernor& instance();
+
+    // Budget of 0 means no limit.
+    void setBudget( uint64_t bytes );
+    uint64_t budget() const;
+
+    uint64_t trackedUsage() const;
+
+    // Shedder is optional, consumers without it are only accounted.
+    MemoryRegistration registerConsumer( const QString& name, MemoryShedPriority priority,
+                                         QObject* context = nullptr,
+                                         std::function<void()> shedder = {} );
+
+    // Called before allocating a buffer of given size.
+    // Asks consumers to shed caches if the allocation does not fit into the budget.
+    // Returns false if the budget is exceeded even after caches that can be
+    // dropped synchronously were shed.
+    bool requestAllocation( uint64_t bytes );
+
+    struct SubsystemUsage {
+        QString name;
+        uint64_t live;
+        uint64_t peak;
+    };
+    std::vector<SubsystemUsage> usageBySubsystem() const;
+
+    // Human readable per-subsystem usage, one subsystem per line.
+    QString report() const;
+
+  private:
+    MemoryGovernor() = default;
+
+    friend class MemoryRegistration;
+    void unregisterConsumer( const std::shared_ptr<MemoryConsumer>& consumer );
+
+    std::vector<std::shared_ptr<MemoryConsumer>> consumersSnapshot() const;
+
+  private:
+    std::atomic<uint64_t> budget_{ 0 };
+    // Exceeding the budget is logged once until usage fits into it again
+    std::atomic<bool> isOverBudget_{ false };
+
+    mutable Mutex consumersMutex_;
+    std::vector<std::shared_ptr<MemoryConsumer>> consumers_;
+    // Subsystems are never removed to keep peak values
+    std::map<QString, std::unique_ptr<MemorySubsystemStats>> subsystems_;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_PERFORMANCECOUNTERS_H
+#define KLOGG_PERFORMANCECOUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+#include "synchronization.h"
+
+// Cumulative counters of a running search.
+struct SearchCounters {
+    QString pattern;
+    uint32_t matcherThreads = 0;
+
+    std::atomic<uint64_t> lines{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> matchingMicroseconds{ 0 };
+};
+
+// Keeps search counters visible to readers until destroyed.
+class SearchCountersRegistration {
+  public:
+    SearchCountersRegistration() = default;
+    explicit SearchCountersRegistration( std::shared_ptr<SearchCounters> counters );
+    ~SearchCountersRegistration();
+
+    SearchCountersRegistration( const SearchCountersRegistration& ) = delete;
+    SearchCountersRegistration& operator=( const SearchCountersRegistration& ) = delete;
+
+    void addMatchedBlock( uint64_t lines, uint64_t bytes, uint64_t microseconds );
+
+  private:
+    std::shared_ptr<SearchCounters> counters_;
+};
+
+// Counters maintained by indexing, search and painting code for the
+// performance dashboard. Writers only do relaxed atomic increments,
+// readers compute rates from differences between snapshots.
+class PerformanceCounters {
+  public:
+    static PerformanceCounters& instance();
+
+    void addIndexedBytes( uint64_t bytes );
+
+    void addSearchCacheLookup( bool isHit );
+    void addTextAreaCacheLookup( bool isHit );
+
+    // Time from a file change notification until new data is indexed
+    void setFollowLag( uint64_t milliseconds );
+
+    // Achieved by the last indexing or search file reading
+    void setReadStats( double queueDepth, double megabytesPerSecond );
+
+    SearchCountersRegistration registerSearch( const QString& pattern, uint32_t matcherThreads );
+
+    struct SearchSnapshot {
+        const SearchCounters* id;
+        QString pattern;
+        uint32_t matcherThreads;
+        uint64_t lines;
+        uint64_t bytes;
+        uint64_t matchingMicroseconds;
+    };
+
+    struct Snapshot {
+        uint64_t indexedBytes;
+        uint64_t searchCacheHits;
+        uint64_t searchCacheMisses;
+        uint64_t textAreaCacheHits;
+        uint64_t textAreaCacheMisses;
+        // Negative if no file change was followed yet
+        int64_t followLagMs;
+        // Zero if nothing was read yet
+        double readQueueDepth;
+        double readMegabytesPerSecond;
+        std::vector<SearchSnapshot> searches;
+    };
+
+    Snapshot snapshot() const;
+
+  private:
+    PerformanceCounters() = default;
+
+    friend class SearchCountersRegistration;
+    void unregisterSearch( const std::shared_ptr<SearchCounters>& counters );
+
+  private:
+    std::atomic<uint64_t> indexedBytes_{ 0 };
+    std::atomic<uint64_t> searchCacheHits_{ 0 };
+    std::atomic<uint64_t> searchCacheMisses_{ 0 };
+    std::atomic<uint64_t> textAreaCacheHits_{ 0 };
+    std::atomic<uint64_t> textAreaCacheMisses_{ 0 };
+    std::atomic<int64_t> followLagMs_{ -1 };
+    std::atomic<double> readQueueDepth_{ 0 };
+    std::atomic<double> readMegabytesPerSecond_{ 0 };
+
+    mutable Mutex searchesMutex_;
+    std::vector<std::shared_ptr<SearchCounters>> searches_;
+};
+
+#endif
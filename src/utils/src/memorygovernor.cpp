@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorygovernor.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include <QLocale>
+#include <QMetaObject>
+#include <QThread>
+
+#include "log.h"
+
+void MemorySubsystemStats::add( uint64_t bytes )
+{
+    const auto newLive = live.fetch_add( bytes, std::memory_order_relaxed ) + bytes;
+    auto currentPeak = peak.load( std::memory_order_relaxed );
+    while ( newLive > currentPeak
+            && !peak.compare_exchange_weak( currentPeak, newLive, std::memory_order_relaxed ) ) {
+    }
+}
+
+void MemorySubsystemStats::sub( uint64_t bytes )
+{
+    live.fetch_sub( bytes, std::memory_order_relaxed );
+}
+
+void MemoryConsumer::add( uint64_t bytes )
+{
+    usage.fetch_add( bytes, std::memory_order_relaxed );
+    if ( subsystem ) {
+        subsystem->add( bytes );
+    }
+}
+
+void MemoryConsumer::sub( uint64_t bytes )
+{
+    usage.fetch_sub( bytes, std::memory_order_relaxed );
+    if ( subsystem ) {
+        subsystem->sub( bytes );
+    }
+}
+
+void MemoryConsumer::set( uint64_t bytes )
+{
+    const auto oldUsage = ownedUsage.exchange( bytes, std::memory_order_relaxed );
+    if ( bytes > oldUsage ) {
+        add( bytes - oldUsage );
+    }
+    else {
+        sub( oldUsage - bytes );
+    }
+}
+
+MemoryReservation::MemoryReservation( std::shared_ptr<MemoryConsumer> consumer, uint64_t bytes )
+    : consumer_( std::move( consumer ) )
+    , bytes_( 0 )
+{
+    grow( bytes );
+}
+
+MemoryReservation::~MemoryReservation()
+{
+    release();
+}
+
+MemoryReservation::MemoryReservation( MemoryReservation&& other ) noexcept
+    : consumer_( std::move( other.consumer_ ) )
+    , bytes_( std::exchange( other.bytes_, 0 ) )
+{
+}
+
+MemoryReservation& MemoryReservation::operator=( MemoryReservation&& other ) noexcept
+{
+    if ( this != &other ) {
+        release();
+        consumer_ = std::move( other.consumer_ );
+        bytes_ = std::exchange( other.bytes_, 0 );
+    }
+    return *this;
+}
+
+void MemoryReservation::grow( uint64_t bytes )
+{
+    if ( consumer_ ) {
+        consumer_->add( bytes );
+        bytes_ += bytes;
+    }
+}
+
+void MemoryReservation::release()
+{
+    if ( consumer_ ) {
+        consumer_->sub( bytes_ );
+    }
+    bytes_ = 0;
+}
+
+MemoryRegistration::MemoryRegistration( std::shared_ptr<MemoryConsumer> consumer )
+    : consumer_( std::move( consumer ) )
+{
+}
+
+MemoryRegistration::~MemoryRegistration()
+{
+    if ( consumer_ ) {
+        consumer_->set( 0 );
+        MemoryGovernor::instance().unregisterConsumer( consumer_ );
+    }
+}
+
+MemoryRegistration& MemoryRegistration::operator=( MemoryRegistration&& other ) noexcept
+{
+    if ( this != &other ) {
+        if ( consumer_ ) {
+            consumer_->set( 0 );
+            MemoryGovernor::instance().unregisterConsumer( consumer_ );
+        }
+        consumer_ = std::move( other.consumer_ );
+    }
+    return *this;
+}
+
+void MemoryRegistration::setUsage( uint64_t bytes )
+{
+    if ( consumer_ ) {
+        consumer_->set( bytes );
+    }
+}
+
+uint64_t MemoryRegistration::usage() const
+{
+    return consumer_ ? consumer_->usage.load( std::memory_order_relaxed ) : 0;
+}
+
+MemoryReservation MemoryRegistration::reserve( uint64_t bytes ) const
+{
+    return MemoryReservation{ consumer_, bytes };
+}
+
+MemoryGovernor& MemoryGovernor::instance()
+{
+    static MemoryGovernor governor;
+    return governor;
+}
+
+void MemoryGovernor::setBudget( uint64_t bytes )
+{
+    LOG_INFO << "Memory budget set to " << bytes << " bytes";
+    budget_.store( bytes, std::memory_order_relaxed );
+    requestAllocation( 0 );
+}
+
+uint64_t MemoryGovernor::budget() const
+{
+    return budget_.load( std::memory_order_relaxed );
+}
+
+MemoryRegistration MemoryGovernor::registerConsumer( const QString& name,
+                                                     MemoryShedPriority priority,
+                                                     QObject* context,
+                                                     std::function<void()> shedder )
+{
+    auto consumer = std::make_shared<MemoryConsumer>();
+    consumer->name = name;
+    consumer->priority = priority;
+    consumer->context = context;
+    consumer->shedder = std::move( shedder );
+
+    ScopedLock lock( consumersMutex_ );
+    auto& subsystem = subsystems_[ name ];
+    if ( !subsystem ) {
+        subsystem = std::make_unique<MemorySubsystemStats>();
+    }
+    consumer->subsystem = subsystem.get();
+    consumers_.push_back( consumer );
+
+    return MemoryRegistration{ std::move( consumer ) };
+}
+
+void MemoryGovernor::unregisterConsumer( const std::shared_ptr<MemoryConsumer>& consumer )
+{
+    ScopedLock lock( consumersMutex_ );
+    consumers_.erase( std::remove( consumers_.begin(), consumers_.end(), consumer ),
+                      consumers_.end() );
+}
+
+std::vector<std::shared_ptr<MemoryConsumer>> MemoryGovernor::consumersSnapshot() const
+{
+    SharedLock lock( consumersMutex_ );
+    return consumers_;
+}
+
+uint64_t MemoryGovernor::trackedUsage() const
+{
+    const auto consumers = consumersSnapshot();
+    return std::accumulate( consumers.cbegin(), consumers.cend(), uint64_t{ 0 },
+                            []( uint64_t acc, const auto& consumer ) {
+                                return acc + consumer->usage.load( std::memory_order_relaxed );
+                            } );
+}
+
+std::vector<MemoryGovernor::SubsystemUsage> MemoryGovernor::usageBySubsystem() const
+{
+    SharedLock lock( consumersMutex_ );
+
+    std::vector<SubsystemUsage> result;
+    result.reserve( subsystems_.size() );
+    for ( const auto& [ name, stats ] : subsystems_ ) {
+        result.push_back( { name, stats->live.load( std::memory_order_relaxed ),
+                            stats->peak.load( std::memory_order_relaxed ) } );
+    }
+    return result;
+}
+
+QString MemoryGovernor::report() const
+{
+    const auto locale = QLocale::c();
+
+    QString result;
+    for ( const auto& subsystem : usageBySubsystem() ) {
+        const auto live = locale.formattedDataSize( static_cast<qint64>( subsystem.live ) );
+        const auto peak = locale.formattedDataSize( static_cast<qint64>( subsystem.peak ) );
+        result.append( QString( "%1: %2 (peak %3)\n" ).arg( subsystem.name, live, peak ) );
+    }
+    return result;
+}
+
+bool MemoryGovernor::requestAllocation( uint64_t bytes )
+{
+    const auto budget = budget_.load( std::memory_order_relaxed );
+    if ( budget == 0 ) {
+        return true;
+    }
+
+    auto consumers = consumersSnapshot();
+    auto projectedUsage
+        = bytes
+          + std::accumulate( consumers.cbegin(), consumers.cend(), uint64_t{ 0 },
+                             []( uint64_t acc, const auto& consumer ) {
+                                 return acc + consumer->usage.load( std::memory_order_relaxed );
+                             } );
+
+    if ( projectedUsage <= budget ) {
+        if ( isOverBudget_.exchange( false ) ) {
+            LOG_INFO << "Memory usage is within budget again";
+        }
+        return true;
+    }
+
+    if ( !isOverBudget_.exchange( true ) ) {
+        LOG_INFO << "Memory budget exceeded: " << projectedUsage << " > " << budget;
+    }
+
+    // Usage is reported only when caches are actually dropped, not on
+    // every allocation made while nothing is left to shed
+    bool isReported = false;
+    const auto reportShedding = [ this, &isReported, projectedUsage, budget ] {
+        if ( !isReported ) {
+            LOG_INFO << "Shedding caches for " << projectedUsage << " > " << budget
+                     << " bytes, usage by subsystem:\n"
+                     << report();
+            isReported = true;
+        }
+    };
+
+    std::stable_sort( consumers.begin(), consumers.end(), []( const auto& lhs, const auto& rhs ) {
+        return lhs->priority < rhs->priority;
+    } );
+
+    for ( const auto& consumer : consumers ) {
+        if ( projectedUsage <= budget ) {
+            break;
+        }
+
+        const auto consumerUsage = consumer->usage.load( std::memory_order_relaxed );
+        if ( !consumer->shedder || consumerUsage == 0 ) {
+            continue;
+        }
+
+        QObject* context = consumer->context.data();
+        if ( context == nullptr ) {
+            continue;
+        }
+
+        if ( context->thread() == QThread::currentThread() ) {
+            reportShedding();
+            LOG_INFO << "Shedding " << consumer->name << ", " << consumerUsage << " bytes";
+            consumer->shedder();
+            const auto usageAfterShedding = consumer->usage.load( std::memory_order_relaxed );
+            if ( usageAfterShedding < consumerUsage ) {
+                projectedUsage -= std::min( projectedUsage, consumerUsage - usageAfterShedding );
+            }
+        }
+        else if ( !consumer->shedPending.exchange( true ) ) {
+            reportShedding();
+            LOG_INFO << "Scheduling shedding of " << consumer->name << ", " << consumerUsage
+                     << " bytes";
+            std::weak_ptr<MemoryConsumer> weakConsumer = consumer;
+            QMetaObject::invokeMethod(
+                context,
+                [ weakConsumer ] {
+                    if ( auto lockedConsumer = weakConsumer.lock() ) {
+                        lockedConsumer->shedPending = false;
+                        lockedConsumer->shedder();
+                    }
+                },
+                Qt::QueuedConnection );
+        }
+    }
+
+    return projectedUsage <= budget;
+}
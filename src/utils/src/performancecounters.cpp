@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performancecounters.h"
+
+#include <algorithm>
+
+SearchCountersRegistration::SearchCountersRegistration( std::shared_ptr<SearchCounters> counters )
+    : counters_( std::move( counters ) )
+{
+}
+
+SearchCountersRegistration::~SearchCountersRegistration()
+{
+    if ( counters_ ) {
+        PerformanceCounters::instance().unregisterSearch( counters_ );
+    }
+}
+
+void SearchCountersRegistration::addMatchedBlock( uint64_t lines, uint64_t bytes,
+                                                  uint64_t microseconds )
+{
+    counters_->lines.fetch_add( lines, std::memory_order_relaxed );
+    counters_->bytes.fetch_add( bytes, std::memory_order_relaxed );
+    counters_->matchingMicroseconds.fetch_add( microseconds, std::memory_order_relaxed );
+}
+
+PerformanceCounters& PerformanceCounters::instance()
+{
+    static PerformanceCounters counters;
+    return counters;
+}
+
+void PerformanceCounters::addIndexedBytes( uint64_t bytes )
+{
+    indexedBytes_.fetch_add( bytes, std::memory_order_relaxed );
+}
+
+void PerformanceCounters::addSearchCacheLookup( bool isHit )
+{
+    ( isHit ? searchCacheHits_ : searchCacheMisses_ ).fetch_add( 1, std::memory_order_relaxed );
+}
+
+void PerformanceCounters::addTextAreaCacheLookup( bool isHit )
+{
+    ( isHit ? textAreaCacheHits_ : textAreaCacheMisses_ )
+        .fetch_add( 1, std::memory_order_relaxed );
+}
+
+void PerformanceCounters::setFollowLag( uint64_t milliseconds )
+{
+    followLagMs_.store( static_cast<int64_t>( milliseconds ), std::memory_order_relaxed );
+}
+
+void PerformanceCounters::setReadStats( double queueDepth, double megabytesPerSecond )
+{
+    readQueueDepth_.store( queueDepth, std::memory_order_relaxed );
+    readMegabytesPerSecond_.store( megabytesPerSecond, std::memory_order_relaxed );
+}
+
+SearchCountersRegistration PerformanceCounters::registerSearch( const QString& pattern,
+                                                                uint32_t matcherThreads )
+{
+    auto counters = std::make_shared<SearchCounters>();
+    counters->pattern = pattern;
+    counters->matcherThreads = matcherThreads;
+
+    ScopedLock lock( searchesMutex_ );
+    searches_.push_back( counters );
+    return SearchCountersRegistration{ std::move( counters ) };
+}
+
+void PerformanceCounters::unregisterSearch( const std::shared_ptr<SearchCounters>& counters )
+{
+    ScopedLock lock( searchesMutex_ );
+    searches_.erase( std::remove( searches_.begin(), searches_.end(), counters ),
+                     searches_.end() );
+}
+
+PerformanceCounters::Snapshot PerformanceCounters::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.indexedBytes = indexedBytes_.load( std::memory_order_relaxed );
+    snapshot.searchCacheHits = searchCacheHits_.load( std::memory_order_relaxed );
+    snapshot.searchCacheMisses = searchCacheMisses_.load( std::memory_order_relaxed );
+    snapshot.textAreaCacheHits = textAreaCacheHits_.load( std::memory_order_relaxed );
+    snapshot.textAreaCacheMisses = textAreaCacheMisses_.load( std::memory_order_relaxed );
+    snapshot.followLagMs = followLagMs_.load( std::memory_order_relaxed );
+    snapshot.readQueueDepth = readQueueDepth_.load( std::memory_order_relaxed );
+    snapshot.readMegabytesPerSecond = readMegabytesPerSecond_.load( std::memory_order_relaxed );
+
+    SharedLock lock( searchesMutex_ );
+    snapshot.searches.reserve( searches_.size() );
+    for ( const auto& search : searches_ ) {
+        snapshot.searches.push_back( { search.get(), search->pattern, search->matcherThreads,
+                                       search->lines.load( std::memory_order_relaxed ),
+                                       search->bytes.load( std::memory_order_relaxed ),
+                                       search->matchingMicroseconds.load(
+                                           std::memory_order_relaxed ) } );
+    }
+
+    return snapshot;
+}
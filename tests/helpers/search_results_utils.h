@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLOGG_SEARCH_RESULTS_UTILS_H
+#define KLOGG_SEARCH_RESULTS_UTILS_H
+
+#include <cstdint>
+
+#include "containers.h"
+#include "logfiltereddataworker.h"
+
+// Line numbers of the set in ascending order, to compare them with REQUIRE
+inline klogg::vector<uint64_t> toVector( const SearchResultArray& lines )
+{
+    klogg::vector<uint64_t> result;
+    for ( const auto line : lines ) {
+        result.push_back( line );
+    }
+    return result;
+}
+
+#endif
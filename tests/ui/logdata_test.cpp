@@ -20,6 +20,7 @@
 #include <catch2/catch.hpp>
 
 #include <iostream>
+#include <optional>
 
 #include <QProcess>
 #include <QSignalSpy>
@@ -33,7 +34,9 @@
 #include "log.h"
 #include "test_utils.h"
 
+#include "configuration.h"
 #include "logdata.h"
+#include "selection.h"
 
 static const qint64 SL_NB_LINES = 500LL;
 static const qint64 VBL_NB_LINES = 50000LL;
@@ -131,6 +134,197 @@ TEST_CASE( "Logdata decoding lines", "[logdata]" )
     const auto utf8View = rawLines.buildUtf8View();
 
     REQUIRE( rawLines.endOfLines.size() == utf8View.size() );
+
+    const auto decodedLines = rawLines.decodeLinesToArena();
+    const auto lines = rawLines.decodeLines();
+
+    REQUIRE( decodedLines.size() == lines.size() );
+    for ( auto i = 0u; i < lines.size(); ++i ) {
+        REQUIRE( decodedLines[ i ] == lines[ i ] );
+    }
+
+    const auto linesView = logData.getLinesView( 200_lnum, 200_lcount );
+    REQUIRE( linesView.size() == 200 );
+    REQUIRE( linesView[ 10 ] == logData.getLineString( 210_lnum ) );
+}
+
+TEST_CASE( "Logdata keeps bytes of split lines", "[logdata]" )
+{
+    auto& config = Configuration::getSynced();
+    config.setSplitLongLines( true );
+    config.setLongLineSplitSizeKb( 1 );
+
+    // Cut into two pieces of 1024 bytes and the rest of 952 bytes
+    const auto longLine = QString( "0123456789" ).repeated( 300 );
+
+    QTemporaryFile file{ "testsplit_XXXXXX" };
+    REQUIRE( file.open() );
+    file.write( ( longLine + "\nend\n" ).toUtf8() );
+    file.flush();
+
+    LogData logData;
+    SafeQSignalSpy finishedSpy( &logData, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    logData.attachFile( QFileInfo{ file }.absoluteFilePath() );
+    REQUIRE( finishedSpy.safeWait() );
+    config.setSplitLongLines( false );
+
+    REQUIRE( logData.getNbLine() == 4_lcount );
+    REQUIRE( logData.isLineContinued( 0_lnum ) );
+    REQUIRE( logData.isLineContinued( 1_lnum ) );
+    REQUIRE_FALSE( logData.isLineContinued( 2_lnum ) );
+
+    const auto rawLines = logData.getLinesRaw( 0_lnum, 4_lcount );
+
+    SECTION( "Decoded pieces join into the line" )
+    {
+        const auto lines = rawLines.decodeLines();
+        REQUIRE( lines.size() == 4 );
+        REQUIRE( lines[ 0 ].size() == 1024 );
+        REQUIRE( lines[ 0 ] + lines[ 1 ] + lines[ 2 ] == longLine );
+        REQUIRE( lines[ 3 ] == "end" );
+
+        const auto decodedLines = rawLines.decodeLinesToArena();
+        REQUIRE( decodedLines.size() == lines.size() );
+        for ( auto i = 0u; i < lines.size(); ++i ) {
+            REQUIRE( decodedLines[ i ] == lines[ i ] );
+        }
+    }
+
+    SECTION( "Search view keeps last bytes of pieces" )
+    {
+        const auto utf8View = rawLines.buildUtf8View();
+        REQUIRE( utf8View.size() == 4 );
+        REQUIRE( utf8View[ 0 ].size() == 1024 );
+        REQUIRE( utf8View[ 1 ].size() == 1024 );
+        REQUIRE( utf8View[ 2 ].size() == 952 );
+        REQUIRE( utf8View[ 3 ] == "end" );
+
+        std::string joined;
+        for ( auto i = 0u; i < 3; ++i ) {
+            joined.append( utf8View[ i ] );
+        }
+        REQUIRE( joined == longLine.toStdString() );
+    }
+
+    SECTION( "Selected pieces are copied as one line" )
+    {
+        Selection selection;
+        selection.selectRange( 1_lnum, 3_lnum );
+
+#if defined( Q_OS_WIN )
+        const auto lineFeed = QStringLiteral( "\r\n" );
+#else
+        const auto lineFeed = QStringLiteral( "\n" );
+#endif
+        REQUIRE( selection.getSelectedText( &logData )
+                 == longLine.mid( 1024 ) + lineFeed + "end" );
+    }
+
+    SECTION( "Exported pieces are written as one line" )
+    {
+        const auto separator = QStringLiteral( "\n" );
+        REQUIRE( logData.getLinesText( 0_lnum, 4_lcount, 4_lnum, separator )
+                 == longLine + "\nend\n" );
+
+        // Chunk boundary in the middle of the line
+        REQUIRE( logData.getLinesText( 0_lnum, 2_lcount, 4_lnum, separator )
+                     + logData.getLinesText( 2_lnum, 2_lcount, 4_lnum, separator )
+                 == longLine + "\nend\n" );
+
+        // Export ending on a piece still ends the line
+        REQUIRE( logData.getLinesText( 0_lnum, 1_lcount, 1_lnum, separator )
+                 == longLine.left( 1024 ) + "\n" );
+    }
+}
+
+namespace {
+void attachContent( LogData& logData, QTemporaryFile& file, const QByteArray& content )
+{
+    REQUIRE( file.open() );
+    file.write( content );
+    file.flush();
+
+    SafeQSignalSpy finishedSpy( &logData, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    logData.attachFile( QFileInfo{ file }.absoluteFilePath() );
+    REQUIRE( finishedSpy.safeWait() );
+}
+
+std::optional<QByteArray> exportRanges( const LogData& logData,
+                                        const AbstractLogData::LineRanges& ranges )
+{
+    QTemporaryFile output{ "testexported_XXXXXX" };
+    REQUIRE( output.open() );
+
+    const auto isExported = logData.exportRawLineRanges(
+        ranges, output, []( uint64_t, uint64_t ) { return true; } );
+    if ( !isExported ) {
+        return {};
+    }
+
+    output.seek( 0 );
+    return output.readAll();
+}
+} // namespace
+
+TEST_CASE( "Logdata exports raw line ranges", "[logdata]" )
+{
+    SECTION( "Ranges of a file without final line feed" )
+    {
+        QTemporaryFile file{ "testexport_XXXXXX" };
+        LogData logData;
+        attachContent( logData, file, "one\ntwo\nthree\nfour" );
+        REQUIRE( logData.getNbLine() == 4_lcount );
+
+        // Consecutive ranges are copied as one
+        REQUIRE( exportRanges( logData, { { 0_lnum, 2_lcount }, { 2_lnum, 1_lcount } } )
+                 == QByteArray( "one\ntwo\nthree\n" ) );
+
+        // Last line gets the line feed it lacks in the file
+        REQUIRE( exportRanges( logData, { { 0_lnum, 1_lcount }, { 2_lnum, 2_lcount } } )
+                 == QByteArray( "one\nthree\nfour\n" ) );
+
+        REQUIRE_FALSE( exportRanges( logData, { { 3_lnum, 2_lcount } } ) );
+    }
+
+    SECTION( "Pieces of split lines are exported whole" )
+    {
+        auto& config = Configuration::getSynced();
+        config.setSplitLongLines( true );
+        config.setLongLineSplitSizeKb( 1 );
+
+        const auto longLine = QByteArray( "0123456789" ).repeated( 300 );
+
+        QTemporaryFile file{ "testexport_XXXXXX" };
+        LogData logData;
+        attachContent( logData, file, "first\n" + longLine + "\nend\n" );
+        config.setSplitLongLines( false );
+        REQUIRE( logData.getNbLine() == 5_lcount );
+
+        REQUIRE( exportRanges( logData, { { 2_lnum, 1_lcount } } ) == longLine + "\n" );
+        REQUIRE( exportRanges( logData, { { 0_lnum, 1_lcount }, { 4_lnum, 1_lcount } } )
+                 == QByteArray( "first\nend\n" ) );
+    }
+
+#if !defined( Q_OS_WIN )
+    SECTION( "Replaced file is not exported" )
+    {
+        QTemporaryFile file{ "testexport_XXXXXX" };
+        LogData logData;
+        attachContent( logData, file, "one\ntwo\n" );
+
+        const auto fileName = QFileInfo{ file }.absoluteFilePath();
+        QTemporaryFile otherFile{ "testexport_XXXXXX" };
+        REQUIRE( otherFile.open() );
+        otherFile.write( "ONE\nTWO\n" );
+        otherFile.close();
+
+        // The attached file stays open, so the new one has another id
+        REQUIRE( QFile::remove( fileName ) );
+        REQUIRE( QFile::rename( otherFile.fileName(), fileName ) );
+
+        REQUIRE_FALSE( exportRanges( logData, { { 0_lnum, 2_lcount } } ) );
+    }
+#endif
 }
 
 TEST_CASE( "Logdata reading changing file", "[logdata]" )
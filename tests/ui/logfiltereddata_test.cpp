@@ -29,8 +29,10 @@
 #include "log.h"
 #include "test_utils.h"
 
+#include "fieldaggregation.h"
 #include "logdata.h"
 #include "logfiltereddata.h"
+#include "templatemining.h"
 
 static const qint64 SL_NB_LINES = 500LL;
 
@@ -54,12 +56,11 @@ bool generateDataFiles( QTemporaryFile& file )
     return true;
 }
 
-void runSearch( LogFilteredData* filtered_data, const QString& regexp,
+void runSearch( LogFilteredData* filtered_data, const RegularExpressionPattern& pattern,
                 SafeQSignalSpy& searchProgressSpy )
 {
 
-    QTimer::singleShot(
-        50, [ & ]() { filtered_data->runSearch( RegularExpressionPattern( regexp ) ); } );
+    QTimer::singleShot( 50, [ & ]() { filtered_data->runSearch( pattern ); } );
 
     int progress = 0;
     do {
@@ -69,6 +70,12 @@ void runSearch( LogFilteredData* filtered_data, const QString& regexp,
     } while ( progress < 100 );
 }
 
+void runSearch( LogFilteredData* filtered_data, const QString& regexp,
+                SafeQSignalSpy& searchProgressSpy )
+{
+    runSearch( filtered_data, RegularExpressionPattern( regexp ), searchProgressSpy );
+}
+
 } // namespace
 
 using LineTypeFlags = LogFilteredData::LineTypeFlags;
@@ -254,6 +261,65 @@ SCENARIO( "search for regex", "[logdata]" )
     }
 }
 
+SCENARIO( "inverse search in record mode", "[logdata]" )
+{
+    auto& config = Configuration::getSynced();
+    config.setRecordStartPattern( "^START" );
+
+    QTemporaryFile file{ "records_test_XXXXXX" };
+    REQUIRE( file.open() );
+    file.write( "START first\n"
+                "  detail\n"
+                "START second\n"
+                "  detail with failure\n"
+                "START third\n" );
+    file.flush();
+
+    LogData log_data;
+    SafeQSignalSpy loadEndSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    log_data.attachFile( file.fileName() );
+    REQUIRE( loadEndSpy.safeWait( 10000 ) );
+    config.setRecordStartPattern( {} );
+
+    REQUIRE( log_data.hasRecords() );
+
+    GIVEN( "filtered data in record mode" )
+    {
+        auto filtered_data = log_data.getNewFilteredData();
+        filtered_data->setRecordMode( true );
+
+        SafeQSignalSpy searchProgressSpy{ filtered_data.get(),
+                                          &LogFilteredData::searchProgressed };
+
+        WHEN( "Searched for lines not matching" )
+        {
+            runSearch( filtered_data.get(),
+                       RegularExpressionPattern( "failure", true, true, false, false ),
+                       searchProgressSpy );
+
+            THEN( "Only records without a match are shown" )
+            {
+                REQUIRE( filtered_data->getNbMatches() == 3_lcount );
+                REQUIRE( filtered_data->getMatchingLineNumber( 0_lnum ) == 0_lnum );
+                REQUIRE( filtered_data->getMatchingLineNumber( 1_lnum ) == 1_lnum );
+                REQUIRE( filtered_data->getMatchingLineNumber( 2_lnum ) == 4_lnum );
+            }
+        }
+
+        WHEN( "Searched for matching lines" )
+        {
+            runSearch( filtered_data.get(), "failure", searchProgressSpy );
+
+            THEN( "Whole record of the match is shown" )
+            {
+                REQUIRE( filtered_data->getNbMatches() == 2_lcount );
+                REQUIRE( filtered_data->getMatchingLineNumber( 0_lnum ) == 2_lnum );
+                REQUIRE( filtered_data->getMatchingLineNumber( 1_lnum ) == 3_lnum );
+            }
+        }
+    }
+}
+
 SCENARIO( "marks and matches in filtered log data", "[logdata]" )
 {
     LogDataLoader logDataLoader;
@@ -563,3 +629,84 @@ SCENARIO( "marks and matches in filtered log data", "[logdata]" )
         }
     }
 }
+
+SCENARIO( "aggregating field values", "[logdata]" )
+{
+    LogDataLoader logDataLoader;
+    AtomicFlag interruptRequested;
+    const auto nbLines = static_cast<uint64_t>( SL_NB_LINES );
+
+    FieldExtractor extractor;
+    extractor.expression = "line \\d{5}(\\d)";
+
+    WHEN( "Aggregating all lines" )
+    {
+        const auto result = aggregateField(
+            logDataLoader.log_data, extractor,
+            { 0_lnum, LineNumber( SL_NB_LINES ), std::nullopt }, 3, interruptRequested, {} );
+
+        THEN( "Most frequent values are counted" )
+        {
+            REQUIRE( result.error.isEmpty() );
+            REQUIRE( result.processedLines == nbLines );
+            REQUIRE( result.linesWithValue == nbLines );
+            REQUIRE( result.distinctValues == 10 );
+            REQUIRE( result.values.size() == 3 );
+            REQUIRE( result.values[ 0 ].value == "0" );
+            REQUIRE( result.values[ 0 ].count == nbLines / 10 );
+        }
+    }
+
+    WHEN( "Aggregating selected lines" )
+    {
+        SearchResultArray lines;
+        for ( auto line = uint64_t{ 7 }; line < nbLines; line += 10 ) {
+            lines.add( line );
+        }
+
+        const auto result = aggregateField( logDataLoader.log_data, extractor,
+                                            { 0_lnum, LineNumber( SL_NB_LINES ), lines }, 20,
+                                            interruptRequested, {} );
+
+        THEN( "Only selected lines are counted" )
+        {
+            REQUIRE( result.processedLines == nbLines / 10 );
+            REQUIRE( result.values.size() == 1 );
+            REQUIRE( result.values[ 0 ].value == "7" );
+            REQUIRE( result.values[ 0 ].count == nbLines / 10 );
+        }
+    }
+}
+
+SCENARIO( "mining message templates", "[logdata]" )
+{
+    LogDataLoader logDataLoader;
+    AtomicFlag interruptRequested;
+    const auto nbLines = static_cast<uint64_t>( SL_NB_LINES );
+
+    WHEN( "Mining templates of all lines" )
+    {
+        const auto result = mineTemplates( logDataLoader.log_data,
+                                           { 0_lnum, LineNumber( SL_NB_LINES ), std::nullopt },
+                                           {}, interruptRequested, {} );
+
+        THEN( "Lines differing only in numbers share a template" )
+        {
+            REQUIRE( result.processedLines == nbLines );
+            REQUIRE( result.templates.size() == 1 );
+
+            const auto& logTemplate = result.templates.front();
+            REQUIRE( logTemplate.count == nbLines );
+            REQUIRE( logTemplate.firstLine == 0_lnum );
+            REQUIRE( logTemplate.lastLine == LineNumber( SL_NB_LINES - 1 ) );
+            REQUIRE( logTemplate.text.endsWith( "this is line <*>" ) );
+        }
+
+        THEN( "Template pattern matches its lines" )
+        {
+            const QRegularExpression regex( result.templates.front().pattern );
+            REQUIRE( regex.isValid() );
+            REQUIRE( regex.match( logDataLoader.log_data.getLineString( 42_lnum ) ).hasMatch() );
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include <QTextCodec>
+
+#include "binarycontent.h"
+
+namespace {
+
+EncodingParameters encodingParams( const char* name )
+{
+    return EncodingParameters( QTextCodec::codecForName( name ) );
+}
+
+std::string repeat( const std::string& text, size_t times )
+{
+    std::string result;
+    for ( size_t i = 0; i < times; ++i ) {
+        result += text;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE( "Text is not binary content", "[binarycontent]" )
+{
+    const auto params = encodingParams( "UTF-8" );
+
+    SECTION( "plain lines" )
+    {
+        const auto text = repeat( "2021-05-01 12:00:00 INFO\tstarted worker\r\n", 100 );
+        REQUIRE_FALSE( isBinaryContent( text, params ) );
+    }
+
+    SECTION( "colored output" )
+    {
+        const auto text = repeat( "\x1b[31mERROR\x1b[0m failed\n", 100 );
+        REQUIRE_FALSE( isBinaryContent( text, params ) );
+    }
+
+    SECTION( "multibyte character cut at the end" )
+    {
+        const auto text = repeat( "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82\x01\n", 100 );
+        REQUIRE_FALSE( isBinaryContent( text + "\xd0", params ) );
+    }
+
+    SECTION( "empty" )
+    {
+        REQUIRE_FALSE( isBinaryContent( {}, params ) );
+    }
+}
+
+TEST_CASE( "Binary content is detected", "[binarycontent]" )
+{
+    SECTION( "NUL bytes" )
+    {
+        auto data = repeat( "line of text\n", 100 );
+        data += std::string( 64, '\0' );
+        REQUIRE( isBinaryContent( data, encodingParams( "UTF-8" ) ) );
+        REQUIRE( isBinaryContent( data, encodingParams( "ISO-8859-1" ) ) );
+    }
+
+    SECTION( "control characters" )
+    {
+        const auto data = repeat( "\x01\x02\x03\x04text", 100 );
+        REQUIRE( isBinaryContent( data, encodingParams( "ISO-8859-1" ) ) );
+    }
+
+    SECTION( "invalid UTF-8 with some control characters" )
+    {
+        const auto data = repeat( "\xff\xfe text \x02\x03 more text\n", 100 );
+        REQUIRE( isBinaryContent( data, encodingParams( "UTF-8" ) ) );
+        REQUIRE_FALSE( isBinaryContent( data, encodingParams( "ISO-8859-1" ) ) );
+    }
+}
+
+TEST_CASE( "Binary content is detected in code units of encoding", "[binarycontent]" )
+{
+    const auto text = QString( "2021-05-01 INFO started worker\n" ).repeated( 100 );
+
+    const auto* utf16 = QTextCodec::codecForName( "UTF-16LE" );
+    const auto encoded = utf16->fromUnicode( text );
+    const auto data = std::string( encoded.constData(), static_cast<size_t>( encoded.size() ) );
+
+    REQUIRE_FALSE( isBinaryContent( data, EncodingParameters( utf16 ) ) );
+    REQUIRE( isBinaryContent( data, encodingParams( "ISO-8859-1" ) ) );
+}
+
+TEST_CASE( "Large blocks are checked by samples", "[binarycontent]" )
+{
+    const auto params = encodingParams( "UTF-8" );
+
+    SECTION( "text with samples cutting multibyte characters" )
+    {
+        const auto text
+            = repeat( "\xd0\xbf\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82\x01\n", 100000 );
+        REQUIRE_FALSE( isBinaryBlock( text, params ) );
+    }
+
+    SECTION( "binary data" )
+    {
+        const auto data = repeat( std::string( "\x01\x02\x00\x04text", 8 ), 200000 );
+        REQUIRE( isBinaryBlock( data, params ) );
+    }
+
+    SECTION( "small block" )
+    {
+        auto data = repeat( "line of text\n", 100 );
+        REQUIRE_FALSE( isBinaryBlock( data, params ) );
+
+        data += std::string( 64, '\0' );
+        REQUIRE( isBinaryBlock( data, params ) );
+    }
+}
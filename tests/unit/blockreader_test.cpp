@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <future>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <QByteArray>
+#include <QFile>
+#include <QTemporaryFile>
+
+#include "blockreader.h"
+
+namespace {
+
+QByteArray makeContent( int size )
+{
+    QByteArray content( size, '\0' );
+    for ( auto i = 0; i < size; ++i ) {
+        content[ i ] = static_cast<char>( i * 7 % 251 );
+    }
+    return content;
+}
+
+// Reads the range and returns the bytes read, empty on failure
+QByteArray readBlock( BlockReader& reader, int64_t offset, int64_t size )
+{
+    QByteArray buffer( static_cast<int>( size ), '\0' );
+    const auto readBytes = reader.read( offset, buffer.data(), size ).get();
+    if ( readBytes < 0 ) {
+        return {};
+    }
+    buffer.resize( static_cast<int>( readBytes ) );
+    return buffer;
+}
+
+} // namespace
+
+TEST_CASE( "Block reader reads blocks of a file", "[blockreader]" )
+{
+    // Three pages and a bit, so reads cross page boundaries
+    const auto content = makeContent( 3 * 4096 + 123 );
+
+    QTemporaryFile file{ "testblockreader_XXXXXX" };
+    REQUIRE( file.open() );
+    file.write( content );
+    file.flush();
+
+    const auto fileName = file.fileName();
+
+    SECTION( "Reads queued over the number of workers are all done" )
+    {
+        BlockReader reader( fileName, 2 );
+
+        constexpr int BlockSize = 100;
+        const auto blocksCount = content.size() / BlockSize;
+
+        std::vector<QByteArray> buffers( static_cast<size_t>( blocksCount ),
+                                         QByteArray( BlockSize, '\0' ) );
+        std::vector<std::future<int64_t>> results;
+        for ( auto block = 0; block < blocksCount; ++block ) {
+            results.push_back( reader.read( block * BlockSize,
+                                            buffers[ static_cast<size_t>( block ) ].data(),
+                                            BlockSize ) );
+        }
+
+        for ( auto block = 0; block < blocksCount; ++block ) {
+            REQUIRE( results[ static_cast<size_t>( block ) ].get() == BlockSize );
+            REQUIRE( buffers[ static_cast<size_t>( block ) ]
+                     == content.mid( block * BlockSize, BlockSize ) );
+        }
+
+        REQUIRE( reader.stats().bytes == static_cast<uint64_t>( blocksCount * BlockSize ) );
+    }
+
+    SECTION( "Read at the end of file is short" )
+    {
+        BlockReader reader( fileName, 1 );
+        REQUIRE( readBlock( reader, content.size() - 100, 4096 ) == content.right( 100 ) );
+
+        char buffer[ 16 ];
+        REQUIRE( reader.read( content.size(), buffer, sizeof( buffer ) ).get() == 0 );
+    }
+
+    SECTION( "Reads of another file fail" )
+    {
+        QTemporaryFile otherFile{ "testblockreader_XXXXXX" };
+        REQUIRE( otherFile.open() );
+
+        BlockReader::FileAccess fileAccess;
+        fileAccess.expectedId = FileId::getFileId( otherFile.fileName() );
+
+        BlockReader reader( fileName, 1, {}, fileAccess );
+
+        char buffer[ 16 ];
+        REQUIRE( reader.read( 0, buffer, sizeof( buffer ) ).get() == -1 );
+    }
+
+#ifdef Q_OS_LINUX
+    SECTION( "Direct reads at unaligned offsets" )
+    {
+        // Falls back to buffered reads where direct IO is not supported (e.g. tmpfs)
+        BlockReader::CacheHints cacheHints;
+        cacheHints.directIo = true;
+
+        BlockReader reader( fileName, 1, cacheHints );
+
+        REQUIRE( readBlock( reader, 0, 4096 ) == content.left( 4096 ) );
+        REQUIRE( readBlock( reader, 1, 10 ) == content.mid( 1, 10 ) );
+        REQUIRE( readBlock( reader, 4000, 200 ) == content.mid( 4000, 200 ) );
+        REQUIRE( readBlock( reader, 4095, 8193 ) == content.mid( 4095, 8193 ) );
+        REQUIRE( readBlock( reader, content.size() - 50, 4096 ) == content.right( 50 ) );
+    }
+#endif
+}
+
+#if !defined( Q_OS_WIN )
+TEST_CASE( "Block reader reopens closed handles by name", "[blockreader]" )
+{
+    const auto content = makeContent( 100 );
+
+    QTemporaryFile file{ "testblockreader_XXXXXX" };
+    REQUIRE( file.open() );
+    file.write( content );
+    file.flush();
+
+    const auto fileName = file.fileName();
+
+    BlockReader::FileAccess fileAccess;
+    fileAccess.expectedId = FileId::getFileId( fileName );
+
+    // Replaced file has another id, only a handle opened before it can read
+    const auto readReplacedFile = [ & ] {
+        BlockReader reader( fileName, 1, {}, fileAccess );
+        REQUIRE( readBlock( reader, 0, 16 ) == content.left( 16 ) );
+
+        QTemporaryFile newFile{ "testblockreader_XXXXXX" };
+        REQUIRE( newFile.open() );
+        newFile.write( makeContent( 200 ) );
+        newFile.close();
+        REQUIRE( QFile::remove( fileName ) );
+        REQUIRE( QFile::rename( newFile.fileName(), fileName ) );
+
+        char buffer[ 16 ];
+        return reader.read( 16, buffer, sizeof( buffer ) ).get();
+    };
+
+    SECTION( "Handle is kept open between reads" )
+    {
+        REQUIRE( readReplacedFile() == 16 );
+    }
+
+    SECTION( "Handle is closed when there is nothing to read" )
+    {
+        fileAccess.keepClosed = true;
+        REQUIRE( readReplacedFile() == -1 );
+    }
+}
+#endif
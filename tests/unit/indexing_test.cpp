@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <memory>
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextCodec>
+
+#include "atomicflag.h"
+#include "configuration.h"
+#include "logdataworker.h"
+
+namespace {
+
+const char* const Encodings[] = { "UTF-8", "UTF-16LE", "UTF-16BE", "UTF-32LE", "UTF-32BE" };
+
+QString writeFile( const QTemporaryDir& dir, QTextCodec* codec, const QString& text )
+{
+    const auto fileName = dir.filePath( QString::fromLatin1( codec->name() ) + ".log" );
+
+    QFile file{ fileName };
+    file.open( QIODevice::WriteOnly );
+    file.write( codec->fromUnicode( text ) );
+
+    return fileName;
+}
+
+std::shared_ptr<IndexingData> indexFile( const QString& fileName, QTextCodec* codec )
+{
+    auto indexingData = std::make_shared<IndexingData>();
+    AtomicFlag interruptRequest;
+    FullIndexOperation{ fileName, indexingData, interruptRequest, codec }.run();
+    return indexingData;
+}
+
+// Long lines are split in pieces of 1 KiB while the object lives
+struct SplitLongLines {
+    SplitLongLines()
+    {
+        auto& config = Configuration::getSynced();
+        config.setSplitLongLines( true );
+        config.setLongLineSplitSizeKb( 1 );
+    }
+
+    ~SplitLongLines()
+    {
+        Configuration::getSynced().setSplitLongLines( false );
+    }
+};
+
+klogg::vector<uint64_t> lineEnds( const IndexingData::ConstAccessor& accessor )
+{
+    klogg::vector<uint64_t> ends;
+    for ( auto line = 0_lnum; line < LineNumber( accessor.getNbLines().get() ); ++line ) {
+        ends.push_back( static_cast<uint64_t>( accessor.getEndOfLineOffset( line ).get() ) );
+    }
+    return ends;
+}
+
+} // namespace
+
+TEST_CASE( "Lines are indexed in every line feed width", "[indexing]" )
+{
+    QTemporaryDir dir;
+    REQUIRE( dir.isValid() );
+
+    // U+0A0A has line feed bytes, but is not a line feed in wide encodings
+    const auto text = QString::fromUtf8( "first line\n"
+                                         "tab\tseparated\tfields\n"
+                                         "ਊx\n" );
+
+    for ( const auto* encoding : Encodings ) {
+        DYNAMIC_SECTION( encoding )
+        {
+            auto* codec = QTextCodec::codecForName( encoding );
+            const auto indexingData = indexFile( writeFile( dir, codec, text ), codec );
+
+            IndexingData::ConstAccessor accessor{ indexingData.get() };
+            REQUIRE( accessor.getNbLines() == LinesCount( 3 ) );
+            REQUIRE( accessor.getMaxLength() == LineLength( 30 ) );
+        }
+    }
+}
+
+TEST_CASE( "Long lines are cut between characters", "[indexing]" )
+{
+    QTemporaryDir dir;
+    REQUIRE( dir.isValid() );
+
+    const SplitLongLines splitLongLines;
+
+    SECTION( "UTF-8 sequence is not cut" )
+    {
+        // Two bytes character at bytes 1023-1024 is moved to the next line
+        const auto text = QString( 1023, 'a' ) + QString::fromUtf8( "\xc3\xa9" )
+                          + QString( 100, 'b' ) + "\n";
+
+        auto* codec = QTextCodec::codecForName( "UTF-8" );
+        const auto indexingData = indexFile( writeFile( dir, codec, text ), codec );
+
+        IndexingData::ConstAccessor accessor{ indexingData.get() };
+        REQUIRE( lineEnds( accessor ) == klogg::vector<uint64_t>{ 1023, 1126 } );
+        REQUIRE( accessor.getSplitLines().cardinality() == 1 );
+        REQUIRE( accessor.getSplitLines().contains( 0u ) );
+    }
+
+    SECTION( "UTF-16 surrogate pair is not cut" )
+    {
+        // High surrogate at bytes 1022-1023, low surrogate at bytes 1024-1025
+        const auto text = QString( 511, 'a' ) + QString::fromUtf8( "\xf0\x9f\x98\x80" )
+                          + QString( 10, 'b' ) + "\n";
+
+        auto* codec = QTextCodec::codecForName( "UTF-16LE" );
+        const auto indexingData = indexFile( writeFile( dir, codec, text ), codec );
+
+        IndexingData::ConstAccessor accessor{ indexingData.get() };
+        REQUIRE( lineEnds( accessor ) == klogg::vector<uint64_t>{ 1022, 1048 } );
+        REQUIRE( accessor.getSplitLines().cardinality() == 1 );
+        REQUIRE( accessor.getSplitLines().contains( 0u ) );
+    }
+
+    SECTION( "Lines shorter than split size are kept" )
+    {
+        const auto text = QString( 1024, 'a' ) + "\n" + QString( 10, 'b' ) + "\n";
+
+        auto* codec = QTextCodec::codecForName( "UTF-8" );
+        const auto indexingData = indexFile( writeFile( dir, codec, text ), codec );
+
+        IndexingData::ConstAccessor accessor{ indexingData.get() };
+        REQUIRE( lineEnds( accessor ) == klogg::vector<uint64_t>{ 1025, 1036 } );
+        REQUIRE( accessor.getSplitLines().isEmpty() );
+    }
+}
+
+TEST_CASE( "Long lines are split across blocks", "[indexing]" )
+{
+    QTemporaryDir dir;
+    REQUIRE( dir.isValid() );
+
+    const SplitLongLines splitLongLines;
+
+    // Pieces of the long line cross boundaries of indexing blocks
+    constexpr uint64_t FirstLineSize = 6;
+    constexpr uint64_t PiecesCount = 11 * 1024;
+    constexpr uint64_t RestSize = 5;
+    const auto text = QString( "first\n" )
+                      + QString( static_cast<int>( PiecesCount * 1024 + RestSize ), 'x' )
+                      + "\nlast\n";
+
+    auto* codec = QTextCodec::codecForName( "UTF-8" );
+    const auto indexingData = indexFile( writeFile( dir, codec, text ), codec );
+
+    IndexingData::ConstAccessor accessor{ indexingData.get() };
+    REQUIRE( accessor.getNbLines() == LinesCount( PiecesCount + 3 ) );
+
+    const auto ends = lineEnds( accessor );
+    REQUIRE( ends.front() == FirstLineSize );
+    for ( auto piece = 1u; piece <= PiecesCount; ++piece ) {
+        REQUIRE( ends[ piece ] == FirstLineSize + piece * 1024 );
+    }
+    REQUIRE( ends[ PiecesCount + 1 ] == FirstLineSize + PiecesCount * 1024 + RestSize + 1 );
+    REQUIRE( ends.back() == static_cast<uint64_t>( text.size() ) );
+
+    SECTION( "Only pieces followed by the rest of their line are flagged" )
+    {
+        const auto& splitLines = accessor.getSplitLines();
+        REQUIRE( splitLines.cardinality() == PiecesCount );
+        REQUIRE_FALSE( splitLines.contains( 0u ) );
+        REQUIRE( splitLines.minimum() == 1 );
+        REQUIRE( splitLines.maximum() == PiecesCount );
+    }
+}
+
+TEST_CASE( "Index files in every line feed width", "[!benchmark]" )
+{
+    QTemporaryDir dir;
+    REQUIRE( dir.isValid() );
+
+    const auto text
+        = QString( "2021-05-01 12:00:00.000 INFO [worker]\trequest processed in 12 ms\n" )
+              .repeated( 100000 );
+
+    for ( const auto* encoding : Encodings ) {
+        auto* codec = QTextCodec::codecForName( encoding );
+        const auto fileName = writeFile( dir, codec, text );
+
+        BENCHMARK( encoding )
+        {
+            return indexFile( fileName, codec );
+        };
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include "linetypes.h"
+
+#include "linehashindex.h"
+
+#include "search_results_utils.h"
+
+SCENARIO( "LineHashIndex filters", "[linehashindex]" )
+{
+    GIVEN( "Index of lines with repeated content" )
+    {
+        LineHashIndex index;
+        index.append( 0_lnum, { 1, 1, 2, 2, 2, 1, 3, 3 } );
+
+        REQUIRE( index.size() == 8_lcount );
+        REQUIRE( index.hashOfLine( 5_lnum ) == 1 );
+
+        WHEN( "Collapsing repeated lines" )
+        {
+            const auto lines
+                = index.filterLines( DuplicateLinesFilter::CollapseRepeated, 0_lnum, {} );
+            THEN( "First line of every run is kept" )
+            {
+                REQUIRE( toVector( lines ) == klogg::vector<uint64_t>{ 0, 2, 5, 6 } );
+            }
+        }
+
+        WHEN( "Showing first occurrences" )
+        {
+            const auto lines
+                = index.filterLines( DuplicateLinesFilter::FirstOccurrence, 0_lnum, {} );
+            THEN( "First line with each hash is kept" )
+            {
+                REQUIRE( toVector( lines ) == klogg::vector<uint64_t>{ 0, 2, 6 } );
+            }
+        }
+
+        WHEN( "Showing first occurrences among some lines" )
+        {
+            SearchResultArray selected;
+            selected.add( uint64_t{ 1 } );
+            selected.add( uint64_t{ 4 } );
+            selected.add( uint64_t{ 5 } );
+            const auto lines
+                = index.filterLines( DuplicateLinesFilter::FirstOccurrence, 0_lnum, selected );
+            THEN( "Only selected lines are considered" )
+            {
+                REQUIRE( toVector( lines ) == klogg::vector<uint64_t>{ 1, 4 } );
+            }
+        }
+
+        WHEN( "Showing lines new since a line" )
+        {
+            const auto lines = index.filterLines( DuplicateLinesFilter::NewSinceLine, 5_lnum, {} );
+            THEN( "Lines with hashes seen before are hidden" )
+            {
+                REQUIRE( toVector( lines ) == klogg::vector<uint64_t>{ 6, 7 } );
+            }
+        }
+
+        WHEN( "Replacing the last line" )
+        {
+            index.append( 7_lnum, { 4, 3 } );
+            THEN( "Hashes of new lines are used" )
+            {
+                REQUIRE( index.size() == 9_lcount );
+                REQUIRE( toVector( index.filterLines( DuplicateLinesFilter::NewSinceLine, 7_lnum,
+                                                      {} ) )
+                         == klogg::vector<uint64_t>{ 7 } );
+            }
+        }
+    }
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include "logdiff.h"
+
+#include "search_results_utils.h"
+
+namespace {
+
+LogDiffResult diff( const klogg::vector<uint64_t>& first, const klogg::vector<uint64_t>& second,
+                    LogDiffMode mode )
+{
+    AtomicFlag interruptRequested;
+    return logdiff::diffHashes( first, second, mode, interruptRequested );
+}
+
+} // namespace
+
+SCENARIO( "Comparing line hashes", "[logdiff]" )
+{
+    GIVEN( "Files with a changed line" )
+    {
+        const klogg::vector<uint64_t> first{ 1, 2, 3, 4, 5 };
+        const klogg::vector<uint64_t> second{ 1, 2, 9, 4, 5 };
+
+        WHEN( "Aligning lines" )
+        {
+            const auto result = diff( first, second, LogDiffMode::Aligned );
+            THEN( "Changed line is reported in both files" )
+            {
+                REQUIRE( toVector( result.onlyInFirst ) == klogg::vector<uint64_t>{ 2 } );
+                REQUIRE( toVector( result.onlyInSecond ) == klogg::vector<uint64_t>{ 2 } );
+            }
+        }
+    }
+
+    GIVEN( "Files with a moved line" )
+    {
+        const klogg::vector<uint64_t> first{ 1, 2, 3, 4 };
+        const klogg::vector<uint64_t> second{ 4, 1, 2, 3 };
+
+        WHEN( "Aligning lines" )
+        {
+            const auto result = diff( first, second, LogDiffMode::Aligned );
+            THEN( "Moved line is reported at both positions" )
+            {
+                REQUIRE( toVector( result.onlyInFirst ) == klogg::vector<uint64_t>{ 3 } );
+                REQUIRE( toVector( result.onlyInSecond ) == klogg::vector<uint64_t>{ 0 } );
+            }
+        }
+
+        WHEN( "Ignoring line order" )
+        {
+            const auto result = diff( first, second, LogDiffMode::Lines );
+            THEN( "Files are equal" )
+            {
+                REQUIRE( result.onlyInFirst.isEmpty() );
+                REQUIRE( result.onlyInSecond.isEmpty() );
+            }
+        }
+    }
+
+    GIVEN( "Files with repeated lines only" )
+    {
+        const klogg::vector<uint64_t> first{ 7, 8, 7, 8, 7 };
+        const klogg::vector<uint64_t> second{ 8, 7, 8, 7 };
+
+        WHEN( "Aligning lines" )
+        {
+            const auto result = diff( first, second, LogDiffMode::Aligned );
+            THEN( "Extra line is reported" )
+            {
+                REQUIRE( result.onlyInFirst.cardinality() == 1 );
+                REQUIRE( result.onlyInSecond.isEmpty() );
+            }
+        }
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string_view>
+
+#include <catch2/catch.hpp>
+
+#include "loglevelindex.h"
+
+#include "search_results_utils.h"
+
+namespace {
+
+LogLevel classify( const LogLevelClassifier& classifier, std::string_view line )
+{
+    return classifier.classify( line.data(), line.size() );
+}
+
+} // namespace
+
+SCENARIO( "Log level classification", "[loglevelindex]" )
+{
+    GIVEN( "Default classifier" )
+    {
+        const LogLevelClassifier classifier;
+
+        THEN( "Level keywords are found as whole words in any case" )
+        {
+            REQUIRE( classify( classifier, "2021-01-01 12:00:00.123 [ERROR] failed" )
+                     == LogLevel::Error );
+            REQUIRE( classify( classifier, "INFO: started" ) == LogLevel::Info );
+            REQUIRE( classify( classifier, "ts=12 level=warn msg=slow" ) == LogLevel::Warning );
+            REQUIRE( classify( classifier, "D 12:00 debug output" ) == LogLevel::Debug );
+            REQUIRE( classify( classifier, "information without level" ) == LogLevel::None );
+            REQUIRE( classify( classifier, "" ) == LogLevel::None );
+        }
+    }
+
+    GIVEN( "Classifier with short search depth" )
+    {
+        const LogLevelClassifier classifier( 10 );
+
+        THEN( "Keywords starting after the depth are ignored" )
+        {
+            REQUIRE( classify( classifier, "0123456789 ERROR" ) == LogLevel::None );
+            REQUIRE( classify( classifier, "012345 ERROR" ) == LogLevel::Error );
+        }
+    }
+
+    GIVEN( "Classifier with level at a fixed column" )
+    {
+        const LogLevelClassifier classifier( 64, QRegularExpression( "^.{13}(\\w+)" ) );
+
+        THEN( "Only the word at the column is the level" )
+        {
+            REQUIRE( classify( classifier, "12:00:00.123 WARN error in payload" )
+                     == LogLevel::Warning );
+            REQUIRE( classify( classifier, "12:00:00.123 user error" ) == LogLevel::None );
+        }
+    }
+
+    GIVEN( "Classifier with level after a prefix" )
+    {
+        const LogLevelClassifier classifier( 64, QRegularExpression( "level=(\\w+)" ) );
+
+        THEN( "Keywords outside of the prefix are ignored" )
+        {
+            REQUIRE( classify( classifier, "msg=\"info\" level=error" ) == LogLevel::Error );
+            REQUIRE( classify( classifier, "msg=\"error\" level=none" ) == LogLevel::None );
+            REQUIRE( classify( classifier, "ERROR without level" ) == LogLevel::None );
+        }
+    }
+
+    GIVEN( "Classifier with invalid level pattern" )
+    {
+        const LogLevelClassifier classifier( 64, QRegularExpression( "level=(" ) );
+
+        THEN( "Any keyword is found" )
+        {
+            REQUIRE( classify( classifier, "INFO: started" ) == LogLevel::Info );
+        }
+    }
+}
+
+SCENARIO( "Log level index", "[loglevelindex]" )
+{
+    GIVEN( "Index of lines with levels" )
+    {
+        LogLevelIndex index;
+        index.append( 0_lnum, { LogLevel::Error, LogLevel::None, LogLevel::Warning,
+                                LogLevel::Error } );
+
+        REQUIRE( index.size() == 4_lcount );
+
+        THEN( "Lines of levels are found" )
+        {
+            REQUIRE( toVector( index.linesOfLevel( LogLevel::Error ) )
+                     == klogg::vector<uint64_t>{ 0, 3 } );
+            REQUIRE( toVector( index.linesOfLevels( LogLevel::Warning | LogLevel::Error ) )
+                     == klogg::vector<uint64_t>{ 0, 2, 3 } );
+            REQUIRE( index.linesOfLevels( LogLevel::Debug ).isEmpty() );
+        }
+
+        WHEN( "The last line is replaced" )
+        {
+            index.append( 3_lnum, { LogLevel::Info, LogLevel::Error } );
+
+            THEN( "Level of the old line is dropped" )
+            {
+                REQUIRE( index.size() == 5_lcount );
+                REQUIRE( toVector( index.linesOfLevel( LogLevel::Error ) )
+                         == klogg::vector<uint64_t>{ 0, 4 } );
+                REQUIRE( toVector( index.linesOfLevel( LogLevel::Info ) )
+                         == klogg::vector<uint64_t>{ 3 } );
+            }
+        }
+    }
+}
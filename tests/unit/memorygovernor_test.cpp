@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+#include "memorygovernor.h"
+
+#include "test_utils.h"
+
+namespace {
+
+// Governor is shared by the whole process, budget is dropped after each test
+struct BudgetGuard {
+    explicit BudgetGuard( uint64_t bytes )
+    {
+        MemoryGovernor::instance().setBudget( bytes );
+    }
+
+    ~BudgetGuard()
+    {
+        MemoryGovernor::instance().setBudget( 0 );
+    }
+
+    BudgetGuard( const BudgetGuard& ) = delete;
+    BudgetGuard& operator=( const BudgetGuard& ) = delete;
+};
+
+// Thread with an event loop which can be kept busy, stopped even if a check fails
+struct WorkerThread {
+    WorkerThread()
+        : context( new QObject )
+    {
+        context->moveToThread( &thread );
+        QObject::connect( &thread, &QThread::finished, context, &QObject::deleteLater );
+        thread.start();
+    }
+
+    ~WorkerThread()
+    {
+        unblock();
+        thread.quit();
+        thread.wait();
+    }
+
+    WorkerThread( const WorkerThread& ) = delete;
+    WorkerThread& operator=( const WorkerThread& ) = delete;
+
+    void block()
+    {
+        QMetaObject::invokeMethod(
+            context, [ this ] { blocked.acquire(); }, Qt::QueuedConnection );
+    }
+
+    void unblock()
+    {
+        blocked.release();
+    }
+
+    QThread thread;
+    QObject* context;
+    QSemaphore blocked;
+};
+
+MemoryGovernor::SubsystemUsage subsystemUsage( const QString& subsystem )
+{
+    for ( const auto& usage : MemoryGovernor::instance().usageBySubsystem() ) {
+        if ( usage.name == subsystem ) {
+            return usage;
+        }
+    }
+    return { subsystem, 0, 0 };
+}
+
+} // namespace
+
+TEST_CASE( "Memory governor sheds caches by priority", "[memorygovernor]" )
+{
+    auto& governor = MemoryGovernor::instance();
+    const auto otherUsage = governor.trackedUsage();
+
+    QObject context;
+    std::vector<QString> shedOrder;
+
+    MemoryRegistration pixmaps;
+    pixmaps = governor.registerConsumer(
+        "test pixmaps", MemoryShedPriority::PixmapCache, &context, [ & ] {
+            shedOrder.emplace_back( "pixmaps" );
+            pixmaps.setUsage( 0 );
+        } );
+
+    MemoryRegistration results;
+    results = governor.registerConsumer(
+        "test results", MemoryShedPriority::SearchResultsCache, &context, [ & ] {
+            shedOrder.emplace_back( "results" );
+            results.setUsage( 0 );
+        } );
+
+    auto index = governor.registerConsumer( "test index", MemoryShedPriority::LineIndex );
+
+    pixmaps.setUsage( 100 );
+    results.setUsage( 100 );
+    index.setUsage( 100 );
+    REQUIRE( governor.trackedUsage() == otherUsage + 300 );
+
+    const BudgetGuard budget( otherUsage + 350 );
+
+    SECTION( "Allocation fitting into the budget sheds nothing" )
+    {
+        REQUIRE( governor.requestAllocation( 50 ) );
+        REQUIRE( shedOrder.empty() );
+    }
+
+    SECTION( "Shedding stops once usage fits into the budget" )
+    {
+        REQUIRE( governor.requestAllocation( 100 ) );
+        REQUIRE( shedOrder == std::vector<QString>{ "pixmaps" } );
+        REQUIRE( pixmaps.usage() == 0 );
+        REQUIRE( results.usage() == 100 );
+    }
+
+    SECTION( "Consumers without shedder are only accounted" )
+    {
+        REQUIRE_FALSE( governor.requestAllocation( 300 ) );
+        REQUIRE( shedOrder == std::vector<QString>{ "pixmaps", "results" } );
+        REQUIRE( index.usage() == 100 );
+    }
+}
+
+TEST_CASE( "Memory governor sheds in the thread of the context", "[memorygovernor]" )
+{
+    auto& governor = MemoryGovernor::instance();
+    const auto otherUsage = governor.trackedUsage();
+
+    WorkerThread worker;
+
+    std::atomic<int> shedCount{ 0 };
+    std::atomic<QThread*> shedThread{ nullptr };
+
+    auto cache = std::make_unique<MemoryRegistration>();
+    *cache = governor.registerConsumer( "test thread cache", MemoryShedPriority::PixmapCache,
+                                        worker.context, [ & ] {
+                                            shedThread = QThread::currentThread();
+                                            cache->setUsage( 0 );
+                                            ++shedCount;
+                                        } );
+    cache->setUsage( 100 );
+
+    // Setting the budget already schedules shedding, it waits for the worker
+    worker.block();
+    const BudgetGuard budget( otherUsage + 50 );
+
+    SECTION( "Shedding is scheduled once and done in the worker thread" )
+    {
+        // Scheduled shedding does not make the allocation fit
+        REQUIRE_FALSE( governor.requestAllocation( 0 ) );
+        REQUIRE_FALSE( governor.requestAllocation( 0 ) );
+        REQUIRE( shedCount.load() == 0 );
+
+        worker.unblock();
+        REQUIRE( waitUiState( [ & ] { return shedCount.load() > 0; } ) );
+
+        REQUIRE( shedCount.load() == 1 );
+        REQUIRE( shedThread.load() == &worker.thread );
+        REQUIRE( governor.requestAllocation( 0 ) );
+    }
+
+    SECTION( "Unregistered consumer is not shed" )
+    {
+        cache.reset();
+
+        // Event posted after the shedding request runs after it
+        std::atomic<bool> isProcessed{ false };
+        QMetaObject::invokeMethod(
+            worker.context, [ &isProcessed ] { isProcessed = true; }, Qt::QueuedConnection );
+        worker.unblock();
+        REQUIRE( waitUiState( [ & ] { return isProcessed.load(); } ) );
+
+        REQUIRE( shedCount.load() == 0 );
+    }
+}
+
+TEST_CASE( "Memory governor accounts registrations and reservations", "[memorygovernor]" )
+{
+    auto& governor = MemoryGovernor::instance();
+    const auto otherUsage = governor.trackedUsage();
+
+    auto registration = std::make_unique<MemoryRegistration>(
+        governor.registerConsumer( "test buffers", MemoryShedPriority::DecodeBuffers ) );
+    registration->setUsage( 100 );
+
+    auto reservation = registration->reserve( 50 );
+    reservation.grow( 25 );
+    REQUIRE( registration->usage() == 175 );
+    REQUIRE( governor.trackedUsage() == otherUsage + 175 );
+    REQUIRE( subsystemUsage( "test buffers" ).live == 175 );
+
+    SECTION( "Released reservation is not accounted" )
+    {
+        reservation.release();
+        REQUIRE( registration->usage() == 100 );
+        REQUIRE( subsystemUsage( "test buffers" ).live == 100 );
+    }
+
+    SECTION( "Moved registration is unregistered once" )
+    {
+        auto moved = std::move( *registration );
+        registration.reset();
+        REQUIRE( moved.usage() == 175 );
+        REQUIRE( governor.trackedUsage() == otherUsage + 175 );
+    }
+
+    SECTION( "Reservation outlives its registration" )
+    {
+        registration.reset();
+        REQUIRE( governor.trackedUsage() == otherUsage );
+        REQUIRE( subsystemUsage( "test buffers" ).live == 75 );
+
+        reservation.release();
+        REQUIRE( subsystemUsage( "test buffers" ).live == 0 );
+    }
+
+    // Peak is kept after the usage drops
+    REQUIRE( subsystemUsage( "test buffers" ).peak >= 175 );
+}
@@ -65,3 +65,93 @@ SCENARIO( "Pattern matcher in boolean mode", "[patternmatcher]" )
         REQUIRE_FALSE( expression.isValid() );
     }
 }
+
+SCENARIO( "Pattern matcher with literal patterns", "[patternmatcher]" )
+{
+    const auto hasMatch = []( const RegularExpressionPattern& pattern, std::string_view line ) {
+        RegularExpression expression( pattern );
+        REQUIRE( expression.isValid() );
+        return expression.createMatcher()->hasMatch( line );
+    };
+
+    WHEN( "Using plain text with regular expression syntax" )
+    {
+        const auto pattern = RegularExpressionPattern( "a.b(c)", true, false, false, true );
+        REQUIRE( LiteralMatcher::isLiteral( pattern ) );
+        REQUIRE( hasMatch( pattern, "call a.b(c) failed" ) );
+        REQUIRE_FALSE( hasMatch( pattern, "call aXb(c) failed" ) );
+    }
+
+    WHEN( "Using regular expression without syntax" )
+    {
+        const auto pattern = RegularExpressionPattern( "192\\.168\\.0\\.1 refused" );
+        REQUIRE( LiteralMatcher::isLiteral( pattern ) );
+        REQUIRE( hasMatch( pattern, "connection to 192.168.0.1 refused" ) );
+        REQUIRE_FALSE( hasMatch( pattern, "connection to 192x168.0.1 refused" ) );
+
+        REQUIRE_FALSE( LiteralMatcher::isLiteral( RegularExpressionPattern( "192.168" ) ) );
+        REQUIRE_FALSE( LiteralMatcher::isLiteral( RegularExpressionPattern( "\\d+ ms" ) ) );
+    }
+
+    WHEN( "Using case insensitive pattern" )
+    {
+        const auto pattern
+            = RegularExpressionPattern( "Connection Refused", false, false, false, true );
+        REQUIRE( LiteralMatcher::isLiteral( pattern ) );
+        REQUIRE( hasMatch( pattern, "2021-05-01 ERROR CONNECTION REFUSED by peer" ) );
+        REQUIRE( hasMatch( pattern, "2021-05-01 error connection refused by peer" ) );
+        REQUIRE_FALSE( hasMatch( pattern, "2021-05-01 error connection_refused by peer" ) );
+
+        REQUIRE_FALSE( LiteralMatcher::isLiteral(
+            RegularExpressionPattern( QString::fromUtf8( "Ошибка" ), false, false, false, true ) ) );
+    }
+
+    WHEN( "Matching at every position of a long line" )
+    {
+        const auto line = std::string( 100, 'x' ) + "needle" + std::string( 30, 'x' );
+        const auto lineView = std::string_view{ line };
+        const LiteralMatcher matcher( { RegularExpressionPattern( "needle" ) } );
+        for ( size_t start = 0; start < 100; ++start ) {
+            const auto part = lineView.substr( start );
+            REQUIRE( matcher.match( part )[ 0 ] );
+            REQUIRE_FALSE( matcher.match( part.substr( 0, part.size() - 31 ) )[ 0 ] );
+        }
+    }
+
+    WHEN( "Using several literals" )
+    {
+        const auto pattern
+            = RegularExpressionPattern( "\"timeout\" & !\"retry\"", true, false, true, true );
+        REQUIRE( hasMatch( pattern, "request timeout" ) );
+        REQUIRE_FALSE( hasMatch( pattern, "request timeout, retry" ) );
+        REQUIRE_FALSE( hasMatch( pattern, "request done" ) );
+    }
+}
+
+TEST_CASE( "Search literal pattern", "[!benchmark]" )
+{
+    const auto line
+        = std::string( "2021-05-01 12:00:00.000 INFO [worker-12] request processed in 12 ms, " )
+              .append( 200, 'x' );
+    const klogg::vector<RegularExpressionPattern> patterns{ RegularExpressionPattern(
+        "Connection refused", false, false, false, true ) };
+
+    const DefaultRegularExpressionMatcher regularExpressionMatcher( patterns );
+    const auto engineMatcher = HsRegularExpression( patterns ).createMatcher();
+    const LiteralMatcher literalMatcher( patterns );
+
+    BENCHMARK( "QRegularExpression" )
+    {
+        return regularExpressionMatcher.match( line );
+    };
+
+    BENCHMARK( "regular expression engine" )
+    {
+        return std::visit( [ &line ]( const auto& m ) { return m.match( line ); }, engineMatcher );
+    };
+
+    BENCHMARK( "literal matcher" )
+    {
+        return literalMatcher.match( line );
+    };
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include "recordindex.h"
+
+#include "search_results_utils.h"
+
+namespace {
+
+SearchResultArray toLines( std::initializer_list<uint64_t> lines )
+{
+    SearchResultArray result;
+    for ( const auto line : lines ) {
+        result.add( line );
+    }
+    return result;
+}
+
+} // namespace
+
+SCENARIO( "Record index", "[recordindex]" )
+{
+    GIVEN( "Index with a preamble and three records" )
+    {
+        // 0 preamble, 1-3 first record, 4 second, 5-6 third
+        RecordIndex index;
+        index.append( 0_lnum, { false, true, false, false, true, true, false } );
+
+        THEN( "Record starts are stored" )
+        {
+            REQUIRE( index.size() == 7_lcount );
+            REQUIRE( toVector( index.recordStarts() )
+                     == klogg::vector<uint64_t>{ 1, 4, 5 } );
+        }
+
+        WHEN( "Matches are expanded" )
+        {
+            const auto records = index.expandToRecords( toLines( { 2, 3, 6 } ) );
+
+            THEN( "All lines of the matching records are selected" )
+            {
+                REQUIRE( toVector( records ) == klogg::vector<uint64_t>{ 1, 2, 3, 5, 6 } );
+            }
+        }
+
+        WHEN( "Preamble and single line record match" )
+        {
+            const auto records = index.expandToRecords( toLines( { 0, 4 } ) );
+
+            THEN( "They are records of their own" )
+            {
+                REQUIRE( toVector( records ) == klogg::vector<uint64_t>{ 0, 4 } );
+            }
+        }
+
+        WHEN( "Lines after the indexed ones match" )
+        {
+            const auto records = index.expandToRecords( toLines( { 9 } ) );
+
+            THEN( "They are kept as is" )
+            {
+                REQUIRE( toVector( records ) == klogg::vector<uint64_t>{ 9 } );
+            }
+        }
+
+        WHEN( "Inverse search results are reduced to records" )
+        {
+            // Line 2 of the first record and line 6 of the third one matched
+            const auto records = index.wholeRecordsOf( toLines( { 0, 1, 3, 4, 5, 9 } ) );
+
+            THEN( "Only records without matches are kept" )
+            {
+                REQUIRE( toVector( records ) == klogg::vector<uint64_t>{ 0, 4, 9 } );
+            }
+        }
+
+        WHEN( "Inverse search results cover every line" )
+        {
+            const auto records = index.wholeRecordsOf( toLines( { 0, 1, 2, 3, 4, 5, 6 } ) );
+
+            THEN( "All records are kept" )
+            {
+                REQUIRE( toVector( records )
+                         == klogg::vector<uint64_t>{ 0, 1, 2, 3, 4, 5, 6 } );
+            }
+        }
+
+        WHEN( "Last line is indexed again" )
+        {
+            index.append( 6_lnum, { true, false } );
+
+            THEN( "Its flag is replaced" )
+            {
+                REQUIRE( index.size() == 8_lcount );
+                REQUIRE( toVector( index.recordStarts() )
+                         == klogg::vector<uint64_t>{ 1, 4, 5, 6 } );
+            }
+        }
+    }
+}
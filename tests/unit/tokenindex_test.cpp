@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include "tokenindex.h"
+
+#include "search_results_utils.h"
+
+namespace {
+
+klogg::vector<TokenPosting> extract( const TokenExtractor& extractor,
+                                     const klogg::vector<QString>& lines,
+                                     LineNumber firstLine = 0_lnum )
+{
+    klogg::vector<TokenPosting> postings;
+    auto line = firstLine;
+    for ( const auto& text : lines ) {
+        extractor.extract( line, text, postings );
+        line = line + 1_lcount;
+    }
+    return postings;
+}
+
+} // namespace
+
+SCENARIO( "Token index lookups", "[tokenindex]" )
+{
+    GIVEN( "Extractor of hex ids" )
+    {
+        const TokenExtractor extractor( "\\b[0-9a-f]{8}\\b" );
+        REQUIRE( extractor.isValid() );
+
+        THEN( "Whole ids are tokens" )
+        {
+            REQUIRE( extractor.isToken( "deadbeef" ) );
+            REQUIRE( extractor.isToken( "DEADBEEF" ) );
+            REQUIRE_FALSE( extractor.isToken( "deadbee" ) );
+            REQUIRE_FALSE( extractor.isToken( "id deadbeef" ) );
+        }
+
+        THEN( "Lines are checked to have the token" )
+        {
+            REQUIRE( extractor.hasToken( u"end DeadBeef 0badf00d", "deadbeef" ) );
+            REQUIRE_FALSE( extractor.hasToken( u"start deadbeef1", "deadbeef" ) );
+            REQUIRE_FALSE( extractor.hasToken( u"other 0badf00d", "deadbeef" ) );
+        }
+
+        WHEN( "Lines are indexed" )
+        {
+            TokenIndex index;
+            index.append( 0_lnum,
+                          extract( extractor, { "start deadbeef", "other 0badf00d",
+                                                "end DeadBeef 0badf00d" } ),
+                          3_lcount );
+
+            THEN( "Lines of every token are found" )
+            {
+                REQUIRE( index.indexedLines() == 3_lcount );
+                REQUIRE( toVector( index.find( TokenExtractor::hashToken( u"deadbeef" ) ) )
+                         == klogg::vector<uint64_t>{ 0, 2 } );
+                REQUIRE( toVector( index.find( TokenExtractor::hashToken( u"0BADF00D" ) ) )
+                         == klogg::vector<uint64_t>{ 1, 2 } );
+                REQUIRE( index.find( TokenExtractor::hashToken( u"cafebabe" ) ).isEmpty() );
+            }
+
+            AND_WHEN( "The last line is replaced" )
+            {
+                index.append( 2_lnum,
+                              extract( extractor, { "end cafebabe", "next deadbeef" }, 2_lnum ),
+                              4_lcount );
+
+                THEN( "Tokens of the old line are dropped" )
+                {
+                    REQUIRE( index.indexedLines() == 4_lcount );
+                    REQUIRE( toVector( index.find( TokenExtractor::hashToken( u"deadbeef" ) ) )
+                             == klogg::vector<uint64_t>{ 0, 3 } );
+                    REQUIRE( toVector( index.find( TokenExtractor::hashToken( u"0badf00d" ) ) )
+                             == klogg::vector<uint64_t>{ 1 } );
+                    REQUIRE( toVector( index.find( TokenExtractor::hashToken( u"cafebabe" ) ) )
+                             == klogg::vector<uint64_t>{ 2 } );
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 Anton Filimonov and other contributors
+ *
+ * This file is part of klogg.
+ *
+ * klogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * klogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with klogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <string>
+
+#include "linetypes.h"
+
+namespace {
+// Straightforward expansion to check results against
+QString referenceUntabify( QString line, int initialPosition )
+{
+    line.replace( QChar::Null, QChar::Space );
+    auto position = line.indexOf( QChar::Tabulation );
+    while ( position >= 0 ) {
+        const auto spaces = TabStop - ( ( initialPosition + position ) % TabStop );
+        line.replace( position, 1, QString( spaces, QChar::Space ) );
+        position = line.indexOf( QChar::Tabulation, position );
+    }
+    return line;
+}
+
+QString makeTsvLine( int columns )
+{
+    QString line;
+    for ( auto column = 0; column < columns; ++column ) {
+        line.append( QString::number( column * 7919 ) );
+        line.append( QChar::Tabulation );
+    }
+    return line;
+}
+} // namespace
+
+TEST_CASE( "Untabify expands tabs to tab stops", "[untabify]" )
+{
+    REQUIRE( untabify( QString{} ).isEmpty() );
+    REQUIRE( untabify( QString( "no tabs" ) ) == QString( "no tabs" ) );
+    REQUIRE( untabify( QString( "\t" ) ) == QString( 8, QChar::Space ) );
+    REQUIRE( untabify( QString( "a\tb" ) ) == QString( "a       b" ) );
+    REQUIRE( untabify( QString( "abcdefgh\tc" ) ) == QString( "abcdefgh        c" ) );
+    REQUIRE( untabify( QString( "a\tb" ), 3_lcol ) == QString( "a    b" ) );
+
+    QString withNull( "a\tb" );
+    withNull[ 2 ] = QChar::Null;
+    REQUIRE( untabify( std::move( withNull ) ) == QString( "a" ) + QString( 8, QChar::Space ) );
+}
+
+TEST_CASE( "Untabify shares data of views without tabs", "[untabify]" )
+{
+    const QString line( "no tabs\there" );
+    const auto view = QStringView{ line };
+
+    const auto noTabs = untabify( view.left( 7 ) );
+    REQUIRE( noTabs == QString( "no tabs" ) );
+    REQUIRE( noTabs.constData() == line.constData() );
+
+    REQUIRE( untabify( view.mid( 3 ), 3_lcol ) == QString( "tabs here" ) );
+    REQUIRE( untabify( view.mid( 3 ) ) == QString( "tabs    here" ) );
+}
+
+TEST_CASE( "Untabify matches reference implementation", "[untabify]" )
+{
+    std::mt19937 generator( 42 );
+    const QChar alphabet[] = { QChar( 'a' ), QChar( 'b' ), QChar::Tabulation, QChar::Null,
+                               QChar( 0x0416 ) };
+
+    for ( auto i = 0; i < 10000; ++i ) {
+        QString line;
+        const auto length = static_cast<int>( generator() % 64 );
+        for ( auto j = 0; j < length; ++j ) {
+            line.append( alphabet[ generator() % std::size( alphabet ) ] );
+        }
+        const auto initialPosition = static_cast<int>( generator() % TabStop );
+
+        REQUIRE( untabify( QString{ line }, LineColumn( initialPosition ) )
+                 == referenceUntabify( line, initialPosition ) );
+    }
+}
+
+TEST_CASE( "Untabified length of UTF-8 lines", "[untabify]" )
+{
+    REQUIRE( getUntabifiedLength( std::string_view{} ) == LineLength( 0 ) );
+    REQUIRE( getUntabifiedLength( std::string_view{ "abc" } ) == LineLength( 3 ) );
+    REQUIRE( getUntabifiedLength( std::string_view{ "\t" } ) == LineLength( 8 ) );
+    REQUIRE( getUntabifiedLength( std::string_view{ "a\tb\t" } ) == LineLength( 16 ) );
+
+    const auto tsvLine = makeTsvLine( 20 );
+    const auto utf8TsvLine = tsvLine.toStdString();
+    REQUIRE( getUntabifiedLength( std::string_view{ utf8TsvLine } )
+             == LineLength( untabify( QString{ tsvLine } ).size() ) );
+}
+
+TEST_CASE( "Untabify tab-heavy lines", "[!benchmark]" )
+{
+    const auto tsvLine = makeTsvLine( 50 );
+    const auto utf8TsvLine = tsvLine.toStdString();
+
+    BENCHMARK( "untabify" )
+    {
+        return untabify( QString{ tsvLine } );
+    };
+
+    BENCHMARK( "reference untabify" )
+    {
+        return referenceUntabify( tsvLine, 0 );
+    };
+
+    BENCHMARK( "getUntabifiedLength" )
+    {
+        return getUntabifiedLength( std::string_view{ utf8TsvLine } );
+    };
+}